@@ -0,0 +1,44 @@
+/**
+ * @file           : channels.hpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Application event bus channels
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "core/event_bus.hpp"
+
+/**
+ * @brief           Debounced user button press
+ */
+struct button_msg_t
+{
+    int64_t press_ms;                       /*!< Press system uptime in milliseconds */
+    uint32_t press_count;                   /*!< Number of presses since boot */
+};
+
+/**
+ * @brief           User button presses, read by LEDs silent mode and event log tasks
+ */
+extern core::channel_t<button_msg_t, 2> button_channel;
@@ -24,6 +24,9 @@
 
 #pragma once
 
+#include <stdint.h>
+#include <stddef.h>
+#include <array>
 #include <vector>
 #include <zephyr/kernel.h>
 #include "drivers/led.hpp"
@@ -33,7 +36,19 @@ enum
     ORANGE_LED,
     GREEN_LED,
     RED_LED,
-    BLUE_LED
+    BLUE_LED,
+    LEDS_NUM
+};
+
+/**
+ * @brief           LED usage totals with estimated charge consumption
+ */
+struct led_usage_t
+{
+    uint64_t on_ms;                         /*!< Time the LED was ON */
+    uint64_t muted_ms;                      /*!< Time the LED was hidden by silent mode */
+    uint32_t transitions;                   /*!< Number of LED state changes */
+    uint64_t charge_uc;                     /*!< Estimated charge in microcoulombs, 3600 uC = 1 uAh */
 };
 
 class leds_controller_t final
@@ -43,12 +58,54 @@ public:
 
     bool init();
 
+    /**
+     * @brief          Show running lights status on the Base layer
+     */
     void init_indication();
+
+    /**
+     * @brief          Hide the status with LEDs OFF on the Overlay layer
+     */
     void shutdown_indication();
 
+    /**
+     * @brief          Clear the Overlay layer, the status shows up in its current phase
+     */
+    void resume_indication();
+
+    /**
+     * @brief          Mute the LEDs on the Mute layer, lower layers keep running
+     */
     void enable_silent_mode();
+
+    /**
+     * @brief          Clear the Mute layer
+     */
     void disable_silent_mode();
 
+    /**
+     * @brief          Set current drawn by the LED while it is ON
+     * @param[in]      led LED index, e.g. \ref ORANGE_LED
+     * @param[in]      current_ua LED current in microamps
+     * @return         `true` on success, `false` if
+     *                     - LED index is invalid
+     */
+    bool set_led_current(size_t led, uint32_t current_ua);
+
+    /**
+     * @brief          Get LED usage totals since \ref init or \ref reset_usage
+     * @param[in]      led LED index, e.g. \ref ORANGE_LED
+     * @param[out]     usage LED usage totals
+     * @return         `true` on success, `false` if
+     *                     - LED index is invalid
+     */
+    bool get_led_usage(size_t led, led_usage_t &usage);
+
+    /**
+     * @brief          Reset usage totals of all LEDs
+     */
+    void reset_usage();
+
 private:
     leds_controller_t();
 
@@ -60,8 +117,32 @@ private:
     k_tid_t create_thread();
     static void leds_update_thread(void *arg1, void *arg2, void *arg3);
 
-    std::vector<drivers::led_t> leds;
+    void request_update();
+
+    /**
+     * @brief          Save LEDs state to the memory kept over warm resets
+     * @note           Call with the lock taken
+     * @param[in]      now_ms System uptime in milliseconds
+     */
+    void save_checkpoint(int64_t now_ms);
+
+    /**
+     * @brief          Restore LEDs state saved before a warm reset
+     * @details        Patterns continue from the phase of the last LEDs update
+     *                     before the reset
+     * @return         `true` on success, `false` if
+     *                     - it is a cold boot
+     *                     - saved state is missing or corrupted
+     */
+    bool restore_checkpoint();
+
+    std::vector<drivers::gpio_led_t> leds;
+    std::array<uint32_t, LEDS_NUM> currents_ua;
+    bool is_restored;
 
     k_thread thread;
     k_tid_t thread_handle;
+
+    k_mutex lock;
+    k_sem update_sem;
 };
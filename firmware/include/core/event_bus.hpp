@@ -0,0 +1,271 @@
+/**
+ * @file           : event_bus.hpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Static publish/subscribe channels
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <array>
+#include <concepts>
+#include <type_traits>
+#include <zephyr/kernel.h>
+
+namespace core
+{
+
+/**
+ * @brief           Subscriber notification callback
+ * @details         Signature matches \ref event_t::signal_cb, so a coroutine
+ *                      subscribes by attaching its event
+ * @note            Called in the publisher context, which may be an ISR
+ */
+using channel_notify_fn = void (*)(void *arg);
+
+/**
+ * @brief           Channel statistics
+ */
+struct channel_stats_t
+{
+    uint32_t published;                     /*!< Number of published messages */
+    uint32_t consumed;                      /*!< Number of messages read by subscribers */
+    uint32_t dropped;                       /*!< Number of messages overwritten before a subscriber read them */
+    uint32_t latency_max_cycles;            /*!< Maximum publish to read latency, HW cycles */
+    uint64_t latency_sum_cycles;            /*!< Sum of publish to read latencies, HW cycles */
+};
+
+/**
+ * @brief           Channel subscriber slot
+ */
+struct channel_subscriber_t
+{
+    channel_notify_fn notify_cb;            /*!< Notification callback */
+    void *notify_arg;                       /*!< Notification callback argument */
+    uint32_t seen_seq;                      /*!< Sequence number of the last read message */
+};
+
+/**
+ * @brief           Subscriber slots storage of \ref channel_t
+ * @details         Inherited before \ref channel_base_t, so the slots exist
+ *                      when the base is constructed
+ */
+template <size_t SUBSCRIBERS_MAX>
+struct channel_subscribers_t
+{
+    std::array<channel_subscriber_t, SUBSCRIBERS_MAX> slots{};
+};
+
+/**
+ * @brief           Type independent part of \ref channel_t
+ */
+class channel_base_t
+{
+public:
+    channel_base_t(const channel_base_t &) = delete;
+    channel_base_t(channel_base_t &&) = delete;
+    channel_base_t &operator=(const channel_base_t &) = delete;
+    channel_base_t &&operator=(channel_base_t &&) = delete;
+
+    /**
+     * @brief          Get channel name
+     */
+    const char *get_name() const;
+
+    /**
+     * @brief          Subscribe to channel messages
+     * @details        Messages published before the subscription are not delivered
+     * @param[in]      notify_cb Callback notified on every published message
+     * @param[in]      notify_arg Argument for notification callback
+     * @param[out]     subscriber Subscriber index to read messages with
+     * @return         `true` on success, `false` if
+     *                     - all subscriber slots are taken
+     */
+    bool subscribe(channel_notify_fn notify_cb, void *notify_arg, size_t &subscriber);
+
+    /**
+     * @brief          Get channel statistics
+     */
+    channel_stats_t get_stats();
+
+    /**
+     * @brief          Reset channel statistics
+     */
+    void reset_stats();
+
+protected:
+    /**
+     * @brief          Constructor
+     * @param[in]      name Channel name
+     * @param[in]      subscribers Subscriber slots storage
+     * @param[in]      subscribers_max Number of subscriber slots
+     */
+    channel_base_t(const char *name, channel_subscriber_t *subscribers, size_t subscribers_max);
+
+    /**
+     * @brief          Lock the message for writing
+     */
+    k_spinlock_key_t begin_publish();
+
+    /**
+     * @brief          Stamp written message, unlock it and notify subscribers
+     */
+    void end_publish(k_spinlock_key_t key);
+
+    /**
+     * @brief          Lock the message for reading
+     * @param[in]      subscriber Subscriber index
+     * @param[out]     key Lock key, valid on success only
+     * @return         `true` if subscriber has an unread message, `false` otherwise
+     */
+    bool begin_read(size_t subscriber, k_spinlock_key_t &key);
+
+    /**
+     * @brief          Mark the message read by subscriber and unlock it
+     */
+    void end_read(size_t subscriber, k_spinlock_key_t key);
+
+private:
+    const char *name;
+    channel_subscriber_t *subscribers;
+    size_t subscribers_max;
+    size_t subscribers_num;
+
+    k_spinlock lock;
+
+    /**
+     * @brief          Sequence number of the current message, `0` until the first publish
+     */
+    uint32_t seq;
+
+    /**
+     * @brief          HW cycles counter at the current message publish
+     */
+    uint32_t publish_cycles;
+
+    channel_stats_t stats;
+};
+
+/**
+ * @brief           Publish/subscribe channel with a single statically allocated message
+ * @details         Publishers write the message in place and every subscriber
+ *                      is notified. Subscribers read the message in place too,
+ *                      so no message copies are queued and the channel memory is
+ *                      known at compile time. Like a mailbox, the channel keeps
+ *                      the latest message only: a message overwritten before a
+ *                      subscriber read it counts as dropped for that subscriber.
+ *                      Channels are meant to be defined as globals, e.g.
+ *                      @code
+ *                      core::channel_t<button_msg_t, 2> button_channel{"button"};
+ *                      @endcode
+ * @note            Message is accessed with interrupts locked, so publish and
+ *                      read functors must be short and must not block
+ * @tparam          Msg Message type
+ * @tparam          SUBSCRIBERS_MAX Maximum number of subscribers
+ */
+template <typename Msg, size_t SUBSCRIBERS_MAX>
+    requires std::is_trivially_copyable_v<Msg>
+class channel_t : private channel_subscribers_t<SUBSCRIBERS_MAX>, public channel_base_t
+{
+public:
+    /**
+     * @brief          Constructor
+     * @param[in]      name Channel name
+     */
+    explicit channel_t(const char *name);
+
+    /**
+     * @brief          Publish a message written in place
+     * @note           Safe to call from ISR context
+     * @param[in]      fill Functor called as `fill(Msg &message)` to write the message
+     */
+    template <typename Fn>
+        requires std::invocable<Fn, Msg &>
+    void publish_with(Fn &&fill);
+
+    /**
+     * @brief          Publish a copy of the message
+     * @note           Safe to call from ISR context
+     * @param[in]      msg Message
+     */
+    void publish(const Msg &msg);
+
+    /**
+     * @brief          Read the latest message in place
+     * @param[in]      subscriber Subscriber index returned by \ref subscribe
+     * @param[in]      fn Functor called as `fn(const Msg &message)`
+     * @return         `true` if an unread message was passed to the functor,
+     *                     `false` if subscriber has no unread messages
+     */
+    template <typename Fn>
+        requires std::invocable<Fn, const Msg &>
+    bool read(size_t subscriber, Fn &&fn);
+
+private:
+    Msg message;
+};
+
+template <typename Msg, size_t SUBSCRIBERS_MAX>
+    requires std::is_trivially_copyable_v<Msg>
+channel_t<Msg, SUBSCRIBERS_MAX>::channel_t(const char *name)
+    : channel_subscribers_t<SUBSCRIBERS_MAX>{},
+      channel_base_t(name, this->slots.data(), SUBSCRIBERS_MAX),
+      message{}
+{
+}
+
+template <typename Msg, size_t SUBSCRIBERS_MAX>
+    requires std::is_trivially_copyable_v<Msg>
+template <typename Fn>
+    requires std::invocable<Fn, Msg &>
+void channel_t<Msg, SUBSCRIBERS_MAX>::publish_with(Fn &&fill)
+{
+    k_spinlock_key_t key = this->begin_publish();
+    fill(this->message);
+    this->end_publish(key);
+}
+
+template <typename Msg, size_t SUBSCRIBERS_MAX>
+    requires std::is_trivially_copyable_v<Msg>
+void channel_t<Msg, SUBSCRIBERS_MAX>::publish(const Msg &msg)
+{
+    this->publish_with([&msg](Msg &message) { message = msg; });
+}
+
+template <typename Msg, size_t SUBSCRIBERS_MAX>
+    requires std::is_trivially_copyable_v<Msg>
+template <typename Fn>
+    requires std::invocable<Fn, const Msg &>
+bool channel_t<Msg, SUBSCRIBERS_MAX>::read(size_t subscriber, Fn &&fn)
+{
+    k_spinlock_key_t key;
+    if (!this->begin_read(subscriber, key)) {
+        return false;
+    }
+
+    fn(static_cast<const Msg &>(this->message));
+    this->end_read(subscriber, key);
+
+    return true;
+}
+
+} // core
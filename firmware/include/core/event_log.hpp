@@ -0,0 +1,165 @@
+/**
+ * @file           : event_log.hpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Append-only binary event log in internal flash
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <initializer_list>
+#include <zephyr/kernel.h>
+#include <zephyr/storage/flash_map.h>
+
+namespace core
+{
+
+/**
+ * @brief           Event identifiers, `0..62`
+ * @note            Keep in sync with `scripts/decode_event_log.py`
+ */
+enum class event_id_t : uint8_t
+{
+    Boot = 1,                               /*!< Firmware start, no values */
+    ButtonPress = 2,                        /*!< User button press, no values */
+    LedsMode = 3,                           /*!< LEDs indication mode change: mode, 0 shutdown, 1 init, 2 resume */
+    SilentMode = 4,                         /*!< LEDs silent mode change: enabled */
+    SensorSummary = 5,                      /*!< Sensor summary: x, y, z */
+};
+
+/**
+ * @brief           Append-only binary event log
+ * @details         Records are staged in a RAM page mirroring the flash page
+ *                      of the `event_log_partition` flash partition. Bytes not
+ *                      written yet are appended to the flash page when the page
+ *                      is full or flushed, the erased bytes after them are
+ *                      programmed by the next flush. Page layout:
+ *                      - header: magic `u16`, boot number `u16`, page start uptime ms `u32`
+ *                      - records: tag byte (values number `<< 6` | event id), varint
+ *                          ms delta to the previous record, zigzag varint values
+ *                          delta-encoded against the previous record of the same event
+ *                      - erased `0xFF` tail terminates the page
+ *
+ *                      The partition is a ring of flash sectors, it must have at
+ *                      least two of them. The oldest sector is erased when the
+ *                      last page of the sector before it is started, so the log
+ *                      keeps all but one sector of history. Flash is written and
+ *                      erased from a dedicated low priority work queue. A sector
+ *                      erase stalls flash fetches of the single bank STM32F401
+ *                      for up to 2 s on a 128 KB sector, ISRs included
+ *                      Decoded by `scripts/decode_event_log.py`
+ */
+class event_log_t final
+{
+public:
+    static constexpr size_t PAGE_SIZE = 256U;
+    static constexpr size_t MAX_VALUES_NUM = 3U;
+    static constexpr uint16_t PAGE_MAGIC = 0x4C45U;
+    static constexpr size_t HEADER_SIZE = 8U;
+
+    static event_log_t &get_instance();
+
+    /**
+     * @brief          Find the end of the log and start periodic flushing
+     * @details        New boot starts a new page after the last written one
+     * @return         `true` on success, `false` if
+     *                     - log partition is not found or its device is not ready
+     *                     - log partition has less than two flash sectors
+     */
+    bool init();
+
+    /**
+     * @brief          Append an event record
+     * @note           ISR safe
+     * @param[in]      id Event identifier
+     * @param[in]      values Event values, up to \ref MAX_VALUES_NUM
+     * @return         `true` on success, `false` if
+     *                     - log is not initialized
+     *                     - too many values are passed
+     *                     - both RAM pages are busy and the record is dropped
+     */
+    bool append(event_id_t id, std::initializer_list<int32_t> values = {});
+
+    /**
+     * @brief          Write records of the partially filled page to flash
+     * @details        Records appended afterwards continue the same page
+     */
+    void flush();
+
+    /**
+     * @brief          Get number of dropped records
+     */
+    uint32_t get_dropped_num() const;
+
+private:
+    /**
+     * @brief          RAM staging page
+     */
+    struct page_t
+    {
+        uint8_t data[PAGE_SIZE];            /*!< Page bytes as written to flash */
+        size_t size;                        /*!< Number of used bytes */
+        size_t written;                     /*!< Number of bytes written to flash */
+        size_t offset;                      /*!< Partition offset of the page */
+        int64_t last_ms;                    /*!< Uptime of the last record */
+    };
+
+    event_log_t();
+
+    event_log_t(const event_log_t &) = delete;
+    event_log_t(event_log_t &&) = delete;
+    event_log_t &operator=(const event_log_t &) = delete;
+    event_log_t &&operator=(event_log_t &&) = delete;
+
+    void start_page(page_t &page, int64_t now_ms);
+    void submit_active_page();
+    size_t next_page_offset(size_t offset) const;
+
+    /**
+     * @brief          Write not written bytes of the page to flash
+     * @details        Erases the oldest sector ahead when the page is the last
+     *                     one of its sector. Called from the log work queue only
+     */
+    void write_page(page_t &page);
+
+    static size_t put_varint(uint8_t *dst, uint32_t value);
+    static void write_work_handler(k_work *work);
+    static void flush_work_handler(k_work *work);
+
+    const struct flash_area *area;          /*!< Log flash partition */
+    size_t write_offset;                    /*!< Partition offset of the next page */
+    uint16_t boot_num;                      /*!< Current boot number */
+
+    page_t pages[2];                        /*!< Active and pending pages */
+    page_t *active;                         /*!< Page records are appended to */
+    page_t *pending;                        /*!< Page being written, `nullptr` if none */
+    int32_t last_values[64][MAX_VALUES_NUM];/*!< Last values per event id in the active page */
+    struct k_spinlock lock;
+
+    k_work_q work_queue;                    /*!< Flash writes and erases queue */
+    k_work write_work;
+    k_work_delayable flush_work;
+
+    uint32_t dropped_num;
+};
+
+} // core
@@ -0,0 +1,285 @@
+/**
+ * @file           : executor.hpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Cooperative C++20 coroutine executor
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <coroutine>
+#include <zephyr/kernel.h>
+
+#if defined(CONFIG_SENSOR)
+#include <zephyr/drivers/sensor.h>
+#endif
+
+#include "drivers/gpio.hpp"
+
+namespace core
+{
+
+/**
+ * @brief           Cooperative coroutine task
+ * @details         Return type of every coroutine run by \ref executor_t.
+ *                      Coroutine frames are allocated from a fixed pool of
+ *                      `CONFIG_APP_EXECUTOR_FRAME_COUNT` blocks, each of
+ *                      `CONFIG_APP_EXECUTOR_FRAME_SIZE` bytes, so no heap is used.
+ *                      The coroutine starts suspended and its frame is released
+ *                      automatically when it returns
+ */
+class task_t
+{
+public:
+    /**
+     * @brief          Coroutine promise required by C++20 coroutines machinery
+     */
+    struct promise_type
+    {
+        task_t get_return_object() noexcept;
+
+        /**
+         * @brief      Called instead of \ref get_return_object when frame pool is exhausted
+         * @return     Invalid task, see \ref task_t::is_valid
+         */
+        static task_t get_return_object_on_allocation_failure() noexcept;
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { k_panic(); }
+
+        /**
+         * @brief      Allocate coroutine frame from the frame pool
+         * @param[in]  size Coroutine frame size in bytes
+         * @return     Pointer to frame memory or `nullptr` if frame does not fit
+         *                 into pool block or pool is exhausted
+         */
+        static void *operator new(size_t size) noexcept;
+
+        /**
+         * @brief      Return coroutine frame to the frame pool
+         * @param[in]  ptr Pointer to frame memory
+         */
+        static void operator delete(void *ptr) noexcept;
+    };
+
+    task_t() = default;
+    task_t(task_t &&other) noexcept;
+    ~task_t();
+
+    task_t(const task_t &) = delete;
+    task_t &operator=(const task_t &) = delete;
+    task_t &operator=(task_t &&) = delete;
+
+    /**
+     * @brief          Check coroutine frame was allocated
+     * @return         `true` if task owns a coroutine, `false` otherwise
+     */
+    bool is_valid() const;
+
+private:
+    friend class executor_t;
+
+    explicit task_t(std::coroutine_handle<promise_type> handle);
+
+    /**
+     * @brief          Owned coroutine handle
+     */
+    std::coroutine_handle<promise_type> handle;
+};
+
+/**
+ * @brief           Single-thread cooperative coroutine executor
+ * @details         Resumes ready coroutines one by one in the context of the thread
+ *                      calling \ref executor_t::run. Coroutines are made ready by
+ *                      awaitables from timer, GPIO or work queue context, so any
+ *                      number of logical tasks share the stack of a single thread
+ */
+class executor_t final
+{
+public:
+    static executor_t &get_instance();
+
+    /**
+     * @brief          Hand the task over to executor and schedule its first run
+     * @param[in]      task Task returned by a coroutine function
+     * @return         `true` on success, `false` if
+     *                     - task coroutine frame allocation failed
+     */
+    bool spawn(task_t &&task);
+
+    /**
+     * @brief          Make suspended coroutine ready to be resumed
+     * @note           Safe to call from ISR context
+     * @param[in]      handle Suspended coroutine handle
+     */
+    void schedule(std::coroutine_handle<> handle);
+
+    /**
+     * @brief          Run ready coroutines forever
+     */
+    [[noreturn]] void run();
+
+private:
+    executor_t() = default;
+
+    executor_t(const executor_t &) = delete;
+    executor_t(executor_t &&) = delete;
+    executor_t &operator=(const executor_t &) = delete;
+    executor_t &&operator=(executor_t &&) = delete;
+};
+
+/**
+ * @brief           Awaitable resuming the coroutine after a kernel timeout
+ */
+class sleep_awaiter_t
+{
+public:
+    /**
+     * @brief          Constructor
+     * @param[in]      timeout Relative or absolute (`K_TIMEOUT_ABS_*`) kernel timeout
+     */
+    explicit sleep_awaiter_t(k_timeout_t timeout);
+
+    bool await_ready() const noexcept;
+    void await_suspend(std::coroutine_handle<> handle) noexcept;
+    void await_resume() const noexcept {}
+
+private:
+    /**
+     * @brief          Timer expiry callback, called in ISR context
+     * @param[in]      timer Pointer to expired timer
+     */
+    static void timer_expiry(k_timer *timer);
+
+    k_timeout_t timeout;
+    k_timer timer;
+    std::coroutine_handle<> handle;
+};
+
+/**
+ * @brief           Suspend the coroutine for the given period
+ * @param[in]       timeout Relative kernel timeout
+ */
+inline sleep_awaiter_t sleep_for(k_timeout_t timeout)
+{
+    return sleep_awaiter_t{timeout};
+}
+
+/**
+ * @brief           Suspend the coroutine until the given deadline
+ * @param[in]       uptime_ms System uptime deadline in milliseconds
+ */
+inline sleep_awaiter_t sleep_until(int64_t uptime_ms)
+{
+    return sleep_awaiter_t{K_TIMEOUT_ABS_MS(uptime_ms)};
+}
+
+/**
+ * @brief           Auto-reset event a single coroutine can wait for
+ * @details         Event signalled while nobody waits is latched and consumed
+ *                      by the next `co_await`
+ */
+class event_t
+{
+public:
+    event_t();
+
+    /**
+     * @brief          Signal the event
+     * @note           Safe to call from ISR context
+     */
+    void signal();
+
+    /**
+     * @brief          Signal the event passed as an argument
+     * @details        Signature matches \ref gpio_irq_handler_fn, so the event can be
+     *                     attached directly as an IRQ Handler callback
+     * @param[in]      arg Pointer to \ref event_t instance
+     */
+    static void signal_cb(void *arg);
+
+    bool await_ready() noexcept;
+    bool await_suspend(std::coroutine_handle<> handle) noexcept;
+    void await_resume() const noexcept {}
+
+private:
+    k_spinlock lock;
+    std::coroutine_handle<> waiter;
+    bool is_set;
+};
+
+/**
+ * @brief           Event signalled on GPIO Pin edges
+ */
+class gpio_edge_t : public event_t
+{
+public:
+    /**
+     * @brief          Start listening to GPIO Pin edges
+     * @param[in]      gpio GPIO Pin configured as Input
+     * @param[in]      irq_trigger GPIO Pin interrupt trigger source
+     * @return         `true` on success, `false` if failed to attach GPIO Pin IRQ
+     */
+    bool attach(drivers::gpio::gpio_t &gpio, drivers::gpio::pin_irq_trigger_t irq_trigger);
+};
+
+#if defined(CONFIG_SENSOR)
+/**
+ * @brief           Awaitable fetching a sensor sample on the system work queue
+ * @details         The coroutine resumes with `sensor_sample_fetch()` result,
+ *                      values are then read with `sensor_channel_get()`
+ */
+class sensor_fetch_awaiter_t
+{
+public:
+    /**
+     * @brief          Constructor
+     * @param[in]      dev Pointer to sensor device handle
+     */
+    explicit sensor_fetch_awaiter_t(const device_t *dev);
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> handle) noexcept;
+    int await_resume() const noexcept { return this->ret; }
+
+private:
+    static void work_handler(k_work *work);
+
+    const device_t *dev;
+    k_work work;
+    std::coroutine_handle<> handle;
+    int ret;
+};
+
+/**
+ * @brief           Fetch new sensor sample without blocking the executor
+ * @param[in]       dev Pointer to sensor device handle
+ */
+inline sensor_fetch_awaiter_t sensor_fetch(const device_t *dev)
+{
+    return sensor_fetch_awaiter_t{dev};
+}
+#endif /* defined(CONFIG_SENSOR) */
+
+} // core
@@ -0,0 +1,47 @@
+/**
+ * @file           : hot_path.hpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Hot path code placement
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#pragma once
+
+/**
+ * @brief           Place the function into SRAM
+ * @details         Marked functions go to `.fw_hot.*` sections, which the
+ *                      `linker/fw_hot.ld` snippet puts into the ramfunc section,
+ *                      so they run without flash wait states and ART cache misses.
+ *                      Functions called from a marked one still run from flash,
+ *                      so mark the callees on the hot path too. Data is in SRAM
+ *                      anyway. Expands to nothing without `CONFIG_APP_HOT_PATH_SRAM`
+ * @note            Put the macro on the function definition. GCC ignores it on
+ *                      class template members, put it on their explicit
+ *                      instantiations instead, see \ref LED_INSTANTIATE
+ */
+#if defined(CONFIG_APP_HOT_PATH_SRAM)
+/* One section per function keeps --gc-sections working and lets template
+ * instantiations (COMDAT) and plain functions share a translation unit */
+#define FW_HOT_SECTION(n) __attribute__((noinline, section(".fw_hot." #n)))
+#define FW_HOT_SECTION_EXPAND(n) FW_HOT_SECTION(n)
+#define FW_HOT FW_HOT_SECTION_EXPAND(__COUNTER__)
+#else
+#define FW_HOT
+#endif
@@ -0,0 +1,101 @@
+/**
+ * @file           : hot_path_bench.hpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Flash versus SRAM hot path benchmark
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace core
+{
+
+/**
+ * @brief           Execution time statistics of a benchmarked function
+ */
+struct bench_result_t
+{
+    uint32_t min_cycles;                    /*!< Minimum execution time */
+    uint32_t max_cycles;                    /*!< Maximum execution time */
+    uint64_t sum_cycles;                    /*!< Sum of execution times */
+    uint32_t runs;                          /*!< Number of runs */
+};
+
+/**
+ * @brief           Hot path placement benchmark
+ * @details         Runs every case `CONFIG_APP_HOT_PATH_BENCH_ITERATIONS` times
+ *                      with interrupts locked and measures it with the timing
+ *                      API. Jitter is `max - min`. Cases:
+ *                      - the same kernel, a blink phase and BSRR word composition
+ *                          loop, built once to flash and once to SRAM
+ *                      - \ref led_t::update with a changed layer, of one LED
+ *                          instantiation without \ref FW_HOT in flash and of
+ *                          one with it in SRAM. Pattern members they call
+ *                          are in SRAM for both
+ *                      - \ref gpio_t pin IRQ handler dispatching an edge, its
+ *                          flash copy and the SRAM one
+ *
+ *                      Every case runs with a warm flash ART cache and with the
+ *                      cache invalidated before each run, the latter being the
+ *                      worst case of a rarely running IRQ handler
+ */
+class hot_path_bench_t final
+{
+public:
+    /**
+     * @brief          Run all cases and log the results
+     */
+    static void run();
+
+private:
+    hot_path_bench_t() = delete;
+
+    /**
+     * @brief          Measure the function
+     * @param[in]      prepare Function called before every run outside of the
+     *                     measured interval or `nullptr`
+     * @param[in]      fn Benchmarked function
+     * @param[in]      arg Argument of both functions
+     * @param[in]      is_cold `true` to invalidate the flash cache before every run
+     */
+    static bench_result_t measure(void (*prepare)(void *arg), void (*fn)(void *arg), void *arg, bool is_cold);
+
+    /**
+     * @brief          Log the case result
+     */
+    static void log_result(const char *name, const bench_result_t &result);
+
+    /**
+     * @brief          Run the flash copy of the pin IRQ handler
+     * @param[in]      arg Pointer to the handler callback context
+     */
+    static void pin_irq_flash(void *arg);
+
+    /**
+     * @brief          Run the SRAM pin IRQ handler
+     * @param[in]      arg Pointer to the handler callback context
+     */
+    static void pin_irq_sram(void *arg);
+};
+
+} // core
@@ -0,0 +1,208 @@
+/**
+ * @file           : latency_probe.hpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Input to output latency probe
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <zephyr/kernel.h>
+
+namespace core
+{
+
+/**
+ * @brief           Stages of the button to LED path, in path order
+ */
+enum class probe_stage_t : uint8_t
+{
+    IrqEntry = 0,                           /*!< Button push interrupt */
+    EventConsumed,                          /*!< Button press read from the event bus */
+    CommandApplied,                         /*!< LEDs controller mode changed */
+    PinWritten,                             /*!< LEDs outputs updated */
+    Count
+};
+
+/**
+ * @brief           Latency histogram of one path interval
+ */
+struct probe_histogram_t
+{
+    static constexpr size_t LOG2_BUCKETS_NUM = 33U;
+
+    uint32_t count;                         /*!< Number of samples */
+    uint32_t min_us;                        /*!< Minimum latency */
+    uint32_t max_us;                        /*!< Maximum latency */
+    uint64_t sum_us;                        /*!< Sum of latencies */
+    uint32_t log2_buckets[LOG2_BUCKETS_NUM];/*!< Bucket `0` counts `0 us`, bucket `n` counts `[2^(n-1), 2^n) us` */
+};
+
+/**
+ * @brief           End-to-end latency probe of the button to LED path
+ * @details         Every stage is stamped with the HW cycles counter. Stamps
+ *                      are accepted in path order only, so bounces and periodic
+ *                      LED updates outside of a measured press are ignored.
+ *                      A completed path adds the latency of every interval
+ *                      between adjacent stages and of the whole path to
+ *                      log2 histograms. The whole path latency also goes to a
+ *                      linear histogram of `CONFIG_APP_LATENCY_PROBE_BUCKET_US`
+ *                      wide buckets for accurate percentiles.
+ *                      Loopback mode presses the button from a thread, either
+ *                      with a spare output Pin wired to the button (`loopback-gpios`
+ *                      property of `zephyr,user` node) or with the GPIO emulator,
+ *                      and measures unattended
+ * @note            Use \ref LATENCY_PROBE_STAMP and \ref LATENCY_PROBE_ABORT
+ *                      macros, they compile out without `CONFIG_APP_LATENCY_PROBE`
+ */
+class latency_probe_t final
+{
+public:
+    /**
+     * @brief          Number of latency intervals: between adjacent stages and the whole path
+     */
+    static constexpr size_t INTERVALS_NUM = static_cast<size_t>(probe_stage_t::Count);
+
+    /**
+     * @brief          Index of the whole path interval
+     */
+    static constexpr size_t TOTAL_INTERVAL = INTERVALS_NUM - 1U;
+
+    /**
+     * @brief          Number of whole path linear histogram buckets, the last one counts overflows
+     */
+    static constexpr size_t LINEAR_BUCKETS_NUM = 128U;
+
+    static latency_probe_t &get_instance();
+
+    /**
+     * @brief          Stamp the path stage
+     * @note           Safe to call from ISR context
+     * @param[in]      stage Path stage
+     */
+    void stamp(probe_stage_t stage);
+
+    /**
+     * @brief          Drop the path in progress, e.g. when a press was rejected as a bounce
+     * @note           Safe to call from ISR context
+     */
+    void abort();
+
+    /**
+     * @brief          Get interval latency histogram
+     * @param[in]      interval Interval index, `n` is between stages `n` and `n + 1`,
+     *                     \ref TOTAL_INTERVAL is the whole path
+     * @param[out]     histogram Interval histogram
+     * @return         `true` on success, `false` if
+     *                     - interval index is invalid
+     */
+    bool get_histogram(size_t interval, probe_histogram_t &histogram);
+
+    /**
+     * @brief          Estimate interval latency percentile
+     * @details        Returns the upper bound of the histogram bucket, the whole
+     *                     path uses linear buckets, other intervals use log2 buckets
+     * @param[in]      interval Interval index, see \ref get_histogram
+     * @param[in]      pct Percentile, `0..100`
+     * @return         Latency in microseconds, `0` if there are no samples
+     */
+    uint32_t get_percentile_us(size_t interval, uint32_t pct);
+
+    /**
+     * @brief          Log statistics of all intervals
+     */
+    void report();
+
+    /**
+     * @brief          Drop all statistics
+     */
+    void reset();
+
+#if defined(CONFIG_APP_LATENCY_PROBE_LOOPBACK)
+    /**
+     * @brief          Start pressing the button from the loopback thread
+     * @details        Holds the button pressed until the path completes, releases
+     *                     it for `CONFIG_APP_LATENCY_PROBE_RELEASE_MS` and repeats
+     *                     forever, reporting every `CONFIG_APP_LATENCY_PROBE_REPORT_EVERY`
+     *                     iterations
+     * @return         `true` on success, `false` if
+     *                     - failed to configure loopback GPIO Pin
+     */
+    bool start_loopback();
+#endif
+
+private:
+    latency_probe_t() = default;
+
+    latency_probe_t(const latency_probe_t &) = delete;
+    latency_probe_t(latency_probe_t &&) = delete;
+    latency_probe_t &operator=(const latency_probe_t &) = delete;
+    latency_probe_t &&operator=(latency_probe_t &&) = delete;
+
+    /**
+     * @brief          Add completed path stamps to histograms, called with the lock held
+     */
+    void record();
+
+    /**
+     * @brief          Add a sample to histogram
+     */
+    static void add_sample(probe_histogram_t &histogram, uint32_t us);
+
+#if defined(CONFIG_APP_LATENCY_PROBE_LOOPBACK)
+    /**
+     * @brief          Drive the button to pressed or released state
+     */
+    void drive_loopback(bool is_pressed);
+
+    static void loopback_thread(void *arg1, void *arg2, void *arg3);
+
+    k_thread thread;
+    k_sem done_sem;
+    uint32_t timeouts = 0;
+#endif
+
+    k_spinlock lock = {};
+
+    /**
+     * @brief          Stage expected to be stamped next
+     */
+    size_t next_stage = 0;
+
+    /**
+     * @brief          HW cycles counter at every stage of the path in progress
+     */
+    uint32_t stamps[INTERVALS_NUM] = {};
+
+    probe_histogram_t histograms[INTERVALS_NUM] = {};
+    uint32_t linear_buckets[LINEAR_BUCKETS_NUM] = {};
+};
+
+} // core
+
+#if defined(CONFIG_APP_LATENCY_PROBE)
+#define LATENCY_PROBE_STAMP(stage) core::latency_probe_t::get_instance().stamp(core::probe_stage_t::stage)
+#define LATENCY_PROBE_ABORT() core::latency_probe_t::get_instance().abort()
+#else
+#define LATENCY_PROBE_STAMP(stage)
+#define LATENCY_PROBE_ABORT()
+#endif
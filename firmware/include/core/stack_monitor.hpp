@@ -0,0 +1,98 @@
+/**
+ * @file           : stack_monitor.hpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Runtime thread and ISR stack high-water monitor
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <zephyr/kernel.h>
+
+namespace core
+{
+
+/**
+ * @brief           Stack high-water monitor
+ * @details         Measures the deepest stack usage of every thread and of the
+ *                      ISR stack by scanning the stack fill pattern, and logs it
+ *                      together with recommended stack size. Report lines are
+ *                      parsed by `scripts/stack_report.py`, which combines them
+ *                      with compiler call graph worst cases
+ */
+class stack_monitor_t final
+{
+public:
+    /**
+     * @brief          Single stack usage report entry
+     */
+    struct usage_t
+    {
+        const char *name;                   /*!< Thread name or "isr" */
+        size_t size;                        /*!< Stack size in bytes */
+        size_t used;                        /*!< Stack high-water mark in bytes */
+        size_t recommended;                 /*!< Recommended stack size in bytes */
+    };
+
+    static stack_monitor_t &get_instance();
+
+    /**
+     * @brief          Start periodic stack reporting
+     * @return         `true` on success
+     */
+    bool init();
+
+    /**
+     * @brief          Log stack usage of every thread and of the ISR stack
+     */
+    void report();
+
+    /**
+     * @brief          Measure ISR stack usage
+     * @param[out]     usage ISR stack usage
+     * @return         `true` on success, `false` if ISR stack fill pattern is not found
+     */
+    static bool get_isr_usage(usage_t &usage);
+
+    /**
+     * @brief          Calculate recommended stack size for measured usage
+     * @param[in]      used Stack high-water mark in bytes
+     * @return         Usage with configured margin, aligned to stack pointer alignment
+     */
+    static size_t recommend_size(size_t used);
+
+private:
+    stack_monitor_t();
+
+    stack_monitor_t(const stack_monitor_t &) = delete;
+    stack_monitor_t(stack_monitor_t &&) = delete;
+    stack_monitor_t &operator=(const stack_monitor_t &) = delete;
+    stack_monitor_t &&operator=(stack_monitor_t &&) = delete;
+
+    static void thread_report_cb(const k_thread *thread, void *user_data);
+    static void log_usage(const usage_t &usage);
+    static void report_work_handler(k_work *work);
+
+    k_work_delayable report_work;
+};
+
+} // core
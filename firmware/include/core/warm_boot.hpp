@@ -0,0 +1,42 @@
+/**
+ * @file           : warm_boot.hpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Warm boot detection
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#pragma once
+
+namespace core
+{
+
+/**
+ * @brief           Check the last reset kept SRAM contents
+ * @details         Watchdog, software and reset pin resets are warm, unless
+ *                      the power was lost too: power-on and brown-out resets
+ *                      are flagged together with the reset pin one. The reset
+ *                      cause is read and cleared by the first call, so the
+ *                      next reset reports its own cause only
+ * @return          `true` on warm boot, `false` on cold boot or if the reset
+ *                      cause is unknown
+ */
+bool is_warm_boot();
+
+} // core
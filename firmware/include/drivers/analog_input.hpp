@@ -0,0 +1,295 @@
+/**
+ * @file           : analog_input.hpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : DMA-streamed double-buffered analog input
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <concepts>
+#include <utility>
+#include <zephyr/kernel.h>
+
+#if defined(CONFIG_ADC_ASYNC)
+#include <zephyr/drivers/adc.h>
+#endif
+
+#if defined(CONFIG_SOC_FAMILY_STM32) && defined(CONFIG_DMA)
+#include <soc.h>
+#include <zephyr/drivers/clock_control/stm32_clock_control.h>
+#endif
+
+#include "drivers/gpio.hpp"
+
+namespace drivers
+{
+
+/**
+ * @brief           Analog samples block handler
+ * @details         Called from interrupt context with a pointer into the sampling
+ *                      buffer, the block stays valid until the other half of the
+ *                      buffer is filled
+ * @param[in]       arg Handler argument
+ * @param[in]       samples Pointer to the first sample of the block
+ * @param[in]       samples_num Number of samples in the block
+ */
+using analog_block_handler_fn = void (*)(void *arg, const uint16_t *samples, size_t samples_num);
+
+/**
+ * @brief           Sampling buffer half filled notification
+ * @param[in]       arg Notification argument
+ * @param[in]       half_idx Filled buffer half, `0` or `1`
+ */
+using analog_half_handler_fn = void (*)(void *arg, size_t half_idx);
+
+/**
+ * @brief           Analog sampling backend requirements
+ * @details         Backend samples at given rate into a circular buffer and
+ *                      notifies about every filled half of it
+ */
+template <typename T>
+concept analog_backend = requires(T backend, uint16_t *buffer, size_t samples_num, uint32_t sample_rate_hz,
+                                  analog_half_handler_fn half_handler, void *arg) {
+    { backend.init() } -> std::same_as<bool>;
+    { backend.start(buffer, samples_num, sample_rate_hz, half_handler, arg) } -> std::same_as<bool>;
+    backend.stop();
+};
+
+/**
+ * @brief           Analog input class
+ * @details         Streams samples of an Analog Input GPIO Pin into ping-pong
+ *                      buffers. Every filled half is handed to the handler in
+ *                      place, optionally decimated by block averaging, while
+ *                      the backend fills the other half
+ * @tparam          Backend Sampling backend type, see \ref analog_backend
+ * @tparam          BLOCK_SIZE Number of samples in one buffer half
+ */
+template <analog_backend Backend, size_t BLOCK_SIZE>
+class analog_input_t
+{
+public:
+    /**
+     * @brief          Constructor
+     * @param[in]      port_ptr Pointer to GPIO Port device handle
+     * @param[in]      pin GPIO Pin number in specified GPIO Port
+     * @param[in]      args Arguments forwarded to backend constructor
+     */
+    template <typename... Args>
+    analog_input_t(const device_t *port_ptr, uint8_t pin, Args &&...args)
+        : pin{port_ptr, pin}, backend(std::forward<Args>(args)...),
+          handler{nullptr}, handler_arg{nullptr}, decimation{1}, blocks_num{0}
+    {
+    }
+
+    /**
+     * @brief          Configure GPIO Pin as Analog Input and initialize backend
+     * @return         `true` on success, `false` if
+     *                     - GPIO Pin configuration failed
+     *                     - backend initialization failed
+     */
+    bool init()
+    {
+        return this->pin.config_as_analog() && this->backend.init();
+    }
+
+    /**
+     * @brief          Start sampling
+     * @param[in]      sample_rate_hz Sampling rate in Hz
+     * @param[in]      handler Samples block handler
+     * @param[in]      handler_arg Argument for samples block handler
+     * @param[in]      decimation Number of averaged samples per output sample,
+     *                     must divide `BLOCK_SIZE`
+     * @return         `true` on success, `false` if
+     *                     - passed nullptr handler or invalid decimation
+     *                     - backend failed to start
+     */
+    bool start(uint32_t sample_rate_hz, analog_block_handler_fn handler, void *handler_arg, size_t decimation = 1)
+    {
+        if ((handler == nullptr) || (decimation == 0) || ((BLOCK_SIZE % decimation) != 0)) {
+            return false;
+        }
+
+        this->handler = handler;
+        this->handler_arg = handler_arg;
+        this->decimation = decimation;
+        this->blocks_num = 0;
+
+        return this->backend.start(this->buffer, 2U * BLOCK_SIZE, sample_rate_hz, analog_input_t::half_handler, this);
+    }
+
+    /**
+     * @brief          Stop sampling
+     */
+    void stop()
+    {
+        this->backend.stop();
+    }
+
+    /**
+     * @brief          Get number of handed blocks since start
+     */
+    uint32_t get_blocks_num() const
+    {
+        return this->blocks_num;
+    }
+
+    /**
+     * @brief          Get backend instance
+     */
+    Backend &get_backend()
+    {
+        return this->backend;
+    }
+
+private:
+    static void half_handler(void *arg, size_t half_idx)
+    {
+        auto *self = static_cast<analog_input_t *>(arg);
+        uint16_t *block = &self->buffer[half_idx * BLOCK_SIZE];
+        size_t samples_num = BLOCK_SIZE;
+
+        /* Averages are written in place, the backend is filling the other half meanwhile */
+        if (self->decimation > 1) {
+            samples_num = BLOCK_SIZE / self->decimation;
+            for (size_t i = 0; i < samples_num; ++i) {
+                uint32_t sum = 0;
+                for (size_t j = 0; j < self->decimation; ++j) {
+                    sum += block[i * self->decimation + j];
+                }
+                block[i] = static_cast<uint16_t>((sum + self->decimation / 2U) / self->decimation);
+            }
+        }
+
+        self->blocks_num = self->blocks_num + 1;
+        self->handler(self->handler_arg, block, samples_num);
+    }
+
+    gpio::gpio_t pin;                       /*!< Analog Input GPIO Pin */
+    Backend backend;                        /*!< Sampling backend */
+    alignas(4) uint16_t buffer[2U * BLOCK_SIZE];    /*!< Ping-pong sampling buffer */
+
+    analog_block_handler_fn handler;        /*!< Samples block handler */
+    void *handler_arg;                      /*!< Samples block handler argument */
+    size_t decimation;                      /*!< Number of averaged samples per output sample */
+    volatile uint32_t blocks_num;           /*!< Number of handed blocks */
+};
+
+#if defined(CONFIG_SOC_FAMILY_STM32) && defined(CONFIG_DMA)
+/**
+ * @brief           STM32 timer-triggered ADC with circular DMA backend
+ * @details         Timer channel 1 compare event triggers every ADC conversion,
+ *                      DMA moves results into the circular buffer and raises
+ *                      half and full transfer interrupts, so no CPU is involved
+ *                      per sample. E.g. ADC1 uses DMA2 Stream 0 Channel 0 and
+ *                      TIM5 channel 1 is the `LL_ADC_REG_TRIG_EXT_TIM5_CH1` trigger
+ */
+class stm32_adc_dma_backend_t
+{
+public:
+    /**
+     * @brief          Backend hardware configuration
+     */
+    struct config_t
+    {
+        ADC_TypeDef *adc;                   /*!< ADC registers */
+        struct stm32_pclken adc_pclken;     /*!< ADC clock configuration */
+        uint32_t adc_channel;               /*!< ADC channel, `LL_ADC_CHANNEL_n` */
+        uint32_t adc_trigger;               /*!< ADC trigger, `LL_ADC_REG_TRIG_EXT_TIMx_CH1` */
+        const device_t *dma_dev;            /*!< DMA controller device handle */
+        uint32_t dma_stream;                /*!< DMA stream number */
+        uint32_t dma_slot;                  /*!< DMA stream channel selection */
+        TIM_TypeDef *tim;                   /*!< Trigger timer registers */
+        struct stm32_pclken tim_pclken;     /*!< Trigger timer clock configuration */
+    };
+
+    /**
+     * @brief          Constructor
+     * @param[in]      config Backend hardware configuration
+     */
+    explicit stm32_adc_dma_backend_t(const config_t &config);
+
+    bool init();
+    bool start(uint16_t *buffer, size_t samples_num, uint32_t sample_rate_hz,
+                   analog_half_handler_fn half_handler, void *arg);
+    void stop();
+
+private:
+    /**
+     * @brief          DMA half and full transfer callback
+     */
+    static void dma_callback(const device_t *dev, void *user_data, uint32_t channel, int status);
+
+    config_t config;
+    uint32_t tim_rate_hz;
+    analog_half_handler_fn half_handler;
+    void *half_handler_arg;
+};
+#endif /* defined(CONFIG_SOC_FAMILY_STM32) && defined(CONFIG_DMA) */
+
+#if defined(CONFIG_ADC_ASYNC)
+/**
+ * @brief           Generic Zephyr ADC sequence backend
+ * @details         Samples with ADC sequence interval and extra samplings,
+ *                      e.g. on the ADC emulator of native_sim. Each buffer pass
+ *                      is one sequence, restarted from the system work queue
+ */
+class adc_sequence_backend_t
+{
+public:
+    /**
+     * @brief          Constructor
+     * @param[in]      spec ADC channel specification from Devicetree
+     */
+    explicit adc_sequence_backend_t(const struct adc_dt_spec &spec);
+
+    bool init();
+    bool start(uint16_t *buffer, size_t samples_num, uint32_t sample_rate_hz,
+                   analog_half_handler_fn half_handler, void *arg);
+    void stop();
+
+private:
+    /**
+     * @brief          ADC sampling done callback
+     */
+    static enum adc_action sampling_callback(const device_t *dev, const struct adc_sequence *sequence,
+                                             uint16_t sampling_index);
+
+    /**
+     * @brief          Start the next buffer pass
+     */
+    static void restart_work_handler(k_work *work);
+
+    struct adc_dt_spec spec;
+    struct adc_sequence sequence;
+    struct adc_sequence_options options;
+    struct k_poll_signal signal;
+    k_work restart_work;
+
+    size_t samples_num;
+    volatile bool is_running;
+    analog_half_handler_fn half_handler;
+    void *half_handler_arg;
+};
+#endif /* defined(CONFIG_ADC_ASYNC) */
+
+} // driver
@@ -0,0 +1,202 @@
+/**
+ * @file           : bam.hpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Bit-angle modulation LED dimming engine
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <array>
+#include <vector>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/counter.h>
+
+#include "drivers/gpio.hpp"
+
+namespace drivers
+{
+
+/**
+ * @brief           Bit-angle modulation (BAM) dimming engine
+ * @details         Dims LEDs on plain GPIO Pins. A frame consists of 8 bit-planes,
+ *                      plane `n` lasts `2^n` time units and shows bit `n` of every
+ *                      LED brightness. Per-port plane masks are precomputed when a
+ *                      brightness changes, so a frame costs 8 counter alarm
+ *                      interrupts with one masked Port write per used Port each.
+ *                      Alarms are absolute and expire right away when late, the
+ *                      counter guard period is half of its top value
+ */
+class bam_engine_t
+{
+public:
+    static constexpr size_t BITS_NUM = 8U;
+    static constexpr size_t MAX_PORTS_NUM = 5U;
+    static constexpr uint32_t DEFAULT_FRAME_RATE_HZ = 100U;
+
+    /**
+     * @brief          Constructor
+     * @param[in]      counter_dev Pointer to counter device handle used for plane timing
+     * @param[in]      frame_rate_hz Frame rate, high enough to avoid visible flicker.
+     *                     It is lowered if the shortest plane would be shorter than
+     *                     `CONFIG_APP_BAM_MIN_PLANE_US`
+     */
+    explicit bam_engine_t(const device_t *counter_dev, uint32_t frame_rate_hz = DEFAULT_FRAME_RATE_HZ);
+
+    /**
+     * @brief          Add dimmed LED channel
+     * @note           Channels are added before \ref init
+     * @param[in]      port_ptr Pointer to GPIO Port device handle
+     * @param[in]      pin GPIO Pin number in specified GPIO Port
+     * @param[in]      is_active_low `true` if GPIO Pin Active state is LOW
+     * @param[out]     channel Added channel index
+     * @return         `true` on success, `false` if too many GPIO Ports are used
+     */
+    bool add_channel(const device_t *port_ptr, uint8_t pin, bool is_active_low, size_t &channel);
+
+    /**
+     * @brief          Configure channel Pins as Outputs and start frames
+     * @return         `true` on success, `false` if
+     *                     - counter device is not ready
+     *                     - the longest plane does not fit half of the counter period
+     *                     - GPIO Pin configuration failed
+     *                     - counter failed to set guard period or to start
+     */
+    bool init();
+
+    /**
+     * @brief          Set channel brightness
+     * @details        Takes effect from the next frame
+     * @note           ISR safe
+     * @param[in]      channel Channel index
+     * @param[in]      brightness Brightness, `0` is OFF and `255` is fully ON
+     */
+    void set_brightness(size_t channel, uint8_t brightness);
+
+    /**
+     * @brief          Get channel brightness
+     * @param[in]      channel Channel index
+     */
+    uint8_t get_brightness(size_t channel) const;
+
+    /**
+     * @brief          Get actual frame rate
+     * @return         Frame rate in Hz after \ref init, `0` before
+     */
+    uint32_t get_frame_rate_hz() const;
+
+    /**
+     * @brief          Get number of plane alarms set too late since \ref init
+     * @details        A late alarm expires right away, so its plane is shown
+     *                     shorter and the frame schedule restarts from it
+     */
+    uint32_t get_late_alarms_num() const;
+
+private:
+    /**
+     * @brief          GPIO Port driven by the engine
+     */
+    struct port_t
+    {
+        const device_t *port_ptr;           /*!< GPIO Port device handle */
+        gpio_port_pins_t pins;              /*!< Mask of Pins driven by the engine */
+        gpio_port_pins_t active_low_pins;   /*!< Mask of Active LOW Pins */
+    };
+
+    /**
+     * @brief          Dimmed LED channel
+     */
+    struct channel_t
+    {
+        uint8_t port_idx;                   /*!< Index in \ref ports */
+        uint8_t pin;                        /*!< GPIO Pin number */
+        uint8_t brightness;                 /*!< Current brightness */
+    };
+
+    using planes_t = std::array<std::array<gpio_port_value_t, MAX_PORTS_NUM>, BITS_NUM>;
+
+    /**
+     * @brief          Counter alarm handler, shows the next bit-plane
+     */
+    static void alarm_handler(const device_t *dev, uint8_t chan_id, uint32_t ticks, void *user_data);
+
+    const device_t *counter_dev;            /*!< Plane timing counter device handle */
+    uint32_t frame_rate_hz;                 /*!< Requested frame rate */
+    uint32_t unit_ticks;                    /*!< Shortest plane duration in counter ticks */
+    uint32_t counter_top;                   /*!< Counter top value */
+    uint32_t alarm_ticks;                   /*!< Scheduled time of the current plane */
+    size_t plane;                           /*!< Bit-plane to be shown next */
+    bool is_late;                           /*!< The current alarm was set too late */
+    uint32_t late_alarms_num;               /*!< Number of alarms set too late */
+
+    std::array<port_t, MAX_PORTS_NUM> ports;
+    size_t ports_num;
+    std::vector<channel_t> channels;
+
+    planes_t shown_planes;                  /*!< Planes of the current frame */
+    planes_t next_planes;                   /*!< Planes updated on brightness change */
+    bool is_next_dirty;                     /*!< Planes changed since the frame start */
+    struct k_spinlock lock;
+};
+
+/**
+ * @brief           LED output channel driving a BAM engine channel
+ * @details         Active state outputs configured brightness, Inactive state
+ *                      outputs zero brightness
+ */
+class bam_output_t
+{
+public:
+    /**
+     * @brief          Constructor
+     * @param[in]      engine BAM engine the channel belongs to
+     * @param[in]      channel Engine channel index
+     * @param[in]      brightness Active state brightness
+     */
+    bam_output_t(bam_engine_t &engine, size_t channel, uint8_t brightness = UINT8_MAX)
+        : engine{engine}, channel{channel}, brightness{brightness}
+    {
+    }
+
+    bool init()
+    {
+        this->engine.set_brightness(this->channel, 0);
+        return true;
+    }
+
+    void set()
+    {
+        this->engine.set_brightness(this->channel, this->brightness);
+    }
+
+    void reset()
+    {
+        this->engine.set_brightness(this->channel, 0);
+    }
+
+private:
+    bam_engine_t &engine;                   /*!< BAM engine */
+    size_t channel;                         /*!< Engine channel index */
+    uint8_t brightness;                     /*!< Active state brightness */
+};
+
+} // driver
@@ -32,6 +32,14 @@
 namespace drivers
 {
 
+/**
+ * @brief           Hardware latched edge time source
+ * @param[in]       arg Source argument
+ * @return          System uptime of the last push edge in microseconds or
+ *                      negative value if it is unknown
+ */
+using edge_time_fn = int64_t (*)(void *arg);
+
 /**
  * @brief           Push button driver class
  */
@@ -64,6 +72,42 @@ public:
      */
     bool is_pressed();
 
+    /**
+     * @brief          Get current button pin state without debouncing
+     * @return         `true` if button's GPIO Pin is Active now, `false` otherwise
+     */
+    bool is_active();
+
+    /**
+     * @brief          Set callback notified on every button push edge
+     * @note           Callback is called in ISR context
+     * @param[in]      push_cb Pointer to push callback or `nullptr` to remove it
+     * @param[in]      push_cb_arg Argument for push callback
+     */
+    void set_push_callback(gpio_irq_handler_fn push_cb, void *push_cb_arg);
+
+    /**
+     * @brief          Set source of the push edge time latched by hardware
+     * @details        \ref get_push_time_us takes the edge time from the source
+     *                     instead of the uptime stamped by the push IRQ, so the time
+     *                     does not depend on IRQ latency, e.g.
+     *                     \ref pulse_capture_t::rising_edge_us_cb. The hardware may
+     *                     latch the edge after the IRQ fires, e.g. behind an input
+     *                     filter, so the source is read on request and its edge is
+     *                     taken only if it is close to the IRQ stamp
+     * @param[in]      edge_time_cb Pointer to edge time source or `nullptr` to remove it
+     * @param[in]      edge_time_arg Argument for edge time source
+     */
+    void set_edge_time_source(edge_time_fn edge_time_cb, void *edge_time_arg);
+
+    /**
+     * @brief          Get the last push time
+     * @details        Call after debouncing, when the hardware has latched the edge
+     * @return         System uptime of the last push edge in microseconds, the
+     *                     push IRQ time if the edge time source has no matching edge
+     */
+    int64_t get_push_time_us() const;
+
 private:
     /**
      * @brief          Button Push IRQ Handler
@@ -80,6 +124,31 @@ private:
      * @brief          Last button press timestamp, ms
      */
     int64_t press_tstamp;
+
+    /**
+     * @brief          Last button push edge timestamp, us
+     */
+    int64_t push_tstamp_us;
+
+    /**
+     * @brief          Pointer to button push callback
+     */
+    gpio_irq_handler_fn push_cb;
+
+    /**
+     * @brief          Argument for button push callback
+     */
+    void *push_cb_arg;
+
+    /**
+     * @brief          Pointer to push edge time source
+     */
+    edge_time_fn edge_time_cb;
+
+    /**
+     * @brief          Argument for push edge time source
+     */
+    void *edge_time_arg;
 };
 
 } // driver
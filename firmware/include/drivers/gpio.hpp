@@ -26,12 +26,23 @@
 
 #include <stdio.h>
 #include <memory>
+#include <zephyr/kernel.h>
 #include <zephyr/drivers/gpio.h>
+#include <zephyr/sys/atomic.h>
 
 using device_t = struct device;
 using gpio_callback_t = struct gpio_callback;
 using gpio_irq_handler_fn = void (*)(void *);
 
+#if defined(CONFIG_APP_HOT_PATH_BENCH)
+namespace core
+{
+
+class hot_path_bench_t;
+
+} // core
+#endif
+
 namespace drivers
 {
 
@@ -98,6 +109,16 @@ enum class pin_irq_trigger_t
     EdgeAny                                 /*!< Detect any switches to both states */
 };
 
+/**
+ * @brief           GPIO Pin interrupt rate limiting statistics
+ */
+struct gpio_irq_stats_t
+{
+    uint32_t delivered;                     /*!< Number of IRQ Handler callback calls */
+    uint32_t changed_holdoffs;              /*!< Number of holdoffs the Pin level changed over, each lost at least one edge */
+    uint32_t holdoffs;                      /*!< Number of times the interrupt was masked */
+};
+
 /**
  * @brief           Handle for attached to GPIO Pin IRQ Handler Callback
  */
@@ -106,13 +127,35 @@ struct gpio_irq_wrapper_t
     gpio_callback_t cb_ctx;                 /*!< IRQ Handler Callback context */
     gpio_irq_handler_fn irq_handler;        /*!< Pointer to attached IRQ Handler callback */
     void *arg;                              /*!< Argument for attached IRQ Handler callback */
+    const device_t *port_ptr;               /*!< GPIO Port device handle */
+    uint8_t pin;                            /*!< GPIO Pin number */
+    bool is_active_low;                     /*!< GPIO Pin Active state is LOW flag */
+    gpio_flags_t edge_flags;                /*!< Configured interrupt trigger flags */
+    uint32_t holdoff_us;                    /*!< Interrupt holdoff after an edge, `0` if disabled */
+    k_timer holdoff_timer;                  /*!< Interrupt re-arm timer */
+    int masked_level;                       /*!< GPIO Pin physical level when the interrupt was masked */
+    atomic_t delivered;                     /*!< See \ref gpio_irq_stats_t */
+    atomic_t changed_holdoffs;              /*!< See \ref gpio_irq_stats_t */
+    atomic_t holdoffs;                      /*!< See \ref gpio_irq_stats_t */
+};
+
+/**
+ * @brief           Shared state of a GPIO Port for cached Pin access
+ * @details         Entries are taken from a static pool of
+ *                      `CONFIG_APP_GPIO_PORT_CACHE_NUM` entries and never released
+ */
+struct gpio_port_cache_t
+{
+    const device_t *port_ptr;               /*!< GPIO Port device handle, `nullptr` if the entry is free */
+    atomic_t input;                         /*!< GPIO Port Pins physical state sampled by \ref gpio_t::sample_all */
+    atomic_t output;                        /*!< Shadow of Output Pins physical state */
 };
 
 /**
  * @brief           GPIO Pin driver class
- * @details         Controls specified GPIO Pin operation in Digital Input
- *                      or Digital Output mode
- * @todo            Implement Analog Input mode APIs
+ * @details         Controls specified GPIO Pin operation in Digital Input,
+ *                      Digital Output or Analog Input mode. Analog samples are
+ *                      acquired by \ref analog_input_t
  */
 class gpio_t
 {
@@ -164,8 +207,21 @@ public:
      */
     bool config_as_input(pin_pull_t pull);
 
+    /**
+     * @brief          Configure GPIO Pin as Analog Input
+     * @details        Disconnects digital input and output buffers, so the Pin
+     *                     can be sampled by the ADC
+     * @return         `true` if GPIO Pin configured successfully,
+     *                     `false` if
+     *                         - GPIO Port is not exists
+     *                         - GPIO Pin configuration failed
+     */
+    bool config_as_analog();
+
     /**
      * @brief          Read current physical state of GPIO Pin
+     * @details        With cached access returns the Output Pin shadow state or
+     *                     the Input Pin state at the last \ref sample_all
      * @return         Member of \ref pin_state_t
      */
     pin_state_t read_state();
@@ -176,6 +232,57 @@ public:
      */
     pin_active_state_t read_active_state();
 
+    /**
+     * @brief          Read current physical state of all Pins of the GPIO Port
+     * @details        Reads the whole Port in a single driver call, so many Pins
+     *                     of the same Port can be sampled at once
+     * @param[out]     value GPIO Port Pins state, bit `n` is the state of Pin `n`
+     * @return         `true` on success, `false` if GPIO Port reading failed
+     */
+    bool read_port_state(gpio_port_value_t &value);
+
+    /**
+     * @brief          Switch GPIO Pin to cached access
+     * @details        Input Pins read their state from the GPIO Port snapshot
+     *                     taken by \ref sample_all, Output Pins track their state
+     *                     in a shadow register. So state reads and toggles never
+     *                     read the hardware and one driver call per GPIO Port
+     *                     samples all cached Pins of it. Output Pin writes are
+     *                     still done immediately
+     * @note           Output Pins must be driven through this GPIO Pin instance
+     *                     only, otherwise the shadow register goes out of sync
+     * @return         `true` on success, `false` if
+     *                     - GPIO Port cache pool is exhausted
+     *                     - GPIO Port reading failed
+     */
+    bool enable_port_cache();
+
+    /**
+     * @brief          Take a snapshot of every cached GPIO Port
+     * @details        Call once per polling cycle before reading cached Input Pins
+     * @note           Safe to call from ISR context
+     * @return         `true` on success, `false` if any GPIO Port reading failed
+     */
+    static bool sample_all();
+
+    /**
+     * @brief          Get GPIO Port device handle
+     * @return         Pointer to controlling GPIO Port device handle
+     */
+    const device_t *get_port() const;
+
+    /**
+     * @brief          Get GPIO Pin number
+     * @return         GPIO Pin number in controlling GPIO Port
+     */
+    uint8_t get_pin() const;
+
+    /**
+     * @brief          Check GPIO Pin Active state
+     * @return         `true` if GPIO Pin Active state is LOW, `false` otherwise
+     */
+    bool get_is_active_low() const;
+
     /**
      * @brief          Enable Interrupt for GPIO Pin and attach IRQ Handler callback for it
      * @param[in]      irq_handler Pointer to IRQ Handler callback
@@ -195,6 +302,34 @@ public:
      */
     bool detach_irq();
 
+    /**
+     * @brief          Configure interrupt rate limiting
+     * @details        After every delivered edge the interrupt is masked for the
+     *                     holdoff time and re-armed from a timer, so a noisy line
+     *                     raises at most one interrupt per holdoff. Edges are not
+     *                     latched while masked: if the Pin level differs after the
+     *                     holdoff, the holdoff is counted as changed and, if the
+     *                     final level matches the trigger, the IRQ Handler callback
+     *                     is called once to catch up
+     * @param[in]      holdoff_us Holdoff time in microseconds, `0` disables rate limiting
+     */
+    void set_irq_holdoff(uint32_t holdoff_us);
+
+    /**
+     * @brief          Get interrupt rate limiting statistics
+     * @note           Edges are not counted while the interrupt is masked, so a
+     *                     holdoff that lost edges is only seen from the Pin level
+     *                     change over it. `changed_holdoffs` counts at most one per
+     *                     holdoff: edges returning the Pin to the masked level, i.e.
+     *                     an even number of them, are not counted at all
+     */
+    gpio_irq_stats_t get_irq_stats() const;
+
+    /**
+     * @brief          Reset interrupt rate limiting statistics
+     */
+    void reset_irq_stats();
+
 private:
     /**
      * @brief          Common IRQ Handler callback
@@ -206,6 +341,29 @@ private:
      */
     static void pin_irq_handler(const device_t *port, gpio_callback_t *cb, gpio_port_pins_t pins);
 
+#if defined(CONFIG_APP_HOT_PATH_BENCH)
+    friend class core::hot_path_bench_t;
+
+    /**
+     * @brief          Copy of \ref pin_irq_handler kept in flash for the hot path benchmark
+     */
+    static void pin_irq_handler_flash(const device_t *port, gpio_callback_t *cb, gpio_port_pins_t pins);
+#endif
+
+    /**
+     * @brief          Interrupt holdoff timer expiry handler
+     * @details        Re-arms the interrupt, then samples the Pin and catches up
+     *                     a missed edge if the level differs from the masked one
+     * @param[in]      timer Pointer to expired holdoff timer
+     */
+    static void holdoff_expiry_handler(k_timer *timer);
+
+    /**
+     * @brief          Drive cached Output Pin and update its shadow state
+     * @param[in]      is_high `true` to drive HIGH level, `false` to drive LOW level
+     */
+    void write_cached(bool is_high);
+
     /**
      * @brief          Pointer to controlling GPIO Port device handle
      */
@@ -222,6 +380,16 @@ private:
      */
     bool is_active_low;
 
+    /**
+     * @brief          `true` if GPIO Pin is configured as Output
+     */
+    bool is_output;
+
+    /**
+     * @brief          Pointer to GPIO Port cache or `nullptr` if access is not cached
+     */
+    gpio_port_cache_t *port_cache;
+
     /**
      * @brief          Pointer to IRQ Handler callback wrapper handle
      */
@@ -0,0 +1,218 @@
+/**
+ * @file           : i2c_scheduler.hpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Asynchronous I2C bus transaction scheduler
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/i2c.h>
+
+using device_t = struct device;
+
+namespace drivers
+{
+
+/**
+ * @brief           I2C request completion callback
+ * @note            Called in the scheduler thread context
+ * @param[in]       result `0` on success, negative errno otherwise
+ * @param[in]       arg Callback argument
+ */
+using i2c_done_fn = void (*)(int result, void *arg);
+
+/**
+ * @brief           Register access request, owned by the caller until completion
+ */
+struct i2c_request_t
+{
+    uint16_t addr;                          /*!< Device address */
+    uint8_t reg;                            /*!< First register address */
+    uint8_t auto_inc_mask;                  /*!< Register address bits enabling auto-increment, e.g. `0x80` on LSM303 accelerometer */
+    bool is_write;                          /*!< `true` for write, `false` for read */
+    uint8_t *buf;                           /*!< Data buffer */
+    size_t len;                             /*!< Data length in bytes */
+    i2c_done_fn done_cb;                    /*!< Completion callback, may be `nullptr` */
+    void *done_arg;                         /*!< Completion callback argument */
+    i2c_request_t *next;                    /*!< Scheduler queue link */
+};
+
+/**
+ * @brief           I2C bus statistics
+ */
+struct i2c_bus_stats_t
+{
+    uint32_t requests;                      /*!< Number of completed requests */
+    uint32_t transactions;                  /*!< Number of bus transactions */
+    uint32_t merged;                        /*!< Number of requests served by another request transaction */
+    uint32_t errors;                        /*!< Number of failed transactions */
+    uint32_t bytes;                         /*!< Number of data bytes transferred */
+    uint64_t busy_us;                       /*!< Time spent in bus transactions */
+    uint64_t window_us;                     /*!< Time since statistics reset */
+};
+
+/**
+ * @brief           Asynchronous I2C bus transaction scheduler
+ * @details         Requests are queued from any context and served in order by
+ *                      a scheduler thread, so callers never block on the bus.
+ *                      Reads of the same device queued together are merged when
+ *                      their register ranges touch or overlap: one auto-increment
+ *                      burst replaces several transactions and their start and
+ *                      address overhead. Reads are never merged across a write to
+ *                      the same device. With `CONFIG_I2C_CALLBACK` transactions
+ *                      run through `i2c_transfer_cb()`, otherwise blocking
+ *                      `i2c_transfer()` is called from the scheduler thread
+ */
+class i2c_scheduler_t
+{
+public:
+    /**
+     * @brief          Maximum number of requests merged into one transaction
+     */
+    static constexpr size_t BATCH_MAX = 16U;
+
+    /**
+     * @brief          Maximum merged read burst length in bytes
+     */
+    static constexpr size_t BURST_MAX = 32U;
+
+    /**
+     * @brief          Constructor
+     * @param[in]      bus_dev Pointer to I2C controller device handle
+     */
+    explicit i2c_scheduler_t(const device_t *bus_dev);
+
+    i2c_scheduler_t(const i2c_scheduler_t &) = delete;
+    i2c_scheduler_t(i2c_scheduler_t &&) = delete;
+    i2c_scheduler_t &operator=(const i2c_scheduler_t &) = delete;
+    i2c_scheduler_t &&operator=(i2c_scheduler_t &&) = delete;
+
+    /**
+     * @brief          Start the scheduler thread
+     * @param[in]      stack_ptr Pointer to scheduler thread stack
+     * @param[in]      stack_size Scheduler thread stack size
+     * @param[in]      prio Scheduler thread priority
+     * @return         `true` on success, `false` if I2C controller is not ready
+     */
+    bool init(k_thread_stack_t *stack_ptr, size_t stack_size, int prio);
+
+    /**
+     * @brief          Queue a request
+     * @note           Safe to call from ISR context
+     * @param[in]      request Request, must stay valid until its completion callback
+     * @return         `true` on success, `false` if
+     *                     - request has no data
+     */
+    bool submit(i2c_request_t &request);
+
+    /**
+     * @brief          Fill and queue a registers read request
+     * @param[out]     request Request storage, must stay valid until completion
+     * @param[in]      addr Device address
+     * @param[in]      reg First register address
+     * @param[out]     buf Data buffer
+     * @param[in]      len Data length in bytes
+     * @param[in]      auto_inc_mask Register address bits enabling auto-increment
+     * @param[in]      done_cb Completion callback
+     * @param[in]      done_arg Completion callback argument
+     * @return         See \ref submit
+     */
+    bool read_regs(i2c_request_t &request, uint16_t addr, uint8_t reg, uint8_t *buf, size_t len,
+                       uint8_t auto_inc_mask, i2c_done_fn done_cb, void *done_arg);
+
+    /**
+     * @brief          Fill and queue a registers write request
+     * @details        Arguments are the same as \ref read_regs ones
+     */
+    bool write_regs(i2c_request_t &request, uint16_t addr, uint8_t reg, uint8_t *buf, size_t len,
+                        uint8_t auto_inc_mask, i2c_done_fn done_cb, void *done_arg);
+
+    /**
+     * @brief          Get bus statistics
+     */
+    i2c_bus_stats_t get_stats();
+
+    /**
+     * @brief          Get bus utilization since statistics reset
+     * @return         Busy time share in percent
+     */
+    uint32_t get_utilization_pct();
+
+    /**
+     * @brief          Reset bus statistics
+     */
+    void reset_stats();
+
+private:
+    /**
+     * @brief          Take up to \ref BATCH_MAX queued requests in queue order
+     * @return         Number of taken requests
+     */
+    size_t take_batch(i2c_request_t **batch);
+
+    /**
+     * @brief          Serve the batch, merging reads where possible
+     */
+    void run_batch(i2c_request_t **batch, size_t batch_size);
+
+    /**
+     * @brief          Run one bus transaction: register address write and data read or write
+     * @return         `0` on success, negative errno otherwise
+     */
+    int transfer(uint16_t addr, uint8_t reg, uint8_t *buf, size_t len, bool is_write);
+
+    /**
+     * @brief          Complete the request and call its callback
+     */
+    void complete(i2c_request_t *request, int result);
+
+    static void scheduler_thread(void *arg1, void *arg2, void *arg3);
+
+#if defined(CONFIG_I2C_CALLBACK)
+    static void transfer_done_cb(const device_t *dev, int result, void *arg);
+
+    k_sem transfer_sem;
+    int transfer_result;
+#endif
+
+    const device_t *bus_dev;
+
+    k_thread thread;
+    k_sem queue_sem;
+    k_spinlock lock;
+
+    i2c_request_t *head;
+    i2c_request_t *tail;
+
+    /**
+     * @brief          Merged read burst buffer
+     */
+    uint8_t burst[BURST_MAX];
+
+    i2c_bus_stats_t stats;
+    int64_t window_start_ms;
+};
+
+} // driver
@@ -0,0 +1,169 @@
+/**
+ * @file           : key_matrix.hpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Scanned key matrix driver
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <vector>
+
+#include "drivers/gpio.hpp"
+
+namespace drivers
+{
+
+/**
+ * @brief           Possible key events
+ */
+enum class key_event_t
+{
+    Press,                                  /*!< Key became pressed */
+    Release                                 /*!< Key became released */
+};
+
+/**
+ * @brief           Key event handler callback
+ * @param[in]       arg Argument passed on handler registration
+ * @param[in]       key Key number, `row * cols_num + col`
+ * @param[in]       event Key event
+ */
+using key_event_handler_fn = void (*)(void *arg, uint8_t key, key_event_t event);
+
+/**
+ * @brief           Scanned key matrix driver class
+ * @details         Drives matrix rows one by one and samples columns as whole
+ *                      GPIO Port snapshots. All keys are debounced at once with
+ *                      2-bit vertical counters kept in packed state words, so
+ *                      a key state change is accepted after 4 equal consecutive
+ *                      scans and the scan cost does not depend on the number of keys
+ */
+class key_matrix_t
+{
+public:
+    /**
+     * @brief          Maximum number of keys, one bit per key in state words
+     */
+    static constexpr size_t MAX_KEYS_NUM = 64U;
+
+    /**
+     * @brief          Maximum number of columns
+     */
+    static constexpr size_t MAX_COLS_NUM = 16U;
+
+    /**
+     * @brief          Constructor
+     * @param[in]      rows Pointer to array of row GPIO Pin specifications,
+     *                     rows must be `GPIO_ACTIVE_LOW`
+     * @param[in]      rows_num Number of rows
+     * @param[in]      cols Pointer to array of column GPIO Pin specifications
+     * @param[in]      cols_num Number of columns
+     */
+    key_matrix_t(const struct gpio_dt_spec *rows, size_t rows_num,
+                     const struct gpio_dt_spec *cols, size_t cols_num);
+
+    /**
+     * @brief          Initialize key matrix
+     * @param[in]      cols_pull Columns GPIO Pins bias pull
+     * @param[in]      event_handler Key event handler callback
+     * @param[in]      event_handler_arg Argument for key event handler callback
+     * @param[in]      settle_us Row signal settling time before columns sampling
+     * @return         `true` on success, `false` if
+     *                     - matrix has more than \ref MAX_KEYS_NUM keys
+     *                         or more than \ref MAX_COLS_NUM columns
+     *                     - a row is not active low, Open Drain rows can only
+     *                         drive the selected row LOW
+     *                     - failed to configure row GPIO as Output
+     *                     - failed to configure column GPIO as Input
+     */
+    bool init(gpio::pin_pull_t cols_pull, key_event_handler_fn event_handler, void *event_handler_arg,
+                  uint32_t settle_us = 2U);
+
+    /**
+     * @brief          Scan the matrix, debounce keys and emit key events
+     * @note           Scan should be done periodically, e.g. every 1 millisecond
+     */
+    void scan();
+
+    /**
+     * @brief          Get debounced key state
+     * @param[in]      key Key number
+     * @return         `true` if key is pressed, `false` otherwise
+     */
+    bool is_pressed(uint8_t key) const;
+
+    /**
+     * @brief          Get debounced state of all keys
+     * @return         Bit `n` is set if key `n` is pressed
+     */
+    uint64_t get_pressed_keys() const;
+
+private:
+    /**
+     * @brief          Sample raw state of all keys
+     * @return         Bit `n` is set if key `n` is active
+     */
+    uint64_t sample();
+
+    /**
+     * @brief          Sample active columns of the currently driven row
+     * @return         Bit `n` is set if column `n` is active
+     */
+    uint32_t sample_cols();
+
+    /**
+     * @brief          Row GPIO Pins instances
+     */
+    std::vector<gpio::gpio_t> rows;
+
+    /**
+     * @brief          Column GPIO Pins instances
+     */
+    std::vector<gpio::gpio_t> cols;
+
+    /**
+     * @brief          Distinct GPIO Ports of columns, each is read once per row
+     */
+    std::vector<const device_t *> cols_ports;
+
+    /**
+     * @brief          Index in \ref cols_ports of every column
+     */
+    std::vector<uint8_t> cols_port_idx;
+
+    /**
+     * @brief          `true` if all columns are consecutive Pins of one GPIO Port
+     *                     with the same polarity, so they are extracted with one shift
+     */
+    bool is_cols_contiguous;
+
+    uint64_t debounced;                     /*!< Debounced keys state */
+    uint64_t cnt0;                          /*!< Vertical counters bit 0 */
+    uint64_t cnt1;                          /*!< Vertical counters bit 1 */
+
+    key_event_handler_fn event_handler;     /*!< Key event handler callback */
+    void *event_handler_arg;                /*!< Argument for key event handler callback */
+    uint32_t settle_us;                     /*!< Row signal settling time */
+};
+
+} // driver
@@ -26,57 +26,143 @@
 
 #include <stdint.h>
 #include <stddef.h>
-#include <limits>
+#include <array>
+#include <concepts>
+#include <optional>
+#include <utility>
+#include <zephyr/kernel.h>
 
-#include "drivers/gpio.hpp"
+#include "core/hot_path.hpp"
+#include "drivers/led_outputs.hpp"
+#include "drivers/led_pattern.hpp"
 
 namespace drivers
 {
 
+/**
+ * @brief           LED output channel requirements
+ * @details         Output channel drives the LED to Active (\ref set) or
+ *                      Inactive (\ref reset) state. Calls are resolved at compile
+ *                      time, so the channel is inlined into \ref led_t methods
+ */
+template <typename T>
+concept led_output_channel = requires(T output) {
+    { output.init() } -> std::same_as<bool>;
+    output.set();
+    output.reset();
+};
+
+/**
+ * @brief           LED pattern layers in ascending priority order
+ */
+enum class led_layer_t : uint8_t
+{
+    Base = 0,                               /*!< Device status */
+    Overlay,                                /*!< Notifications shown over the status */
+    Mute,                                   /*!< Mask hiding all lower layers */
+    Count
+};
+
+/**
+ * @brief           Number of LED pattern layers
+ */
+constexpr size_t LED_LAYERS_NUM = static_cast<size_t>(led_layer_t::Count);
+
+/**
+ * @brief           LED layer patterns, empty layers are transparent
+ */
+using led_layers_t = std::array<std::optional<led_pattern_t>, LED_LAYERS_NUM>;
+
+/**
+ * @brief           LED usage counters
+ */
+struct led_stats_t
+{
+    uint64_t on_ms;                         /*!< Time the LED output was ON */
+    uint64_t muted_ms;                      /*!< Time the Mute layer hid lower layers */
+    uint32_t transitions;                   /*!< Number of LED output changes */
+};
+
 /**
  * @brief           LED driver class
- * @details         Controls the LED in one of the given mode:
- *                        - solid state operation (ON/OFF)
- *                        - blinking with specified ON/OFF periods
- *                      The class is designed so that the LED state is updated
- *                      periodically by some thread or hardware timer
+ * @details         Composes the LED state from a stack of pattern layers, see
+ *                      \ref led_layer_t. The topmost active layer defines the
+ *                      LED state, cleared and ended layers are transparent. So
+ *                      independent subsystems own their layers and lower layers
+ *                      keep their phase while hidden. The composed state is
+ *                      recomputed only when a layer changes or when the next
+ *                      transition of the visible layer is due.
+ *                      Usage counters are accumulated at the same time, so
+ *                      they add no work between transitions
+ * @tparam          Output LED output channel type, see \ref led_output_channel
  */
+template <led_output_channel Output>
 class led_t
 {
 public:
     /**
      * @brief          The value, at which the LED blinks forever
      */
-    static constexpr size_t BLINK_FOREVER = std::numeric_limits<uint32_t>::max();
+    static constexpr size_t BLINK_FOREVER = led_pattern_t::BLINK_FOREVER;
+
+    /**
+     * @brief          Transition time returned when the LED state never changes
+     */
+    static constexpr int64_t NO_TRANSITION = led_pattern_t::NO_TRANSITION;
+
+    /**
+     * @brief          Number of pattern layers
+     */
+    static constexpr size_t LAYERS_NUM = LED_LAYERS_NUM;
+
+    /**
+     * @brief          Layer patterns, empty layers are transparent
+     */
+    using layers_t = led_layers_t;
 
     /**
      * @brief          Constructor
-     * @param[in]      port_ptr Pointer to LED's GPIO Port device handle
-     * @param[in]      pin GPIO Pin number in specified GPIO Port
-     * @param[in]      is_active_low `true` if LED's GPIO Pin Active state is LOW,
-     *                     so as not to care about the inverted logic
+     * @param[in]      args Arguments forwarded to output channel constructor,
+     *                     e.g. GPIO Port, Pin and active low flag for \ref gpio_output_t
      */
-    led_t(const device_t *port_ptr, uint8_t pin, bool is_active_low = false);
+    template <typename... Args>
+        requires std::constructible_from<Output, Args...>
+    explicit led_t(Args &&...args);
 
     /**
      * @brief          Initialize LED
      * @return         `true` on success, `false` if
-     *                     - failed to configure LED GPIO as Output
+     *                     - failed to initialize LED output channel
      */
     bool init();
 
     /**
-     * @brief          Set LED to solid ON state
+     * @brief          Set pattern of the layer
+     * @details        The LED output changes on the next \ref update call
+     * @param[in]      layer Pattern layer
+     * @param[in]      pattern Layer pattern
+     */
+    void set_layer(led_layer_t layer, const led_pattern_t &pattern);
+
+    /**
+     * @brief          Make the layer transparent
+     * @details        The LED output changes on the next \ref update call
+     * @param[in]      layer Pattern layer
+     */
+    void clear_layer(led_layer_t layer);
+
+    /**
+     * @brief          Set Base layer to solid ON state
      */
     void turn_on();
 
     /**
-     * @brief          Set LED to solid OFF state
+     * @brief          Set Base layer to solid OFF state
      */
     void turn_off();
 
     /**
-     * @brief          Set LED to blinking state with given configuration
+     * @brief          Set Base layer to blinking state with given configuration
      * @param[in]      on_ms: LED's ON state period in milliseconds
      * @param[in]      off_ms: LED's OFF state period in milliseconds
      * @param[in]      blinks_num: Number of blinks or \ref led_t::BLINK_FOREVER
@@ -89,89 +175,388 @@ public:
 
     /**
      * @brief          Set "Silent Blink" mode to active state
-     * @details        If the LED is operating in \ref mode_t::BLINK mode,
-     *                    the "Silent Blink" mode can be used. In this mode the LED
-     *                    is turning OFF, but state counters continues to update
-     *                    to save current LED operation state
+     * @details        Turns the LED OFF with the Mute layer. Blinking phase of
+     *                     lower layers keeps running
      */
     void set_silent_blink();
 
     /**
      * @brief          Set "Silent Blink" mode to inactive state
-     * @details        The LED continues to blink according to it's current
-     *                     operation status
+     * @details        Clears the Mute layer, the LED continues to blink
+     *                     according to it's current operation status
      */
     void reset_silent_blink();
 
     /**
-     * @brief          Update current LED operation status
-     * @note           Update should be done every 1 millisecond
+     * @brief          Update LED output to its state at given time
+     * @details        Does nothing unless a layer changed or the next
+     *                     transition is due
+     * @param[in]      now_ms System uptime in milliseconds
+     */
+    void update(int64_t now_ms);
+
+    /**
+     * @brief          Update LED output to its current state
+     * @note           Update may be done at any rate, the LED state changes
+     *                     exactly at \ref next_transition_ms times
      */
     void update_ms();
 
+    /**
+     * @brief          Evaluate composed LED state at given time
+     * @param[in]      time_ms System uptime in milliseconds
+     * @return         `true` if the LED is ON at given time, `false` otherwise
+     */
+    bool is_on_at(int64_t time_ms) const;
+
+    /**
+     * @brief          Get time of the next LED state change
+     * @param[in]      now_ms System uptime in milliseconds
+     * @return         System uptime of the next transition in milliseconds,
+     *                     `now_ms` if a layer changed since the last \ref update
+     *                     or \ref NO_TRANSITION if the LED state never changes
+     */
+    int64_t next_transition_ms(int64_t now_ms) const;
+
+    /**
+     * @brief          Get LED usage counters
+     * @param[in]      now_ms System uptime in milliseconds, the time since the
+     *                     last transition is counted up to it
+     * @return         Usage counters since \ref init or \ref reset_stats
+     */
+    led_stats_t get_stats(int64_t now_ms) const;
+
+    /**
+     * @brief          Reset LED usage counters
+     * @param[in]      now_ms System uptime in milliseconds
+     */
+    void reset_stats(int64_t now_ms);
+
+    /**
+     * @brief          Get output channel instance
+     */
+    const Output &get_output() const;
+
+    /**
+     * @brief          Get patterns of all layers, e.g. to save them over a reset
+     */
+    const layers_t &get_layers() const;
+
+    /**
+     * @brief          Replace patterns of all layers
+     * @details        The LED output changes on the next \ref update call
+     * @param[in]      layers Layer patterns returned by \ref get_layers
+     * @param[in]      offset_ms Time shift applied to every pattern, so the
+     *                     patterns keep their phase on a new uptime base
+     */
+    void restore_layers(const layers_t &layers, int64_t offset_ms);
+
 private:
+
+    /**
+     * @brief          Find the topmost layer active at given time
+     * @param[in]      time_ms System uptime in milliseconds
+     * @return         Pointer to layer pattern or `nullptr` if all layers are transparent
+     */
+    const led_pattern_t *visible_layer_at(int64_t time_ms) const;
+
+    /**
+     * @brief          Set layer pattern and update LED output immediately
+     */
+    void apply_layer(led_layer_t layer, const std::optional<led_pattern_t> &pattern, int64_t now_ms);
+
     /**
-     * @brief          Check LED blinks counter for zeroing
-     * @return         'true' if the counter has expired, 'false' if counting is disabled
-     *                     or the counter is not zero
+     * @brief          Drive LED output to given state, if it differs from the current one
+     * @param[in]      is_on `true` to turn output ON, `false` to turn output OFF
      */
-    bool is_blinks_cnt_expired();
+    void write_output(bool is_on);
 
     /**
-     * @brief          Check any counter for zeroing transition
-     * @param[in,out]  cnt_ptr: Pointer to counter for checking
-     * @return         'true' if zeroing is detected, 'false' if counter is equal zero or
-     *                     zeroing transition is not detected
+     * @brief          Add the time since the last accounting to usage counters
+     * @param[in]      now_ms System uptime in milliseconds
      */
-    static bool check_for_counter_zeroing(uint32_t *cnt_ptr);
+    void account(int64_t now_ms);
 
     /**
-     * @brief          Clear blink operation configs and status data
+     * @brief          LED output channel instance
      */
-    void reset_blinking();
+    Output output;
 
     /**
-     * @brief          LED driver operation configs
+     * @brief          Layer patterns, empty layers are transparent
      */
-    struct config_t
-    {
-        uint32_t on_timeout_ms;             /*!< LED ON state period in milliseconds */
-        uint32_t off_timeout_ms;            /*!< LED OFF state period in milliseconds */
-        uint32_t pend_timeout_ms;           /*!< Blinking pending start timeout in milliseconds */
-        size_t   blinks_num;                /*!< Number of blinks or \ref led_t::BLINK_FOREVER
-                                                     in case of endless blinking */
-    } config;
+    layers_t layers;
 
     /**
-     * @brief          LED driver operation status
+     * @brief          Time of the next composed state change
      */
-    struct status_t
-    {
-        uint32_t on_ms;                     /*!< Time to end of turned ON period in milliseconds */
-        uint32_t off_ms;                    /*!< Time to end of turned OFF period in milliseconds */
-        uint32_t pend_ms;                   /*!< Time to end of blinking pending start in milliseconds */
-        size_t   blinks_cnt;                /*!< Blinks counter of the configured LED blinking operation */
-    } status;
+    int64_t deadline_ms;
 
     /**
-     * @brief          LED GPIO Pin instance
+     * @brief          A layer changed since the last \ref update flag
      */
-    drivers::gpio::gpio_t gpio;
+    bool is_dirty;
 
     /**
-     * @brief          LED driver operation mode
+     * @brief          Current LED output state
      */
-    enum class mode_t
-    {
-        SOLID = 0,                          /*!< Solid state operation (ON/OFF) */
-        BLINK,                              /*!< Blinking with specified ON/OFF periods */
-    } mode;
+    bool is_output_on;
 
     /**
-     * @brief          Is "Silent Blink" mode active flag
-     * @details        `true` if "Silent Blink" mode is active, `false` otherwise
+     * @brief          The Mute layer is the visible one flag
      */
-    bool is_silent_blink;
+    bool is_muted;
+
+    /**
+     * @brief          Usage counters accumulated up to \ref accounted_ms
+     */
+    led_stats_t stats;
+
+    /**
+     * @brief          Time the usage counters are accumulated up to
+     */
+    int64_t accounted_ms;
 };
 
+/**
+ * @brief           Explicitly instantiate LED driver for the output channel type
+ * @details         GCC ignores section attributes on class template members,
+ *                      so hot path members take \ref FW_HOT per instantiation.
+ *                      Use inside `drivers` namespace
+ * @param           Output LED output channel type
+ */
+#define LED_INSTANTIATE(Output)                                                         \
+    template FW_HOT void led_t<Output>::update(int64_t now_ms);                         \
+    template FW_HOT void led_t<Output>::update_ms();                                    \
+    template FW_HOT const led_pattern_t *led_t<Output>::visible_layer_at(int64_t) const; \
+    template FW_HOT void led_t<Output>::write_output(bool is_on);                       \
+    template FW_HOT void led_t<Output>::account(int64_t now_ms);                        \
+    template class led_t<Output>
+
+/**
+ * @brief           LED driven by a GPIO Pin
+ */
+using gpio_led_t = led_t<gpio_output_t>;
+
+extern template class led_t<gpio_output_t>;
+
+template <led_output_channel Output>
+template <typename... Args>
+    requires std::constructible_from<Output, Args...>
+led_t<Output>::led_t(Args &&...args)
+    : output(std::forward<Args>(args)...),
+      layers{},
+      deadline_ms{led_t::NO_TRANSITION},
+      is_dirty{false},
+      is_output_on{false},
+      is_muted{false},
+      stats{},
+      accounted_ms{0}
+{
+}
+
+template <led_output_channel Output>
+bool led_t<Output>::init()
+{
+    this->is_output_on = false;
+    this->reset_stats(k_uptime_get());
+    return this->output.init();
+}
+
+template <led_output_channel Output>
+void led_t<Output>::set_layer(led_layer_t layer, const led_pattern_t &pattern)
+{
+    this->layers[static_cast<size_t>(layer)] = pattern;
+    this->is_dirty = true;
+}
+
+template <led_output_channel Output>
+void led_t<Output>::clear_layer(led_layer_t layer)
+{
+    this->layers[static_cast<size_t>(layer)].reset();
+    this->is_dirty = true;
+}
+
+template <led_output_channel Output>
+void led_t<Output>::turn_on()
+{
+    int64_t now_ms = k_uptime_get();
+    this->apply_layer(led_layer_t::Base, led_pattern_t::solid(true, now_ms), now_ms);
+}
+
+template <led_output_channel Output>
+void led_t<Output>::turn_off()
+{
+    int64_t now_ms = k_uptime_get();
+    this->apply_layer(led_layer_t::Base, led_pattern_t::solid(false, now_ms), now_ms);
+}
+
+template <led_output_channel Output>
+void led_t<Output>::blink(uint32_t on_ms, uint32_t off_ms, size_t blinks_num, uint32_t pend_ms)
+{
+    int64_t now_ms = k_uptime_get();
+    this->apply_layer(led_layer_t::Base, led_pattern_t::blink(now_ms, on_ms, off_ms, blinks_num, pend_ms), now_ms);
+}
+
+template <led_output_channel Output>
+void led_t<Output>::set_silent_blink()
+{
+    int64_t now_ms = k_uptime_get();
+    this->apply_layer(led_layer_t::Mute, led_pattern_t::solid(false, now_ms), now_ms);
+}
+
+template <led_output_channel Output>
+void led_t<Output>::reset_silent_blink()
+{
+    this->apply_layer(led_layer_t::Mute, std::nullopt, k_uptime_get());
+}
+
+template <led_output_channel Output>
+void led_t<Output>::update(int64_t now_ms)
+{
+    if (!this->is_dirty && (now_ms < this->deadline_ms)) {
+        return;
+    }
+
+    /* The interval up to now was spent in the previous state */
+    this->account(now_ms);
+
+    /* Mute is the topmost layer, so it hides the others whenever it is active */
+    const std::optional<led_pattern_t> &mute = this->layers[static_cast<size_t>(led_layer_t::Mute)];
+    this->is_muted = mute.has_value() && mute->is_active_at(now_ms);
+
+    /* Layers below the visible one cannot show up before it changes or ends */
+    const led_pattern_t *visible = this->visible_layer_at(now_ms);
+    if (visible == nullptr) {
+        this->write_output(false);
+        this->deadline_ms = led_t::NO_TRANSITION;
+    }
+    else {
+        this->write_output(visible->is_on_at(now_ms));
+        this->deadline_ms = visible->next_transition_ms(now_ms);
+    }
+
+    this->is_dirty = false;
+}
+
+template <led_output_channel Output>
+void led_t<Output>::update_ms()
+{
+    this->update(k_uptime_get());
+}
+
+template <led_output_channel Output>
+bool led_t<Output>::is_on_at(int64_t time_ms) const
+{
+    const led_pattern_t *visible = this->visible_layer_at(time_ms);
+    return (visible != nullptr) && visible->is_on_at(time_ms);
+}
+
+template <led_output_channel Output>
+int64_t led_t<Output>::next_transition_ms(int64_t now_ms) const
+{
+    return this->is_dirty ? now_ms : this->deadline_ms;
+}
+
+template <led_output_channel Output>
+led_stats_t led_t<Output>::get_stats(int64_t now_ms) const
+{
+    led_stats_t stats = this->stats;
+    if (now_ms > this->accounted_ms) {
+        uint64_t elapsed_ms = static_cast<uint64_t>(now_ms - this->accounted_ms);
+        stats.on_ms += this->is_output_on ? elapsed_ms : 0;
+        stats.muted_ms += this->is_muted ? elapsed_ms : 0;
+    }
+
+    return stats;
+}
+
+template <led_output_channel Output>
+void led_t<Output>::reset_stats(int64_t now_ms)
+{
+    this->stats = {};
+    this->accounted_ms = now_ms;
+}
+
+template <led_output_channel Output>
+const Output &led_t<Output>::get_output() const
+{
+    return this->output;
+}
+
+template <led_output_channel Output>
+const typename led_t<Output>::layers_t &led_t<Output>::get_layers() const
+{
+    return this->layers;
+}
+
+template <led_output_channel Output>
+void led_t<Output>::restore_layers(const layers_t &layers, int64_t offset_ms)
+{
+    for (size_t i = 0; i < LAYERS_NUM; ++i) {
+        if (layers[i].has_value()) {
+            this->layers[i] = layers[i]->shifted(offset_ms);
+        }
+        else {
+            this->layers[i].reset();
+        }
+    }
+    this->is_dirty = true;
+}
+
+template <led_output_channel Output>
+const led_pattern_t *led_t<Output>::visible_layer_at(int64_t time_ms) const
+{
+    for (size_t i = LAYERS_NUM; i > 0; --i) {
+        const std::optional<led_pattern_t> &layer = this->layers[i - 1];
+        if (layer.has_value() && layer->is_active_at(time_ms)) {
+            return &*layer;
+        }
+    }
+
+    return nullptr;
+}
+
+template <led_output_channel Output>
+void led_t<Output>::apply_layer(led_layer_t layer, const std::optional<led_pattern_t> &pattern, int64_t now_ms)
+{
+    this->layers[static_cast<size_t>(layer)] = pattern;
+    this->is_dirty = true;
+    this->update(now_ms);
+}
+
+template <led_output_channel Output>
+void led_t<Output>::write_output(bool is_on)
+{
+    if (is_on == this->is_output_on) {
+        return;
+    }
+
+    if (is_on) {
+        this->output.set();
+    }
+    else {
+        this->output.reset();
+    }
+    this->is_output_on = is_on;
+    ++this->stats.transitions;
+}
+
+template <led_output_channel Output>
+void led_t<Output>::account(int64_t now_ms)
+{
+    if (now_ms <= this->accounted_ms) {
+        return;
+    }
+
+    uint64_t elapsed_ms = static_cast<uint64_t>(now_ms - this->accounted_ms);
+    if (this->is_output_on) {
+        this->stats.on_ms += elapsed_ms;
+    }
+    if (this->is_muted) {
+        this->stats.muted_ms += elapsed_ms;
+    }
+    this->accounted_ms = now_ms;
+}
+
 } // driver
@@ -0,0 +1,167 @@
+/**
+ * @file           : led_checkpoint.hpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : LEDs state image kept over warm resets
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <type_traits>
+#include <zephyr/sys/crc.h>
+
+#include "drivers/led.hpp"
+#include "drivers/led_pattern.hpp"
+
+namespace drivers
+{
+
+/**
+ * @brief           LEDs state image kept over warm resets
+ * @details         Plain memory record of LED layer patterns and currents
+ *                      protected by CRC. It has a trivial default constructor,
+ *                      so a `__noinit` instance is not touched by the static
+ *                      initialization at boot. The image is written with
+ *                      \ref save_led calls followed by \ref seal, the uptime of
+ *                      the last LEDs update is stamped with \ref mark_alive
+ * @tparam          LEDS Number of LEDs
+ */
+template <size_t LEDS>
+class led_checkpoint_t
+{
+public:
+    /**
+     * @brief          Save state of one LED, the image is invalid until \ref seal
+     * @param[in]      led LED index
+     * @param[in]      layers LED layer patterns
+     * @param[in]      current_ua LED current in microamps
+     */
+    void save_led(size_t led, const led_layers_t &layers, uint32_t current_ua)
+    {
+        this->magic = 0;
+        memset(this->payload.patterns[led], 0, sizeof(this->payload.patterns[led]));
+        this->payload.present_masks[led] = 0;
+
+        for (size_t i = 0; i < LED_LAYERS_NUM; ++i) {
+            if (layers[i].has_value()) {
+                this->payload.patterns[led][i] = layers[i]->to_record();
+                this->payload.present_masks[led] |= BIT(i);
+            }
+        }
+        this->payload.currents_ua[led] = current_ua;
+    }
+
+    /**
+     * @brief          Protect saved LEDs state with CRC and mark the image valid
+     * @param[in]      now_ms System uptime in milliseconds
+     */
+    void seal(int64_t now_ms)
+    {
+        this->crc = this->payload_crc();
+        this->mark_alive(now_ms);
+        this->magic = led_checkpoint_t::MAGIC;
+    }
+
+    /**
+     * @brief          Stamp the uptime, at which LED outputs matched the saved state
+     * @details        Written on every LEDs update, so it is protected by its
+     *                     inverted copy instead of CRC
+     * @param[in]      now_ms System uptime in milliseconds
+     */
+    void mark_alive(int64_t now_ms)
+    {
+        this->alive_ms = now_ms;
+        this->alive_ms_inv = ~now_ms;
+    }
+
+    /**
+     * @brief          Check the image is sealed and not corrupted
+     */
+    bool is_valid() const
+    {
+        return (this->magic == led_checkpoint_t::MAGIC) &&
+               (this->alive_ms == ~this->alive_ms_inv) &&
+               (this->crc == this->payload_crc());
+    }
+
+    /**
+     * @brief          Mark the image invalid
+     */
+    void invalidate()
+    {
+        this->magic = 0;
+    }
+
+    /**
+     * @brief          Get uptime of the last LEDs update before the reset
+     */
+    int64_t get_alive_ms() const
+    {
+        return this->alive_ms;
+    }
+
+    /**
+     * @brief          Load state of one LED
+     * @param[in]      led LED index
+     * @param[out]     layers LED layer patterns
+     * @param[out]     current_ua LED current in microamps
+     */
+    void load_led(size_t led, led_layers_t &layers, uint32_t &current_ua) const
+    {
+        for (size_t i = 0; i < LED_LAYERS_NUM; ++i) {
+            if ((this->payload.present_masks[led] & BIT(i)) != 0) {
+                layers[i] = led_pattern_t::from_record(this->payload.patterns[led][i]);
+            }
+            else {
+                layers[i].reset();
+            }
+        }
+        current_ua = this->payload.currents_ua[led];
+    }
+
+private:
+    static constexpr uint32_t MAGIC = 0x4C454453U; // "LEDS"
+
+    /**
+     * @brief          LEDs state protected by CRC
+     */
+    struct payload_t
+    {
+        led_pattern_record_t patterns[LEDS][LED_LAYERS_NUM];   /*!< Layer patterns */
+        uint32_t present_masks[LEDS];       /*!< Bit per layer, set if the layer has a pattern */
+        uint32_t currents_ua[LEDS];         /*!< LED currents in microamps */
+    };
+
+    uint32_t payload_crc() const
+    {
+        return crc32_ieee(reinterpret_cast<const uint8_t *>(&this->payload), sizeof(this->payload));
+    }
+
+    uint32_t magic;                         /*!< \ref MAGIC when the image is valid */
+    uint32_t crc;                           /*!< CRC-32 of the payload */
+    payload_t payload;                      /*!< LEDs state */
+    int64_t alive_ms;                       /*!< Uptime of the last LEDs update */
+    int64_t alive_ms_inv;                   /*!< Inverted alive_ms */
+};
+
+} // driver
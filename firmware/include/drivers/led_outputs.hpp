@@ -0,0 +1,265 @@
+/**
+ * @file           : led_outputs.hpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : LED output channel backends
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <array>
+
+#if defined(CONFIG_PWM)
+#include <zephyr/drivers/pwm.h>
+#endif
+
+#include "drivers/gpio.hpp"
+
+namespace drivers
+{
+
+/**
+ * @brief           LED output channel driving a GPIO Pin
+ */
+class gpio_output_t
+{
+public:
+    /**
+     * @brief          Constructor
+     * @param[in]      port_ptr Pointer to GPIO Port device handle
+     * @param[in]      pin GPIO Pin number in specified GPIO Port
+     * @param[in]      is_active_low `true` if GPIO Pin Active state is LOW
+     */
+    gpio_output_t(const device_t *port_ptr, uint8_t pin, bool is_active_low = false)
+        : gpio{port_ptr, pin, is_active_low}
+    {
+    }
+
+    bool init()
+    {
+        return this->gpio.config_as_output(gpio::pin_output_mode_t::PushPull, gpio::pin_active_state_t::Inactive);
+    }
+
+    void set()
+    {
+        this->gpio.set();
+    }
+
+    void reset()
+    {
+        this->gpio.reset();
+    }
+
+private:
+    /**
+     * @brief          Output GPIO Pin instance
+     */
+    gpio::gpio_t gpio;
+};
+
+#if defined(CONFIG_PWM)
+/**
+ * @brief           LED output channel driving a PWM channel
+ * @details         Active state outputs configured pulse width, Inactive state
+ *                      outputs zero pulse width
+ */
+class pwm_output_t
+{
+public:
+    /**
+     * @brief          Constructor
+     * @param[in]      spec PWM channel specification from Devicetree
+     * @param[in]      pulse_ns Active state pulse width in nanoseconds.
+     *                     Pass `0` to use the full PWM period
+     */
+    explicit pwm_output_t(const struct pwm_dt_spec &spec, uint32_t pulse_ns = 0)
+        : spec{spec}, pulse_ns{(pulse_ns == 0) ? spec.period : pulse_ns}
+    {
+    }
+
+    bool init()
+    {
+        if (!pwm_is_ready_dt(&this->spec)) {
+            return false;
+        }
+
+        return pwm_set_pulse_dt(&this->spec, 0) == 0;
+    }
+
+    void set()
+    {
+        pwm_set_pulse_dt(&this->spec, this->pulse_ns);
+    }
+
+    void reset()
+    {
+        pwm_set_pulse_dt(&this->spec, 0);
+    }
+
+private:
+    struct pwm_dt_spec spec;                /*!< PWM channel specification */
+    uint32_t pulse_ns;                      /*!< Active state pulse width in nanoseconds */
+};
+#endif /* defined(CONFIG_PWM) */
+
+/**
+ * @brief           Shift register output frame
+ * @details         Holds the bits shifted out to a chain of shift registers.
+ *                      The owner shifts the frame out when it is dirty,
+ *                      e.g. once after every LEDs update tick
+ * @tparam          BITS Number of outputs in shift register chain
+ */
+template <size_t BITS>
+class shift_register_frame_t
+{
+public:
+    static constexpr size_t BYTES_NUM = (BITS + 7U) / 8U;
+
+    void set_bit(size_t bit)
+    {
+        this->bytes[bit / 8U] |= static_cast<uint8_t>(1U << (bit % 8U));
+        this->is_dirty = true;
+    }
+
+    void reset_bit(size_t bit)
+    {
+        this->bytes[bit / 8U] &= static_cast<uint8_t>(~(1U << (bit % 8U)));
+        this->is_dirty = true;
+    }
+
+    /**
+     * @brief          Get frame bytes, bit `0` is the LSB of the first byte
+     */
+    const uint8_t *data() const
+    {
+        return this->bytes;
+    }
+
+    /**
+     * @brief          Check and clear frame modification flag
+     * @return         `true` if frame was modified since previous call
+     */
+    bool take_dirty()
+    {
+        bool was_dirty = this->is_dirty;
+        this->is_dirty = false;
+        return was_dirty;
+    }
+
+private:
+    uint8_t bytes[BYTES_NUM] = {};
+    bool is_dirty = true;
+};
+
+/**
+ * @brief           LED output channel driving a bit in a shift register frame
+ * @tparam          BITS Number of outputs in shift register chain
+ */
+template <size_t BITS>
+class shift_register_output_t
+{
+public:
+    /**
+     * @brief          Constructor
+     * @param[in]      frame Shift register frame the LED belongs to
+     * @param[in]      bit LED bit number in the frame
+     */
+    shift_register_output_t(shift_register_frame_t<BITS> &frame, size_t bit)
+        : frame{frame}, bit{bit}
+    {
+    }
+
+    bool init()
+    {
+        if (this->bit >= BITS) {
+            return false;
+        }
+
+        this->frame.reset_bit(this->bit);
+        return true;
+    }
+
+    void set()
+    {
+        this->frame.set_bit(this->bit);
+    }
+
+    void reset()
+    {
+        this->frame.reset_bit(this->bit);
+    }
+
+private:
+    shift_register_frame_t<BITS> &frame;    /*!< Shift register frame */
+    size_t bit;                             /*!< LED bit number in the frame */
+};
+
+/**
+ * @brief           LED output channel mock for host-side testing
+ * @details         Records the output state, number of transitions and the
+ *                      first \ref MAX_CALLS_NUM set and reset calls in order
+ */
+class mock_output_t
+{
+public:
+    /**
+     * @brief          Number of recorded calls
+     */
+    static constexpr size_t MAX_CALLS_NUM = 32U;
+
+    bool init()
+    {
+        this->is_initialized = true;
+        return true;
+    }
+
+    void set()
+    {
+        this->transitions_num += !this->is_set ? 1U : 0U;
+        this->is_set = true;
+        this->record(true);
+    }
+
+    void reset()
+    {
+        this->transitions_num += this->is_set ? 1U : 0U;
+        this->is_set = false;
+        this->record(false);
+    }
+
+    bool is_initialized = false;            /*!< `true` after \ref init call */
+    bool is_set = false;                    /*!< Current output state */
+    size_t transitions_num = 0;             /*!< Number of output state transitions */
+    std::array<bool, MAX_CALLS_NUM> calls{};/*!< Calls in order, `true` for set, `false` for reset */
+    size_t calls_num = 0;                   /*!< Number of set and reset calls */
+
+private:
+    void record(bool is_set_call)
+    {
+        if (this->calls_num < MAX_CALLS_NUM) {
+            this->calls[this->calls_num] = is_set_call;
+        }
+        ++this->calls_num;
+    }
+};
+
+} // driver
@@ -0,0 +1,172 @@
+/**
+ * @file           : led_pattern.hpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : LED pattern closed-form evaluator
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <limits>
+
+namespace drivers
+{
+
+/**
+ * @brief           LED pattern plain memory image
+ * @details         Has a trivial default constructor, so it may live in memory,
+ *                      which is not initialized at boot, see \ref led_pattern_t::to_record
+ */
+struct led_pattern_record_t
+{
+    int64_t  start_ms;                      /*!< Pattern start system uptime in milliseconds */
+    uint32_t on_ms;                         /*!< ON state period or solid state duration in milliseconds */
+    uint32_t off_ms;                        /*!< OFF state period in milliseconds */
+    uint32_t pend_ms;                       /*!< Blinking pending start timeout in milliseconds */
+    uint32_t blinks_num;                    /*!< Number of blinks or \ref led_pattern_t::BLINK_FOREVER */
+    uint32_t flags;                         /*!< Pattern flags, `led_pattern_t::RECORD_...` */
+    uint32_t reserved;                      /*!< Explicit padding, written as zero */
+};
+
+/**
+ * @brief           LED pattern class
+ * @details         Describes the LED state over time: solid state (ON/OFF) for
+ *                      a given duration or blinking with specified ON/OFF periods.
+ *                      The state is evaluated in closed form from the pattern
+ *                      start time, so the state at any time is known in O(1).
+ *                      A finite pattern ends at \ref end_ms, after that it is
+ *                      transparent and does not define the LED state
+ */
+class led_pattern_t
+{
+public:
+    /**
+     * @brief          The value, at which the LED blinks forever
+     */
+    static constexpr size_t BLINK_FOREVER = std::numeric_limits<uint32_t>::max();
+
+    /**
+     * @brief          The value, at which the solid state lasts forever
+     */
+    static constexpr uint32_t SOLID_FOREVER = std::numeric_limits<uint32_t>::max();
+
+    /**
+     * @brief          Time returned when an event never happens
+     */
+    static constexpr int64_t NO_TRANSITION = std::numeric_limits<int64_t>::max();
+
+    /**
+     * @brief          Create solid state pattern
+     * @param[in]      is_on `true` for ON state, `false` for OFF state
+     * @param[in]      start_ms Pattern start system uptime in milliseconds
+     * @param[in]      duration_ms Pattern duration in milliseconds or
+     *                     \ref SOLID_FOREVER for endless pattern
+     */
+    static led_pattern_t solid(bool is_on, int64_t start_ms, uint32_t duration_ms = SOLID_FOREVER);
+
+    /**
+     * @brief          Create blinking pattern
+     * @details        The pattern is OFF during pending start timeout and ends
+     *                     after OFF period of the last blink
+     * @param[in]      start_ms Pattern start system uptime in milliseconds
+     * @param[in]      on_ms LED's ON state period in milliseconds
+     * @param[in]      off_ms LED's OFF state period in milliseconds
+     * @param[in]      blinks_num Number of blinks or \ref BLINK_FOREVER
+     *                     in case of endless blinking
+     * @param[in]      pend_ms Blinking pending start timeout in milliseconds
+     */
+    static led_pattern_t blink(int64_t start_ms, uint32_t on_ms, uint32_t off_ms,
+                                   size_t blinks_num = BLINK_FOREVER, uint32_t pend_ms = 0);
+
+    /**
+     * @brief          Evaluate pattern state at given time
+     * @param[in]      time_ms System uptime in milliseconds
+     * @return         `true` if the LED is ON at given time, `false` otherwise
+     */
+    bool is_on_at(int64_t time_ms) const;
+
+    /**
+     * @brief          Check the pattern defines the LED state at given time
+     * @param[in]      time_ms System uptime in milliseconds
+     * @return         `false` if the pattern has ended, `true` otherwise
+     */
+    bool is_active_at(int64_t time_ms) const;
+
+    /**
+     * @brief          Get pattern end time
+     * @return         System uptime of the pattern end in milliseconds
+     *                     or \ref NO_TRANSITION for endless pattern
+     */
+    int64_t end_ms() const;
+
+    /**
+     * @brief          Get time of the next pattern state change
+     * @param[in]      now_ms System uptime in milliseconds
+     * @return         System uptime of the next ON/OFF transition or of the
+     *                     pattern end in milliseconds, or \ref NO_TRANSITION
+     *                     if the pattern never changes
+     */
+    int64_t next_transition_ms(int64_t now_ms) const;
+
+    /**
+     * @brief          Get the same pattern moved in time
+     * @param[in]      offset_ms Time shift in milliseconds, e.g. the uptime
+     *                     difference between two boots
+     * @return         Pattern, which state at `time_ms + offset_ms` equals
+     *                     the state of this pattern at `time_ms`
+     */
+    led_pattern_t shifted(int64_t offset_ms) const;
+
+    /**
+     * @brief          Solid state pattern record flag
+     */
+    static constexpr uint32_t RECORD_SOLID = 0x01U;
+
+    /**
+     * @brief          Solid state ON pattern record flag
+     */
+    static constexpr uint32_t RECORD_SOLID_ON = 0x02U;
+
+    /**
+     * @brief          Get plain memory image of the pattern
+     */
+    led_pattern_record_t to_record() const;
+
+    /**
+     * @brief          Create pattern from its plain memory image
+     * @param[in]      record Pattern image returned by \ref to_record
+     */
+    static led_pattern_t from_record(const led_pattern_record_t &record);
+
+private:
+    led_pattern_t() = default;
+
+    int64_t  start_ms;                      /*!< Pattern start system uptime in milliseconds */
+    uint32_t on_ms;                         /*!< ON state period or solid state duration in milliseconds */
+    uint32_t off_ms;                        /*!< OFF state period in milliseconds */
+    uint32_t pend_ms;                       /*!< Blinking pending start timeout in milliseconds */
+    size_t   blinks_num;                    /*!< Number of blinks or \ref BLINK_FOREVER */
+    bool     is_solid;                      /*!< Solid state pattern flag */
+    bool     is_solid_on;                   /*!< Solid state pattern LED state */
+};
+
+} // driver
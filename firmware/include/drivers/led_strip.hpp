@@ -0,0 +1,213 @@
+/**
+ * @file           : led_strip.hpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Addressable RGB LED strip driver
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <array>
+#include <vector>
+
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/spi.h>
+
+using device_t = struct device;
+
+namespace drivers
+{
+
+/**
+ * @brief           RGB color
+ */
+struct rgb_t
+{
+    uint8_t r;                              /*!< Red channel intensity */
+    uint8_t g;                              /*!< Green channel intensity */
+    uint8_t b;                              /*!< Blue channel intensity */
+};
+
+/**
+ * @brief           WS2812-class addressable RGB LED strip driver
+ * @details         Every WS2812 bit is sent as 4 SPI bits at 3 MHz: `1110` for
+ *                      `1` and `1000` for `0`. A lookup table expands a color
+ *                      byte into 4 SPI bytes in one load, so encoding does no
+ *                      per-bit work. Encoded frames are double-buffered: the next
+ *                      frame is encoded while SPI DMA still sends the previous
+ *                      one from a sender thread
+ */
+class led_strip_t
+{
+public:
+    static constexpr uint32_t SPI_FREQUENCY_HZ = 3000000U;
+    static constexpr size_t RESET_WORDS_NUM = 30U;      /*!< Trailing LOW words, 320 us latch at 3 MHz */
+
+    /**
+     * @brief          Constructor
+     * @param[in]      spi_dev Pointer to SPI controller device handle, MOSI drives strip DIN
+     * @param[in]      pixels_num Number of pixels in the strip
+     */
+    led_strip_t(const device_t *spi_dev, size_t pixels_num);
+
+    /**
+     * @brief          Initialize the strip and start frames sender thread
+     * @param[in]      stack_ptr Pointer to sender thread stack
+     * @param[in]      stack_size Sender thread stack size
+     * @param[in]      prio Sender thread priority
+     * @return         `true` on success, `false` if SPI controller is not ready
+     */
+    bool init(k_thread_stack_t *stack_ptr, size_t stack_size, int prio);
+
+    /**
+     * @brief          Get number of pixels in the strip
+     */
+    size_t get_pixels_num() const;
+
+    /**
+     * @brief          Set pixel color in the frame being composed
+     * @param[in]      idx Pixel index
+     * @param[in]      color Pixel color
+     */
+    void set_pixel(size_t idx, rgb_t color);
+
+    /**
+     * @brief          Get pixel color in the frame being composed
+     * @param[in]      idx Pixel index
+     */
+    rgb_t get_pixel(size_t idx) const;
+
+    /**
+     * @brief          Set color of the consecutive pixels segment
+     * @param[in]      first First pixel index
+     * @param[in]      count Number of pixels in the segment
+     * @param[in]      color Segment color
+     */
+    void fill(size_t first, size_t count, rgb_t color);
+
+    /**
+     * @brief          Encode the composed frame and queue it for sending
+     * @details        Does not wait for SPI transfer. If the previously queued
+     *                     frame has not been picked up yet, it is replaced
+     */
+    void show();
+
+    /**
+     * @brief          Show the composed frame if it changed since the last \ref show
+     * @return         `true` if the frame was queued for sending
+     */
+    bool refresh();
+
+    /**
+     * @brief          Get number of sent frames
+     */
+    uint32_t get_sent_frames_num() const;
+
+    /**
+     * @brief          Get number of queued frames replaced before sending
+     */
+    uint32_t get_dropped_frames_num() const;
+
+    /**
+     * @brief          Encode pixels into SPI words in G-R-B order
+     * @param[in]      pixels Pointer to pixels
+     * @param[in]      pixels_num Number of pixels
+     * @param[out]     out Pointer to output buffer of `3 * pixels_num` words
+     */
+    static void encode(const rgb_t *pixels, size_t pixels_num, uint32_t *out);
+
+private:
+    static constexpr int NO_BUFFER = -1;
+
+    /**
+     * @brief          Frames sender thread entry point
+     */
+    static void sender_thread(void *arg1, void *arg2, void *arg3);
+
+    const device_t *spi_dev;                /*!< SPI controller device handle */
+    struct spi_config spi_cfg;              /*!< SPI transfer configuration */
+
+    std::vector<rgb_t> pixels;              /*!< Frame being composed */
+    std::array<std::vector<uint32_t>, 2> tx_buffers;    /*!< Encoded frames */
+    bool is_dirty;                          /*!< Composed frame changed since the last show */
+
+    struct k_spinlock buffers_lock;         /*!< Protects buffer indexes below */
+    int sending_idx;                        /*!< Buffer owned by SPI DMA */
+    int ready_idx;                          /*!< Buffer queued for sending */
+
+    k_sem frame_sem;
+    k_thread thread;
+
+    uint32_t sent_frames_num;
+    uint32_t dropped_frames_num;
+};
+
+/**
+ * @brief           LED output channel driving a pixels segment of the strip
+ * @details         Active state paints the segment with configured color,
+ *                      Inactive state paints it black, so \ref led_t blinking
+ *                      and silent mode apply per pixel or per segment. The owner
+ *                      calls \ref led_strip_t::refresh after every LEDs update
+ */
+class led_strip_output_t
+{
+public:
+    /**
+     * @brief          Constructor
+     * @param[in]      strip LED strip the segment belongs to
+     * @param[in]      first First pixel index of the segment
+     * @param[in]      count Number of pixels in the segment
+     * @param[in]      color Active state color
+     */
+    led_strip_output_t(led_strip_t &strip, size_t first, size_t count, rgb_t color)
+        : strip{strip}, first{first}, count{count}, color{color}
+    {
+    }
+
+    bool init()
+    {
+        if ((this->count == 0) || ((this->first + this->count) > this->strip.get_pixels_num())) {
+            return false;
+        }
+
+        this->strip.fill(this->first, this->count, {0, 0, 0});
+        return true;
+    }
+
+    void set()
+    {
+        this->strip.fill(this->first, this->count, this->color);
+    }
+
+    void reset()
+    {
+        this->strip.fill(this->first, this->count, {0, 0, 0});
+    }
+
+private:
+    led_strip_t &strip;                     /*!< LED strip */
+    size_t first;                           /*!< First pixel index of the segment */
+    size_t count;                           /*!< Number of pixels in the segment */
+    rgb_t color;                            /*!< Active state color */
+};
+
+} // driver
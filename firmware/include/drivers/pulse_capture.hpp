@@ -0,0 +1,502 @@
+/**
+ * @file           : pulse_capture.hpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Timer input capture driver
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <concepts>
+#include <utility>
+#include <zephyr/kernel.h>
+
+#if defined(CONFIG_SOC_FAMILY_STM32) && defined(CONFIG_DMA)
+#include <soc.h>
+#include <zephyr/drivers/clock_control/stm32_clock_control.h>
+#endif
+
+namespace drivers
+{
+
+/**
+ * @brief           Pulse measurements over a batch of captured edges
+ * @details         Pulses and periods are counted when they end, so the ones
+ *                      started in the previous batch are counted in this one
+ */
+struct pulse_batch_t
+{
+    uint32_t tick_hz;                       /*!< Edge timestamps clock rate in Hz */
+    uint32_t edges_num;                     /*!< Number of edges in the batch */
+    uint32_t pulses_num;                    /*!< Number of HIGH pulses ended in the batch */
+    uint64_t width_sum_ticks;               /*!< Sum of HIGH pulse widths in ticks */
+    uint32_t periods_num;                   /*!< Number of rising to rising periods ended in the batch */
+    uint64_t period_sum_ticks;              /*!< Sum of periods in ticks */
+    uint32_t period_min_ticks;              /*!< Shortest period in ticks */
+    uint32_t period_max_ticks;              /*!< Longest period in ticks */
+
+    /**
+     * @brief          Get average HIGH pulse width
+     * @return         Pulse width in microseconds or `0` if no pulse ended
+     */
+    uint32_t get_width_us() const
+    {
+        if (this->pulses_num == 0) {
+            return 0;
+        }
+
+        return static_cast<uint32_t>((this->width_sum_ticks * USEC_PER_SEC) /
+                                         (static_cast<uint64_t>(this->pulses_num) * this->tick_hz));
+    }
+
+    /**
+     * @brief          Get average frequency
+     * @return         Frequency in millihertz or `0` if no period ended
+     */
+    uint32_t get_frequency_millihz() const
+    {
+        if (this->period_sum_ticks == 0) {
+            return 0;
+        }
+
+        return static_cast<uint32_t>((static_cast<uint64_t>(this->periods_num) * this->tick_hz * 1000U) /
+                                         this->period_sum_ticks);
+    }
+};
+
+/**
+ * @brief           Pulse measurements handler
+ * @details         Called from DMA interrupt context for every filled buffer
+ *                      half or from \ref pulse_capture_t::drain caller context
+ * @param[in]       arg Handler argument
+ * @param[in]       batch Pulse measurements over the drained edges
+ */
+using pulse_batch_handler_fn = void (*)(void *arg, const pulse_batch_t &batch);
+
+/**
+ * @brief           Capture buffer half filled notification
+ * @param[in]       arg Notification argument
+ * @param[in]       half_idx Filled buffer half, `0` or `1`
+ */
+using capture_half_handler_fn = void (*)(void *arg, size_t half_idx);
+
+/**
+ * @brief           Input capture backend requirements
+ * @details         Backend latches the counter value on every input edge into
+ *                      a circular buffer and notifies about every filled half of it
+ */
+template <typename T>
+concept capture_backend = requires(T backend, uint32_t *buffer, size_t edges_num,
+                                   capture_half_handler_fn half_handler, void *arg) {
+    { backend.init() } -> std::same_as<bool>;
+    { backend.start(buffer, edges_num, half_handler, arg) } -> std::same_as<bool>;
+    backend.stop();
+    { backend.get_write_index() } -> std::same_as<size_t>;
+    { backend.get_counter() } -> std::same_as<uint32_t>;
+    { backend.get_counter_mask() } -> std::same_as<uint32_t>;
+    { backend.get_tick_hz() } -> std::same_as<uint32_t>;
+    { backend.is_high() } -> std::same_as<bool>;
+};
+
+/**
+ * @brief           Pulse input class
+ * @details         Edge times are latched by the timer hardware and moved by DMA
+ *                      into a circular buffer, so they are exact regardless of
+ *                      interrupt load and take no interrupt per edge. Pulse widths
+ *                      and periods are computed in batches for every filled half
+ *                      of the buffer. Slow inputs, e.g. buttons, call \ref drain
+ *                      to get the edges before a half is filled
+ * @note            Edges must be drained before the buffer wraps and within a
+ *                      counter overflow period, otherwise they are lost or their
+ *                      times are wrong
+ * @tparam          Backend Input capture backend type, see \ref capture_backend
+ * @tparam          BLOCK_SIZE Number of edges in one buffer half
+ */
+template <capture_backend Backend, size_t BLOCK_SIZE>
+class pulse_capture_t
+{
+public:
+    /**
+     * @brief          Constructor
+     * @param[in]      args Arguments forwarded to backend constructor
+     */
+    template <typename... Args>
+    explicit pulse_capture_t(Args &&...args)
+        : backend(std::forward<Args>(args)...), handler{nullptr}, handler_arg{nullptr}
+    {
+        this->reset_state();
+    }
+
+    /**
+     * @brief          Initialize backend
+     * @return         `true` on success, `false` if
+     *                     - backend initialization failed
+     */
+    bool init()
+    {
+        return this->backend.init();
+    }
+
+    /**
+     * @brief          Start capturing edges
+     * @param[in]      handler Pulse measurements handler or `nullptr` if only
+     *                     the last edge times are used
+     * @param[in]      handler_arg Argument for pulse measurements handler
+     * @return         `true` on success, `false` if
+     *                     - backend failed to start
+     */
+    bool start(pulse_batch_handler_fn handler, void *handler_arg)
+    {
+        this->handler = handler;
+        this->handler_arg = handler_arg;
+        this->reset_state();
+
+        /* Edges toggle the level, so the captured ones are told apart by the level at start */
+        this->level = this->backend.is_high();
+        return this->backend.start(this->buffer, 2U * BLOCK_SIZE, pulse_capture_t::half_handler, this);
+    }
+
+    /**
+     * @brief          Stop capturing edges
+     */
+    void stop()
+    {
+        this->backend.stop();
+    }
+
+    /**
+     * @brief          Process edges captured since the previous call
+     * @details        Calls the handler if there are new edges. The tracked level
+     *                     is resynced to the input when no edge is captured
+     *                     while it is sampled, so a lost or filtered out edge
+     *                     doesn't swap pulses and gaps for good
+     */
+    void drain()
+    {
+        pulse_batch_t batch = {};
+        batch.tick_hz = this->backend.get_tick_hz();
+        batch.period_min_ticks = UINT32_MAX;
+
+        k_spinlock_key_t key = k_spin_lock(&this->lock);
+        size_t sample_idx = this->backend.get_write_index();
+        bool is_high = this->backend.is_high();
+        size_t write_idx = this->backend.get_write_index();
+
+        write_idx %= 2U * BLOCK_SIZE;
+        if (write_idx < this->read_idx) {
+            this->process(&this->buffer[this->read_idx], (2U * BLOCK_SIZE) - this->read_idx, batch);
+            this->read_idx = 0;
+        }
+        this->process(&this->buffer[this->read_idx], write_idx - this->read_idx, batch);
+        this->read_idx = write_idx;
+
+        if (((sample_idx % (2U * BLOCK_SIZE)) == write_idx) && (this->level != is_high)) {
+            /* Edges before the missed one were told apart by the wrong level */
+            this->level = is_high;
+            this->has_edge = false;
+            this->has_rising = false;
+            this->has_falling = false;
+        }
+        k_spin_unlock(&this->lock, key);
+
+        if ((batch.edges_num != 0) && (this->handler != nullptr)) {
+            this->handler(this->handler_arg, batch);
+        }
+    }
+
+    /**
+     * @brief          Get time of the last edge
+     * @param[in]      is_rising `true` for the last rising edge, `false` for the last falling one
+     * @return         System uptime of the edge in microseconds or `-1` if
+     *                     there was no such edge
+     */
+    int64_t get_last_edge_us(bool is_rising)
+    {
+        this->drain();
+
+        k_spinlock_key_t key = k_spin_lock(&this->lock);
+        bool has_edge = is_rising ? this->has_rising : this->has_falling;
+        uint32_t edge_tick = is_rising ? this->last_rising : this->last_falling;
+        int64_t now_us = static_cast<int64_t>(k_ticks_to_us_floor64(k_uptime_ticks()));
+        uint32_t age_ticks = (this->backend.get_counter() - edge_tick) & this->backend.get_counter_mask();
+        k_spin_unlock(&this->lock, key);
+
+        if (!has_edge) {
+            return -1;
+        }
+
+        return now_us - static_cast<int64_t>((static_cast<uint64_t>(age_ticks) * USEC_PER_SEC) /
+                                                 this->backend.get_tick_hz());
+    }
+
+    /**
+     * @brief          Last rising edge time source for \ref button_t::set_edge_time_source
+     * @param[in]      arg Pointer to \ref pulse_capture_t instance
+     */
+    static int64_t rising_edge_us_cb(void *arg)
+    {
+        return static_cast<pulse_capture_t *>(arg)->get_last_edge_us(true);
+    }
+
+    /**
+     * @brief          Last falling edge time source for \ref button_t::set_edge_time_source
+     * @param[in]      arg Pointer to \ref pulse_capture_t instance
+     */
+    static int64_t falling_edge_us_cb(void *arg)
+    {
+        return static_cast<pulse_capture_t *>(arg)->get_last_edge_us(false);
+    }
+
+    /**
+     * @brief          Get backend instance
+     */
+    Backend &get_backend()
+    {
+        return this->backend;
+    }
+
+private:
+    static void half_handler(void *arg, size_t half_idx)
+    {
+        ARG_UNUSED(half_idx);
+
+        /* The DMA write position is past the filled half, so draining covers it */
+        static_cast<pulse_capture_t *>(arg)->drain();
+    }
+
+    void reset_state()
+    {
+        this->read_idx = 0;
+        this->last_edge = 0;
+        this->last_rising = 0;
+        this->last_falling = 0;
+        this->has_edge = false;
+        this->has_rising = false;
+        this->has_falling = false;
+        this->level = false;
+    }
+
+    void process(const uint32_t *edges, size_t edges_num, pulse_batch_t &batch)
+    {
+        const uint32_t mask = this->backend.get_counter_mask();
+
+        for (size_t i = 0; i < edges_num; ++i) {
+            uint32_t edge = edges[i] & mask;
+
+            /* The level before the edge tells whether a HIGH pulse ends here */
+            if (this->has_edge && this->level) {
+                batch.width_sum_ticks += (edge - this->last_edge) & mask;
+                ++batch.pulses_num;
+            }
+
+            this->level = !this->level;
+            if (this->level) {
+                if (this->has_rising) {
+                    uint32_t period = (edge - this->last_rising) & mask;
+                    batch.period_sum_ticks += period;
+                    batch.period_min_ticks = MIN(batch.period_min_ticks, period);
+                    batch.period_max_ticks = MAX(batch.period_max_ticks, period);
+                    ++batch.periods_num;
+                }
+                this->last_rising = edge;
+                this->has_rising = true;
+            }
+            else {
+                this->last_falling = edge;
+                this->has_falling = true;
+            }
+
+            this->last_edge = edge;
+            this->has_edge = true;
+            ++batch.edges_num;
+        }
+    }
+
+    Backend backend;                        /*!< Input capture backend */
+    alignas(4) uint32_t buffer[2U * BLOCK_SIZE];    /*!< Circular capture buffer */
+
+    pulse_batch_handler_fn handler;         /*!< Pulse measurements handler */
+    void *handler_arg;                      /*!< Pulse measurements handler argument */
+
+    struct k_spinlock lock;                 /*!< Drain state lock, drained from ISR and threads */
+    size_t read_idx;                        /*!< Index of the first not processed edge */
+    uint32_t last_edge;                     /*!< Counter value of the last edge */
+    uint32_t last_rising;                   /*!< Counter value of the last rising edge */
+    uint32_t last_falling;                  /*!< Counter value of the last falling edge */
+    bool has_edge;                          /*!< An edge was captured flag */
+    bool has_rising;                        /*!< A rising edge was captured flag */
+    bool has_falling;                       /*!< A falling edge was captured flag */
+    bool level;                             /*!< Input level after the last edge */
+};
+
+/**
+ * @brief           Input capture backend mock for host-side testing
+ * @details         Edges are pushed by the test instead of the timer, the half
+ *                      notifications are raised as the buffer fills
+ */
+class mock_capture_backend_t
+{
+public:
+    bool init()
+    {
+        return true;
+    }
+
+    bool start(uint32_t *buffer, size_t edges_num, capture_half_handler_fn half_handler, void *arg)
+    {
+        this->buffer = buffer;
+        this->edges_num = edges_num;
+        this->half_handler = half_handler;
+        this->half_handler_arg = arg;
+        this->write_idx = 0;
+        return true;
+    }
+
+    void stop()
+    {
+        this->half_handler = nullptr;
+    }
+
+    size_t get_write_index()
+    {
+        return this->write_idx;
+    }
+
+    uint32_t get_counter()
+    {
+        return this->counter;
+    }
+
+    uint32_t get_counter_mask()
+    {
+        return this->counter_mask;
+    }
+
+    uint32_t get_tick_hz()
+    {
+        return this->tick_hz;
+    }
+
+    bool is_high()
+    {
+        return this->level;
+    }
+
+    /**
+     * @brief          Capture an edge at given counter value
+     */
+    void push_edge(uint32_t tick)
+    {
+        if (this->half_handler == nullptr) {
+            return;
+        }
+
+        this->counter = tick & this->counter_mask;
+        this->level = !this->level;
+        this->buffer[this->write_idx] = this->counter;
+        this->write_idx = (this->write_idx + 1U) % this->edges_num;
+
+        if (!this->is_notifying) {
+            return;
+        }
+
+        if (this->write_idx == (this->edges_num / 2U)) {
+            this->half_handler(this->half_handler_arg, 0);
+        }
+        else if (this->write_idx == 0) {
+            this->half_handler(this->half_handler_arg, 1);
+        }
+    }
+
+    uint32_t tick_hz = 1000000U;            /*!< Counter clock rate in Hz */
+    uint32_t counter_mask = UINT32_MAX;     /*!< Counter wrap mask, e.g. `0xFFFF` for 16-bit timers */
+    uint32_t counter = 0;                   /*!< Current counter value */
+    bool level = false;                     /*!< Current input level */
+    bool is_notifying = true;               /*!< Raise half notifications, `false` emulates a late DMA IRQ */
+
+private:
+    uint32_t *buffer = nullptr;
+    size_t edges_num = 0;
+    size_t write_idx = 0;
+    capture_half_handler_fn half_handler = nullptr;
+    void *half_handler_arg = nullptr;
+};
+
+#if defined(CONFIG_SOC_FAMILY_STM32) && defined(CONFIG_DMA)
+/**
+ * @brief           STM32 timer channel 1 input capture with circular DMA backend
+ * @details         Timer channel 1 captures the counter on both edges of its
+ *                      input, every capture requests one DMA transfer of the
+ *                      capture register into the circular buffer. E.g. the user
+ *                      button on PA0 is TIM2_CH1 (AF1), TIM2_CH1 is DMA1 Stream 5
+ *                      Channel 3. TIM2 and TIM5 have 32-bit counters, the others
+ *                      wrap at 16 bits
+ */
+class stm32_tim_capture_backend_t
+{
+public:
+    /**
+     * @brief          Backend hardware configuration
+     */
+    struct config_t
+    {
+        TIM_TypeDef *tim;                   /*!< Timer registers */
+        struct stm32_pclken tim_pclken;     /*!< Timer clock configuration */
+        uint32_t tick_hz;                   /*!< Counter clock rate in Hz, must divide the timer clock */
+        uint32_t ic_filter;                 /*!< Input filter, `LL_TIM_IC_FILTER_...` */
+        GPIO_TypeDef *gpio;                 /*!< Input GPIO Port registers */
+        uint32_t pin;                       /*!< Input GPIO Pin, `LL_GPIO_PIN_n` */
+        uint32_t alternate;                 /*!< Timer alternate function, `LL_GPIO_AF_n` */
+        const device_t *dma_dev;            /*!< DMA controller device handle */
+        uint32_t dma_stream;                /*!< DMA stream number */
+        uint32_t dma_slot;                  /*!< DMA stream channel selection */
+    };
+
+    /**
+     * @brief          Constructor
+     * @param[in]      config Backend hardware configuration
+     */
+    explicit stm32_tim_capture_backend_t(const config_t &config);
+
+    bool init();
+    bool start(uint32_t *buffer, size_t edges_num, capture_half_handler_fn half_handler, void *arg);
+    void stop();
+    size_t get_write_index();
+    uint32_t get_counter();
+    uint32_t get_counter_mask();
+    uint32_t get_tick_hz();
+    bool is_high();
+
+private:
+    /**
+     * @brief          DMA half and full transfer callback
+     */
+    static void dma_callback(const device_t *dev, void *user_data, uint32_t channel, int status);
+
+    config_t config;
+    size_t edges_num;
+    capture_half_handler_fn half_handler;
+    void *half_handler_arg;
+};
+#endif /* defined(CONFIG_SOC_FAMILY_STM32) && defined(CONFIG_DMA) */
+
+} // driver
@@ -0,0 +1,62 @@
+/**
+ * @file           : stm32_timer.hpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : STM32 general purpose timer helpers
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/clock_control.h>
+#include <zephyr/drivers/clock_control/stm32_clock_control.h>
+
+namespace drivers
+{
+
+/**
+ * @brief           Enable STM32 timer clock and get its kernel clock rate
+ * @details         Timer kernel clock is doubled when its APB prescaler is not 1
+ * @param[in]       pclken Timer clock configuration from Devicetree
+ * @param[out]      rate_hz Timer kernel clock rate in Hz
+ * @return          `true` on success, `false` if clock control failed
+ */
+inline bool stm32_timer_clock_on(const struct stm32_pclken &pclken, uint32_t &rate_hz)
+{
+    const struct device *clk_dev = DEVICE_DT_GET(STM32_CLOCK_CONTROL_NODE);
+    if (!device_is_ready(clk_dev)) {
+        return false;
+    }
+
+    auto *subsys = reinterpret_cast<clock_control_subsys_t>(const_cast<struct stm32_pclken *>(&pclken));
+    uint32_t bus_rate = 0;
+    if ((clock_control_on(clk_dev, subsys) != 0) || (clock_control_get_rate(clk_dev, subsys, &bus_rate) != 0)) {
+        return false;
+    }
+
+    const uint32_t apb_prescaler = (pclken.bus == STM32_CLOCK_BUS_APB1) ? STM32_APB1_PRESCALER
+                                                                       : STM32_APB2_PRESCALER;
+    rate_hz = (apb_prescaler == 1U) ? bus_rate : (2U * bus_rate);
+
+    return true;
+}
+
+} // driver
@@ -0,0 +1,345 @@
+/**
+ * @file           : waveform.hpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Timer-triggered DMA GPIO waveform engine
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <concepts>
+#include <utility>
+
+#include "drivers/gpio.hpp"
+
+#if defined(CONFIG_SOC_FAMILY_STM32) && defined(CONFIG_DMA)
+#include <soc.h>
+#include <zephyr/drivers/clock_control/stm32_clock_control.h>
+#endif
+
+namespace drivers
+{
+
+namespace waveform
+{
+
+/**
+ * @brief           Possible waveform playback modes
+ */
+enum class play_mode_t
+{
+    OneShot,                                /*!< Play the buffer once */
+    Circular                                /*!< Repeat the buffer until stopped */
+};
+
+/**
+ * @brief           Waveform buffer encoder
+ * @details         Builds a buffer of GPIO Port BSRR words, one word per timer tick.
+ *                      Low half-word sets Pins, high half-word resets Pins and
+ *                      zero word keeps the Port unchanged. Does not depend on
+ *                      hardware, so buffers can be generated and checked off-target
+ */
+class encoder_t
+{
+public:
+    /**
+     * @brief          Constructor
+     * @param[in]      buffer Pointer to BSRR words buffer
+     * @param[in]      samples_num Buffer length in timer ticks
+     */
+    encoder_t(uint32_t *buffer, size_t samples_num);
+
+    /**
+     * @brief          Clear the buffer, no Pin changes at any tick
+     */
+    void clear();
+
+    /**
+     * @brief          Change Pin level at given tick
+     * @details        Later edge on the same Pin and tick overrides the earlier one
+     * @param[in]      tick Tick number in the buffer
+     * @param[in]      pin GPIO Pin number, `0..15`
+     * @param[in]      level `true` for HIGH level, `false` for LOW level
+     * @return         `true` on success, `false` if tick or Pin is out of range
+     */
+    bool add_edge(size_t tick, uint8_t pin, bool level);
+
+    /**
+     * @brief          Add a train of HIGH pulses on the Pin
+     * @param[in]      pin GPIO Pin number, `0..15`
+     * @param[in]      start_tick First pulse rising edge tick
+     * @param[in]      width_ticks Pulse width in ticks
+     * @param[in]      period_ticks Pulse period in ticks
+     * @param[in]      pulses_num Number of pulses
+     * @return         `true` on success, `false` if
+     *                     - pulse width is zero or not less than period
+     *                     - pulse train does not fit into the buffer
+     */
+    bool add_pulses(uint8_t pin, size_t start_tick, size_t width_ticks, size_t period_ticks, size_t pulses_num);
+
+    /**
+     * @brief          Get BSRR words buffer
+     */
+    const uint32_t *data() const;
+
+    /**
+     * @brief          Get buffer length in timer ticks
+     */
+    size_t size() const;
+
+    /**
+     * @brief          Apply buffer words to Port output state, as GPIO hardware does
+     * @param[in]      odr Port output state before the first tick
+     * @param[in]      ticks_num Number of ticks to apply, wraps around the buffer
+     * @return         Port output state after given number of ticks
+     */
+    uint16_t apply(uint16_t odr, size_t ticks_num) const;
+
+private:
+    uint32_t *buffer;                       /*!< BSRR words buffer */
+    size_t samples_num;                     /*!< Buffer length in timer ticks */
+};
+
+/**
+ * @brief           Waveform DMA backend requirements
+ * @details         Backend streams BSRR words to GPIO Port, one word per tick
+ */
+template <typename T>
+concept dma_backend = requires(T backend, const uint32_t *buffer, size_t samples_num, play_mode_t mode) {
+    { backend.init() } -> std::same_as<bool>;
+    { backend.start(buffer, samples_num, mode) } -> std::same_as<bool>;
+    backend.stop();
+    { backend.is_busy() } -> std::same_as<bool>;
+};
+
+/**
+ * @brief           Waveform engine class
+ * @details         Plays encoded waveforms on several Pins of one GPIO Port
+ *                      with no CPU involvement after start
+ * @tparam          Backend DMA backend type, see \ref dma_backend
+ */
+template <dma_backend Backend>
+class engine_t
+{
+public:
+    /**
+     * @brief          Constructor
+     * @param[in]      port_ptr Pointer to GPIO Port device handle
+     * @param[in]      pins Mask of Port Pins driven by the engine
+     * @param[in]      args Arguments forwarded to backend constructor
+     */
+    template <typename... Args>
+    engine_t(const device_t *port_ptr, gpio_port_pins_t pins, Args &&...args)
+        : port_ptr{port_ptr}, pins{pins}, backend(std::forward<Args>(args)...)
+    {
+    }
+
+    /**
+     * @brief          Configure driven Pins as LOW Outputs and initialize backend
+     * @return         `true` on success, `false` if
+     *                     - GPIO Port is not ready
+     *                     - GPIO Pin configuration failed
+     *                     - backend initialization failed
+     */
+    bool init()
+    {
+        if (!device_is_ready(this->port_ptr)) {
+            return false;
+        }
+
+        for (uint8_t pin = 0; pin < 16U; ++pin) {
+            if (((this->pins & BIT(pin)) != 0) && (gpio_pin_configure(this->port_ptr, pin, GPIO_OUTPUT_LOW) < 0)) {
+                return false;
+            }
+        }
+
+        return this->backend.init();
+    }
+
+    /**
+     * @brief          Start waveform playback
+     * @param[in]      wave Encoded waveform, must stay valid until playback ends
+     * @param[in]      mode Playback mode
+     * @return         `true` on success, `false` if
+     *                     - playback is in progress
+     *                     - waveform drives Pins not owned by the engine
+     *                     - backend failed to start
+     */
+    bool play(const encoder_t &wave, play_mode_t mode)
+    {
+        if (this->backend.is_busy()) {
+            return false;
+        }
+
+        const uint32_t owned_mask = this->pins | (this->pins << 16U);
+        for (size_t i = 0; i < wave.size(); ++i) {
+            if ((wave.data()[i] & ~owned_mask) != 0) {
+                return false;
+            }
+        }
+
+        return this->backend.start(wave.data(), wave.size(), mode);
+    }
+
+    /**
+     * @brief          Stop waveform playback, Pins keep their current levels
+     */
+    void stop()
+    {
+        this->backend.stop();
+    }
+
+    /**
+     * @brief          Check waveform playback is in progress
+     */
+    bool is_playing()
+    {
+        return this->backend.is_busy();
+    }
+
+    /**
+     * @brief          Get backend instance
+     */
+    Backend &get_backend()
+    {
+        return this->backend;
+    }
+
+private:
+    const device_t *port_ptr;               /*!< GPIO Port device handle */
+    gpio_port_pins_t pins;                  /*!< Mask of Pins driven by the engine */
+    Backend backend;                        /*!< DMA backend instance */
+};
+
+/**
+ * @brief           DMA backend mock for host-side testing
+ * @details         Records started buffer instead of streaming it. Playback
+ *                      result is checked with \ref encoder_t::apply, the end
+ *                      of the buffer is signalled by \ref transfer_complete
+ */
+class mock_dma_backend_t
+{
+public:
+    bool init()
+    {
+        this->is_initialized = true;
+        return true;
+    }
+
+    bool start(const uint32_t *buffer, size_t samples_num, play_mode_t mode)
+    {
+        this->buffer = buffer;
+        this->samples_num = samples_num;
+        this->mode = mode;
+        this->is_running = true;
+        ++this->starts_num;
+        return true;
+    }
+
+    /**
+     * @brief          Emulate DMA transfer complete callback
+     * @details        Circular playback wraps and goes on, one-shot playback
+     *                     and failed transfers end the playback
+     * @param[in]      status DMA transfer status, negative on error
+     */
+    void transfer_complete(int status = 0)
+    {
+        if (!this->is_running) {
+            return;
+        }
+
+        ++this->completions_num;
+        if ((this->mode != play_mode_t::Circular) || (status < 0)) {
+            this->is_running = false;
+        }
+    }
+
+    void stop()
+    {
+        this->is_running = false;
+    }
+
+    bool is_busy()
+    {
+        return this->is_running;
+    }
+
+    bool is_initialized = false;            /*!< `true` after \ref init call */
+    bool is_running = false;                /*!< Playback is in progress */
+    const uint32_t *buffer = nullptr;       /*!< Last started buffer */
+    size_t samples_num = 0;                 /*!< Last started buffer length */
+    play_mode_t mode = play_mode_t::OneShot;/*!< Last started playback mode */
+    size_t starts_num = 0;                  /*!< Number of playback starts */
+    size_t completions_num = 0;             /*!< Number of completed buffer transfers */
+};
+
+#if defined(CONFIG_SOC_FAMILY_STM32) && defined(CONFIG_DMA)
+/**
+ * @brief           STM32 timer update event triggered DMA backend
+ * @details         Every timer update event requests one DMA transfer of a
+ *                      BSRR word from memory to the GPIO Port. Only DMA2 can
+ *                      access GPIO Ports on AHB1, so the timer must be TIM1 or
+ *                      TIM8, e.g. TIM1_UP is DMA2 Stream 5 Channel 6
+ */
+class stm32_tim_dma_backend_t
+{
+public:
+    /**
+     * @brief          Backend hardware configuration
+     */
+    struct config_t
+    {
+        const device_t *dma_dev;            /*!< DMA controller device handle */
+        uint32_t dma_stream;                /*!< DMA stream number */
+        uint32_t dma_slot;                  /*!< DMA stream channel selection */
+        TIM_TypeDef *tim;                   /*!< Timer registers */
+        struct stm32_pclken tim_pclken;     /*!< Timer clock configuration */
+        GPIO_TypeDef *gpio;                 /*!< GPIO Port registers */
+        uint32_t tick_ns;                   /*!< Waveform tick period in nanoseconds */
+    };
+
+    /**
+     * @brief          Constructor
+     * @param[in]      config Backend hardware configuration
+     */
+    explicit stm32_tim_dma_backend_t(const config_t &config);
+
+    bool init();
+    bool start(const uint32_t *buffer, size_t samples_num, play_mode_t mode);
+    void stop();
+    bool is_busy();
+
+private:
+    /**
+     * @brief          DMA transfer complete callback
+     */
+    static void dma_callback(const device_t *dev, void *user_data, uint32_t channel, int status);
+
+    config_t config;
+    volatile bool is_running;
+    bool is_circular;
+};
+#endif /* defined(CONFIG_SOC_FAMILY_STM32) && defined(CONFIG_DMA) */
+
+} // waveform
+
+} // driver
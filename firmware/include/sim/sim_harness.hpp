@@ -0,0 +1,116 @@
+/**
+ * @file           : sim_harness.hpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : native_sim waveform recorder and input stimulus
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio.h>
+
+namespace sim
+{
+
+/**
+ * @brief           native_sim test harness
+ * @details         Samples LED and button pins of the emulated GPIO controllers
+ *                      and prints every level change as a VCD waveform line
+ *                      prefixed with "vcd: ". Drives the user button input
+ *                      from `CONFIG_APP_SIM_STIMULUS` script in virtual time
+ */
+class sim_harness_t final
+{
+public:
+    static sim_harness_t &get_instance();
+
+    /**
+     * @brief          Print waveform header and start recording and stimulus
+     * @return         `true` on success, `false` if
+     *                     - emulated GPIO Port is not ready
+     *                     - stimulus script is malformed
+     */
+    bool init();
+
+private:
+    sim_harness_t();
+
+    sim_harness_t(const sim_harness_t &) = delete;
+    sim_harness_t(sim_harness_t &&) = delete;
+    sim_harness_t &operator=(const sim_harness_t &) = delete;
+    sim_harness_t &&operator=(sim_harness_t &&) = delete;
+
+    /**
+     * @brief          Parse `CONFIG_APP_SIM_STIMULUS` script
+     * @return         `true` on success, `false` if script is malformed
+     */
+    bool parse_stimulus();
+
+    /**
+     * @brief          Start stimulus timer for the next stimulus step
+     */
+    void schedule_stimulus();
+
+    static void sample_timer_expiry(k_timer *timer);
+    static void stimulus_timer_expiry(k_timer *timer);
+
+    /**
+     * @brief          Maximum number of recorded pins
+     */
+    static constexpr size_t MAX_PROBES_NUM = 8U;
+
+    /**
+     * @brief          Maximum number of stimulus steps
+     */
+    static constexpr size_t MAX_STEPS_NUM = 32U;
+
+    /**
+     * @brief          Recorded pin
+     */
+    struct probe_t
+    {
+        struct gpio_dt_spec spec;           /*!< Pin specification */
+        const char *name;                   /*!< Waveform signal name */
+        int level;                          /*!< Last recorded level or `-1` */
+    } probes[MAX_PROBES_NUM];
+    size_t probes_num;
+
+    /**
+     * @brief          Stimulus step
+     */
+    struct step_t
+    {
+        uint32_t time_ms;                   /*!< Step time from sequence start */
+        int level;                          /*!< Button physical level */
+    } steps[MAX_STEPS_NUM];
+    size_t steps_num;
+    size_t step_idx;
+    uint32_t repeat_period_ms;              /*!< Sequence repeat period or `0` */
+    int64_t sequence_start_ms;              /*!< Current sequence start uptime */
+
+    struct gpio_dt_spec button_spec;
+    k_timer sample_timer;
+    k_timer stimulus_timer;
+};
+
+} // sim
@@ -0,0 +1,98 @@
+# ZephyrRTOS/C++ based STM32 Firmware
+# SPDX-License-Identifier: Apache-2.0
+
+"""native_sim scenarios checked against the VCD waveform printed by the simulation harness.
+
+Run with twister:
+    west twister -T firmware -p native_sim
+"""
+
+import logging
+
+from twister_harness import DeviceAdapter
+
+logger = logging.getLogger(__name__)
+
+VCD_PREFIX = "vcd: "
+
+# Keep in sync with leds_controller_t::init_indication()
+INDICATION_SLOT_MS = 110
+INDICATION_ON_MS = 2 * INDICATION_SLOT_MS
+INDICATION_PERIOD_MS = 5 * INDICATION_SLOT_MS
+INDICATION_START_SLOTS = {
+    "orange_led": 0,
+    "red_led": 1,
+    "blue_led": 2,
+    "green_led": 3,
+}
+INDICATION_PERIODS_NUM = 4
+
+# Levels are sampled every CONFIG_APP_SIM_SAMPLE_PERIOD_MS
+EDGE_TOLERANCE_MS = 2
+READ_TIMEOUT_S = 10
+
+
+def read_edges(dut: DeviceAdapter, until):
+    """Read the waveform until `until(edges, time_ms)` is true.
+
+    Returns level changes of every signal as lists of (time_ms, level), the
+    first sampled level counts as a change from 0.
+    """
+    names = {}
+    edges = {}
+    levels = {}
+    time_ms = None
+
+    while True:
+        line = dut.readline(timeout=READ_TIMEOUT_S)
+        pos = line.find(VCD_PREFIX)
+        if pos < 0:
+            continue
+        fields = line[pos + len(VCD_PREFIX):].split()
+        if not fields:
+            continue
+
+        if fields[0] == "$var":
+            names[fields[3]] = fields[4]
+            edges[fields[4]] = []
+            levels[fields[4]] = 0
+        elif fields[0].startswith("#"):
+            time_ms = int(fields[0][1:])
+            if until(edges, time_ms):
+                return edges
+        elif fields[0][0] in "01" and time_ms is not None:
+            name = names[fields[0][1:]]
+            level = int(fields[0][0])
+            if level != levels[name]:
+                edges[name].append((time_ms, level))
+                levels[name] = level
+
+
+def test_init_indication(dut: DeviceAdapter):
+    """LEDs run the init indication light in phase after boot."""
+
+    def is_recorded(edges, time_ms):
+        orange = edges.get("orange_led")
+        return bool(orange) and (time_ms >= orange[0][0] + INDICATION_PERIODS_NUM * INDICATION_PERIOD_MS)
+
+    edges = read_edges(dut, is_recorded)
+
+    start_ms = edges["orange_led"][0][0]
+    end_ms = start_ms + INDICATION_PERIODS_NUM * INDICATION_PERIOD_MS
+    logger.info("init indication starts at %d ms", start_ms)
+
+    for name, slot in INDICATION_START_SLOTS.items():
+        expected = []
+        for period in range(INDICATION_PERIODS_NUM):
+            on_ms = start_ms + slot * INDICATION_SLOT_MS + period * INDICATION_PERIOD_MS
+            expected += [(on_ms, 1), (on_ms + INDICATION_ON_MS, 0)]
+        expected = [edge for edge in expected if edge[0] < end_ms]
+        actual = [edge for edge in edges[name] if edge[0] < end_ms - EDGE_TOLERANCE_MS]
+
+        assert len(actual) == len(expected), f"{name}: edges {actual}, expected {expected}"
+        for (actual_ms, actual_level), (expected_ms, expected_level) in zip(actual, expected):
+            assert actual_level == expected_level, f"{name}: edges {actual}, expected {expected}"
+            assert abs(actual_ms - expected_ms) <= EDGE_TOLERANCE_MS, \
+                f"{name}: edge at {actual_ms} ms, expected at {expected_ms} ms"
+
+    assert not edges["user_button"], "user button changed without stimulus"
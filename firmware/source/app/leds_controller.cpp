@@ -24,10 +24,24 @@
 
 #include "app/leds_controller.hpp"
 
+#include <algorithm>
 #include <zephyr/kernel.h>
 #include <zephyr/kernel/thread_stack.h>
 #include <zephyr/drivers/gpio.h>
 
+#include "core/hot_path.hpp"
+#include "core/latency_probe.hpp"
+
+#if defined(CONFIG_APP_WARM_RESTORE)
+#include <type_traits>
+#include "core/warm_boot.hpp"
+#include "drivers/led_checkpoint.hpp"
+#endif
+
+#if defined(CONFIG_APP_EVENT_LOG)
+#include "core/event_log.hpp"
+#endif
+
 using namespace drivers;
 using namespace drivers::gpio;
 
@@ -36,10 +50,37 @@ namespace
 
 K_THREAD_STACK_DEFINE(thread_stack, 1024);
 
+/* Indication modes recorded in the event log */
+enum : int32_t
+{
+    SHUTDOWN_INDICATION = 0,
+    INIT_INDICATION = 1,
+    RESUME_INDICATION = 2
+};
+
+#if defined(CONFIG_APP_EVENT_LOG)
+#define LOG_EVENT(id, ...) core::event_log_t::get_instance().append(core::event_id_t::id, {__VA_ARGS__})
+#else
+#define LOG_EVENT(id, ...)
+#endif
+
+#if defined(CONFIG_APP_WARM_RESTORE)
+/* A type with non-trivial default constructor would be zeroed by the static initialization at boot */
+static_assert(std::is_trivially_default_constructible_v<led_checkpoint_t<LEDS_NUM>>,
+              "Checkpoint must not be touched by static initialization");
+
+__noinit led_checkpoint_t<LEDS_NUM> checkpoint;
+#endif
+
 }
 
 leds_controller_t::leds_controller_t()
+    : is_restored{false}
 {
+    k_mutex_init(&this->lock);
+    k_sem_init(&this->update_sem, 0, 1);
+    this->currents_ua.fill(CONFIG_APP_LED_CURRENT_UA);
+
     struct gpio_dt_spec orange_led_dt = GPIO_DT_SPEC_GET(DT_ALIAS(led0), gpios);
     struct gpio_dt_spec green_led_dt = GPIO_DT_SPEC_GET(DT_ALIAS(led1), gpios);
     struct gpio_dt_spec red_led_dt = GPIO_DT_SPEC_GET(DT_ALIAS(led2), gpios);
@@ -50,8 +91,15 @@ leds_controller_t::leds_controller_t()
     this->leds.emplace_back(red_led_dt.port, red_led_dt.pin); // RED_LED
     this->leds.emplace_back(blue_led_dt.port, blue_led_dt.pin); // BLUE_LED
 
+    /* Restored patterns are applied right after Pins configuration, so warm
+     * boot shows the status before anything else is initialized */
+    this->is_restored = this->restore_checkpoint();
+    int64_t now_ms = k_uptime_get();
     for (auto &led : this->leds) {
         led.init();
+        if (this->is_restored) {
+            led.update(now_ms);
+        }
     }
 }
 
@@ -64,40 +112,169 @@ leds_controller_t &leds_controller_t::get_instance()
 bool leds_controller_t::init()
 {
     this->thread_handle = this->create_thread();
-    this->init_indication();
+    if (!this->is_restored) {
+        this->init_indication();
+    }
     return true;
 }
 
 void leds_controller_t::init_indication()
 {
-    this->leds[ORANGE_LED].blink(2 * 110U, 3 * 110U, led_t::BLINK_FOREVER, 0);
-    this->leds[RED_LED].blink(2 * 110U, 3 * 110U, led_t::BLINK_FOREVER, 1 * 110U);
-    this->leds[BLUE_LED].blink(2 * 110U, 3 * 110U, led_t::BLINK_FOREVER, 2 * 110U);
-    this->leds[GREEN_LED].blink(2 * 110U, 3 * 110U, led_t::BLINK_FOREVER, 3 * 110U);
+    static constexpr uint32_t ON_MS = 2 * 110U;
+    static constexpr uint32_t OFF_MS = 3 * 110U;
+
+    k_mutex_lock(&this->lock, K_FOREVER);
+    int64_t now_ms = k_uptime_get();
+    this->leds[ORANGE_LED].set_layer(led_layer_t::Base, led_pattern_t::blink(now_ms, ON_MS, OFF_MS,
+                                                                                 led_pattern_t::BLINK_FOREVER, 0));
+    this->leds[RED_LED].set_layer(led_layer_t::Base, led_pattern_t::blink(now_ms, ON_MS, OFF_MS,
+                                                                              led_pattern_t::BLINK_FOREVER, 1 * 110U));
+    this->leds[BLUE_LED].set_layer(led_layer_t::Base, led_pattern_t::blink(now_ms, ON_MS, OFF_MS,
+                                                                               led_pattern_t::BLINK_FOREVER, 2 * 110U));
+    this->leds[GREEN_LED].set_layer(led_layer_t::Base, led_pattern_t::blink(now_ms, ON_MS, OFF_MS,
+                                                                                led_pattern_t::BLINK_FOREVER, 3 * 110U));
+    this->save_checkpoint(now_ms);
+    k_mutex_unlock(&this->lock);
+
+    LOG_EVENT(LedsMode, INIT_INDICATION);
+    this->request_update();
 }
 
 void leds_controller_t::shutdown_indication()
 {
-    this->leds[ORANGE_LED].turn_off();
-    this->leds[RED_LED].turn_off();
-    this->leds[BLUE_LED].turn_off();
-    this->leds[GREEN_LED].turn_off();
+    k_mutex_lock(&this->lock, K_FOREVER);
+    int64_t now_ms = k_uptime_get();
+    for (auto &led : this->leds) {
+        led.set_layer(led_layer_t::Overlay, led_pattern_t::solid(false, now_ms));
+    }
+    this->save_checkpoint(now_ms);
+    k_mutex_unlock(&this->lock);
+
+    LOG_EVENT(LedsMode, SHUTDOWN_INDICATION);
+    this->request_update();
+}
+
+void leds_controller_t::resume_indication()
+{
+    k_mutex_lock(&this->lock, K_FOREVER);
+    for (auto &led : this->leds) {
+        led.clear_layer(led_layer_t::Overlay);
+    }
+    this->save_checkpoint(k_uptime_get());
+    k_mutex_unlock(&this->lock);
+
+    LOG_EVENT(LedsMode, RESUME_INDICATION);
+    this->request_update();
 }
 
 void leds_controller_t::enable_silent_mode()
 {
-    this->leds[ORANGE_LED].set_silent_blink();
-    this->leds[RED_LED].set_silent_blink();
-    this->leds[BLUE_LED].set_silent_blink();
-    this->leds[GREEN_LED].set_silent_blink();
+    k_mutex_lock(&this->lock, K_FOREVER);
+    int64_t now_ms = k_uptime_get();
+    for (auto &led : this->leds) {
+        led.set_layer(led_layer_t::Mute, led_pattern_t::solid(false, now_ms));
+    }
+    this->save_checkpoint(now_ms);
+    k_mutex_unlock(&this->lock);
+
+    LATENCY_PROBE_STAMP(CommandApplied);
+    LOG_EVENT(SilentMode, 1);
+    this->request_update();
 }
 
 void leds_controller_t::disable_silent_mode()
 {
-    this->leds[ORANGE_LED].reset_silent_blink();
-    this->leds[RED_LED].reset_silent_blink();
-    this->leds[BLUE_LED].reset_silent_blink();
-    this->leds[GREEN_LED].reset_silent_blink();
+    k_mutex_lock(&this->lock, K_FOREVER);
+    for (auto &led : this->leds) {
+        led.clear_layer(led_layer_t::Mute);
+    }
+    this->save_checkpoint(k_uptime_get());
+    k_mutex_unlock(&this->lock);
+
+    LATENCY_PROBE_STAMP(CommandApplied);
+    LOG_EVENT(SilentMode, 0);
+    this->request_update();
+}
+
+bool leds_controller_t::set_led_current(size_t led, uint32_t current_ua)
+{
+    if (led >= LEDS_NUM) {
+        return false;
+    }
+
+    k_mutex_lock(&this->lock, K_FOREVER);
+    this->currents_ua[led] = current_ua;
+    this->save_checkpoint(k_uptime_get());
+    k_mutex_unlock(&this->lock);
+
+    return true;
+}
+
+bool leds_controller_t::get_led_usage(size_t led, led_usage_t &usage)
+{
+    if (led >= LEDS_NUM) {
+        return false;
+    }
+
+    k_mutex_lock(&this->lock, K_FOREVER);
+    led_stats_t stats = this->leds[led].get_stats(k_uptime_get());
+    uint32_t current_ua = this->currents_ua[led];
+    k_mutex_unlock(&this->lock);
+
+    usage.on_ms = stats.on_ms;
+    usage.muted_ms = stats.muted_ms;
+    usage.transitions = stats.transitions;
+    usage.charge_uc = (stats.on_ms * current_ua) / MSEC_PER_SEC;
+
+    return true;
+}
+
+void leds_controller_t::reset_usage()
+{
+    k_mutex_lock(&this->lock, K_FOREVER);
+    int64_t now_ms = k_uptime_get();
+    for (auto &led : this->leds) {
+        led.reset_stats(now_ms);
+    }
+    k_mutex_unlock(&this->lock);
+}
+
+void leds_controller_t::request_update()
+{
+    k_sem_give(&this->update_sem);
+}
+
+void leds_controller_t::save_checkpoint(int64_t now_ms)
+{
+#if defined(CONFIG_APP_WARM_RESTORE)
+    for (size_t i = 0; i < LEDS_NUM; ++i) {
+        checkpoint.save_led(i, this->leds[i].get_layers(), this->currents_ua[i]);
+    }
+    checkpoint.seal(now_ms);
+#else
+    ARG_UNUSED(now_ms);
+#endif
+}
+
+bool leds_controller_t::restore_checkpoint()
+{
+#if defined(CONFIG_APP_WARM_RESTORE)
+    if (!core::is_warm_boot() || !checkpoint.is_valid()) {
+        checkpoint.invalidate();
+        return false;
+    }
+
+    /* Uptime restarts from zero, move the patterns to the new time base */
+    int64_t offset_ms = k_uptime_get() - checkpoint.get_alive_ms();
+    for (size_t i = 0; i < LEDS_NUM; ++i) {
+        led_layers_t layers;
+        checkpoint.load_led(i, layers, this->currents_ua[i]);
+        this->leds[i].restore_layers(layers, offset_ms);
+    }
+    return true;
+#else
+    return false;
+#endif
 }
 
 k_tid_t leds_controller_t::create_thread()
@@ -115,11 +292,12 @@ k_tid_t leds_controller_t::create_thread()
                           leds_controller_t::leds_update_thread,
                           this, nullptr, nullptr,
                           4, 0, K_NO_WAIT);
+    k_thread_name_set(tid, "leds");
 
     return tid;
 }
 
-void leds_controller_t::leds_update_thread(void *arg1, void *arg2, void *arg3)
+FW_HOT void leds_controller_t::leds_update_thread(void *arg1, void *arg2, void *arg3)
 {
     ARG_UNUSED(arg2);
     ARG_UNUSED(arg3);
@@ -127,9 +305,22 @@ void leds_controller_t::leds_update_thread(void *arg1, void *arg2, void *arg3)
     leds_controller_t *instance_ptr = reinterpret_cast<leds_controller_t *>(arg1);
 
     for (;;) {
+        int64_t next_ms = gpio_led_t::NO_TRANSITION;
+
+        k_mutex_lock(&instance_ptr->lock, K_FOREVER);
+        int64_t now_ms = k_uptime_get();
         for (auto &led : instance_ptr->leds) {
-            led.update_ms();
+            led.update(now_ms);
+            next_ms = std::min(next_ms, led.next_transition_ms(now_ms));
         }
-        k_msleep(1U);
+#if defined(CONFIG_APP_WARM_RESTORE)
+        checkpoint.mark_alive(now_ms);
+#endif
+        k_mutex_unlock(&instance_ptr->lock);
+        LATENCY_PROBE_STAMP(PinWritten);
+
+        /* Sleep until the nearest LED transition or until LEDs mode changes */
+        k_timeout_t timeout = (next_ms == gpio_led_t::NO_TRANSITION) ? K_FOREVER : K_TIMEOUT_ABS_MS(next_ms);
+        k_sem_take(&instance_ptr->update_sem, timeout);
     }
 }
@@ -29,42 +29,346 @@
 #include <zephyr/logging/log.h>
 #include <zephyr/drivers/gpio.h>
 
+#if defined(CONFIG_APP_EVENT_LOG)
+#include "core/event_log.hpp"
+#endif
+#include "core/executor.hpp"
+#if defined(CONFIG_APP_HOT_PATH_BENCH)
+#include "core/hot_path_bench.hpp"
+#endif
+#include "core/latency_probe.hpp"
+#if defined(CONFIG_APP_STACK_MONITOR)
+#include "core/stack_monitor.hpp"
+#endif
 #include "drivers/button.hpp"
+#if defined(CONFIG_APP_I2C_SCHEDULER)
+#include "drivers/i2c_scheduler.hpp"
+#endif
+#if defined(CONFIG_APP_PULSE_CAPTURE) && defined(CONFIG_SOC_FAMILY_STM32)
+#include <stm32_ll_gpio.h>
+#include <stm32_ll_tim.h>
+#include "drivers/pulse_capture.hpp"
+#endif
+#if defined(CONFIG_APP_SIM_HARNESS)
+#include "sim/sim_harness.hpp"
+#endif
 
+#include "app/channels.hpp"
 #include "app/leds_controller.hpp"
 
 using namespace drivers;
 
 LOG_MODULE_REGISTER(main, LOG_LEVEL_INF);
 
+#if defined(CONFIG_APP_PULSE_CAPTURE) && defined(CONFIG_SOC_FAMILY_STM32)
+#define USER_BTN_TIMER_NODE DT_NODELABEL(timers2)
+
+/* User button PA0 is TIM2_CH1 (AF1), captured at 1 MHz through DMA1 Stream 5 Channel 3 */
+static const drivers::stm32_tim_capture_backend_t::config_t user_btn_capture_config = {
+    .tim = reinterpret_cast<TIM_TypeDef *>(DT_REG_ADDR(USER_BTN_TIMER_NODE)),
+    .tim_pclken = {
+        .bus = DT_CLOCKS_CELL(USER_BTN_TIMER_NODE, bus),
+        .enr = DT_CLOCKS_CELL(USER_BTN_TIMER_NODE, bits),
+    },
+    .tick_hz = 1000000U,
+    .ic_filter = LL_TIM_IC_FILTER_FDIV32_N8,
+    .gpio = GPIOA,
+    .pin = LL_GPIO_PIN_0,
+    .alternate = LL_GPIO_AF_1,
+    .dma_dev = DEVICE_DT_GET(DT_NODELABEL(dma1)),
+    .dma_stream = 5,
+    .dma_slot = 3,
+};
+
+static drivers::pulse_capture_t<drivers::stm32_tim_capture_backend_t, 16> user_btn_capture{user_btn_capture_config};
+#endif
+
+#if defined(CONFIG_APP_I2C_SCHEDULER) && DT_NODE_EXISTS(DT_ALIAS(accel0))
+#define ACCEL_NODE DT_ALIAS(accel0)
+
+/* LSM303DLHC accelerometer registers, the MSB of the register address enables auto-increment */
+#define ACCEL_AUTO_INC          0x80U
+#define ACCEL_CTRL_REG1         0x20U
+#define ACCEL_STATUS_REG        0x27U
+#define ACCEL_OUT_X_L           0x28U
+
+/* 100 Hz data rate, X, Y and Z axes enabled */
+#define ACCEL_CTRL_REG1_100HZ   0x57U
+
+static K_THREAD_STACK_DEFINE(i2c_sched_stack, 1024);
+static drivers::i2c_scheduler_t i2c_sched{DEVICE_DT_GET(DT_BUS(ACCEL_NODE))};
+
+/**
+ * @brief           Accelerometer requests completion
+ */
+struct accel_read_t
+{
+    core::event_t done;                     /*!< Signalled when all requests are completed */
+    size_t pending;                         /*!< Number of requests in flight */
+    int result;                             /*!< The first failed request result or `0` */
+};
+
+/**
+ * @brief          Accelerometer request completion callback
+ * @details        Called in the I2C scheduler thread context
+ * @param[in]      result Request result
+ * @param[in]      arg Pointer to \ref accel_read_t
+ */
+static void accel_done_cb(int result, void *arg)
+{
+    accel_read_t *read = static_cast<accel_read_t *>(arg);
+    if ((read->result == 0) && (result != 0)) {
+        read->result = result;
+    }
+    if (--read->pending == 0) {
+        read->done.signal();
+    }
+}
+
+/**
+ * @brief          Accelerometer polling task
+ * @details        Reads the status and all axes every 100 ms. The scheduler
+ *                     thread runs below the executor priority, so both reads
+ *                     are queued together and merged into one 7-byte burst.
+ *                     The bus utilization is reported every 10 seconds
+ */
+static core::task_t accel_task()
+{
+    const uint16_t addr = DT_REG_ADDR(ACCEL_NODE);
+    i2c_request_t status_request;
+    i2c_request_t out_request;
+    accel_read_t read;
+
+    uint8_t ctrl_reg1 = ACCEL_CTRL_REG1_100HZ;
+    read.pending = 1U;
+    read.result = 0;
+    if (!i2c_sched.write_regs(status_request, addr, ACCEL_CTRL_REG1, &ctrl_reg1, sizeof(ctrl_reg1),
+                              ACCEL_AUTO_INC, accel_done_cb, &read)) {
+        co_return;
+    }
+    co_await read.done;
+    if (read.result != 0) {
+        LOG_ERR("Failed to configure accelerometer: %d", read.result);
+        co_return;
+    }
+
+    uint8_t status;
+    int16_t out[3];
+    for (uint32_t sample = 1;; ++sample)
+    {
+        co_await core::sleep_for(K_MSEC(100U));
+
+        read.pending = 2U;
+        read.result = 0;
+        i2c_sched.read_regs(status_request, addr, ACCEL_STATUS_REG, &status, sizeof(status),
+                            ACCEL_AUTO_INC, accel_done_cb, &read);
+        i2c_sched.read_regs(out_request, addr, ACCEL_OUT_X_L, reinterpret_cast<uint8_t *>(out), sizeof(out),
+                            ACCEL_AUTO_INC, accel_done_cb, &read);
+        co_await read.done;
+
+        if (read.result != 0) {
+            LOG_WRN("Accelerometer read failed: %d", read.result);
+        }
+        else {
+            LOG_DBG("accel status 0x%02x x %d y %d z %d", status, out[0], out[1], out[2]);
+        }
+
+        if ((sample % 100U) == 0) {
+            i2c_bus_stats_t stats = i2c_sched.get_stats();
+            LOG_INF("i2c: %u requests %u transactions %u merged %u errors, utilization %u%%",
+                    stats.requests, stats.transactions, stats.merged, stats.errors,
+                    i2c_sched.get_utilization_pct());
+            i2c_sched.reset_stats();
+        }
+    }
+}
+#endif
+
+/**
+ * @brief          User button push callback
+ * @details        Stamps the path start for the latency probe and wakes up
+ *                     the button task, called in ISR context
+ * @param[in]      arg Pointer to push \ref core::event_t
+ */
+static void user_button_push_cb(void *arg)
+{
+    LATENCY_PROBE_STAMP(IrqEntry);
+    core::event_t::signal_cb(arg);
+}
+
+/**
+ * @brief          User button handling task
+ * @details        Publishes every debounced button press to \ref button_channel
+ * @param[in]      user_btn User button instance
+ */
+static core::task_t user_button_task(drivers::button_t &user_btn)
+{
+    core::event_t push_event;
+    user_btn.set_push_callback(user_button_push_cb, &push_event);
+
+    uint32_t press_count = 0;
+    for (;;)
+    {
+        co_await push_event;
+        co_await core::sleep_for(K_MSEC(100U));
+
+        /* Push and debounce times are whole milliseconds, so a held press may still be a tick short */
+        while (!user_btn.is_pressed() && user_btn.is_active()) {
+            co_await core::sleep_for(K_MSEC(10U));
+        }
+
+        /* Bounces re-signal the event, so a missed press is re-checked on the next pass */
+        if (user_btn.is_pressed()) {
+            int64_t press_ms = user_btn.get_push_time_us() / USEC_PER_MSEC;
+            button_channel.publish_with([press_ms, &press_count](button_msg_t &msg) {
+                msg.press_ms = press_ms;
+                msg.press_count = ++press_count;
+            });
+        }
+        else {
+            LATENCY_PROBE_ABORT();
+        }
+    }
+}
+
+/**
+ * @brief          LEDs silent mode task
+ * @details        Toggles LEDs "Silent Blink" mode on every button press
+ * @param[in]      leds_ctrl LEDs controller instance
+ */
+static core::task_t silent_mode_task(leds_controller_t &leds_ctrl)
+{
+    core::event_t button_event;
+    size_t subscriber;
+    if (!button_channel.subscribe(core::event_t::signal_cb, &button_event, subscriber)) {
+        LOG_ERR("Failed to subscribe to %s channel", button_channel.get_name());
+        co_return;
+    }
+
+    bool is_silent = false;
+    for (;;)
+    {
+        co_await button_event;
+
+        if (button_channel.read(subscriber, [](const button_msg_t &) {})) {
+            LATENCY_PROBE_STAMP(EventConsumed);
+            is_silent ? leds_ctrl.enable_silent_mode() : leds_ctrl.disable_silent_mode();
+            is_silent = !is_silent;
+        }
+    }
+}
+
+#if defined(CONFIG_APP_EVENT_LOG)
+/**
+ * @brief          Event log recording task
+ * @details        Records button presses to the event log
+ */
+static core::task_t event_log_task()
+{
+    core::event_t button_event;
+    size_t subscriber;
+    if (!button_channel.subscribe(core::event_t::signal_cb, &button_event, subscriber)) {
+        LOG_ERR("Failed to subscribe to %s channel", button_channel.get_name());
+        co_return;
+    }
+
+    for (;;)
+    {
+        co_await button_event;
+
+        if (button_channel.read(subscriber, [](const button_msg_t &) {})) {
+            core::event_log_t::get_instance().append(core::event_id_t::ButtonPress);
+        }
+    }
+}
+#endif
+
 /**
  * @brief          The application main loop
  * @return         `0`, but in normal operation the function no returns
  */
 int main(void)
 {
+    /* LEDs go first, so a warm boot resumes them before the slow init below */
+    leds_controller_t &leds_ctrl = leds_controller_t::get_instance();
+
     LOG_INF("Hello from Zephyr RTOS");
 
+#if defined(CONFIG_APP_EVENT_LOG)
+    if (!core::event_log_t::get_instance().init()) {
+        LOG_ERR("Failed to initialize event log");
+    }
+#endif
+
+#if defined(CONFIG_APP_HOT_PATH_BENCH)
+    core::hot_path_bench_t::run();
+#endif
+
+#if defined(CONFIG_APP_SIM_HARNESS)
+    if (!sim::sim_harness_t::get_instance().init()) {
+        LOG_ERR("Failed to initialize simulation harness");
+        return 0;
+    }
+#endif
+
     struct gpio_dt_spec user_button_dt = GPIO_DT_SPEC_GET(DT_ALIAS(sw0), gpios);
     drivers::button_t user_btn{user_button_dt.port, user_button_dt.pin};
     user_btn.init(drivers::gpio::pin_pull_t::Float, drivers::gpio::pin_irq_trigger_t::EdgeToActive);
 
-    leds_controller_t &leds_ctrl = leds_controller_t::get_instance();
+#if defined(CONFIG_APP_PULSE_CAPTURE) && defined(CONFIG_SOC_FAMILY_STM32)
+    /* Push IRQ keeps waking up the button task, the debounced push time comes from the capture */
+    if (user_btn_capture.init() && user_btn_capture.start(nullptr, nullptr)) {
+        user_btn.set_edge_time_source(decltype(user_btn_capture)::rising_edge_us_cb, &user_btn_capture);
+    }
+    else {
+        LOG_ERR("Failed to start user button capture");
+    }
+#endif
+
     if (!leds_ctrl.init()) {
         LOG_ERR("Failed to initialize leds controller");
         return 0;
     }
 
-    bool is_silent = false;
-    for (;;)
-    {
-        if (user_btn.is_pressed()) {
-            is_silent ? leds_ctrl.enable_silent_mode() : leds_ctrl.disable_silent_mode();
-            is_silent = !is_silent;
-        }
+#if defined(CONFIG_APP_STACK_MONITOR)
+    if (!core::stack_monitor_t::get_instance().init()) {
+        LOG_ERR("Failed to initialize stack monitor");
+    }
+#endif
+
+    core::executor_t &executor = core::executor_t::get_instance();
+    if (!executor.spawn(silent_mode_task(leds_ctrl))) {
+        LOG_ERR("Failed to spawn silent mode task");
+        return 0;
+    }
+
+#if defined(CONFIG_APP_EVENT_LOG)
+    if (!executor.spawn(event_log_task())) {
+        LOG_ERR("Failed to spawn event log task");
+    }
+#endif
 
-        k_msleep(100U);
+    if (!executor.spawn(user_button_task(user_btn))) {
+        LOG_ERR("Failed to spawn user button task");
+        return 0;
+    }
+
+#if defined(CONFIG_APP_I2C_SCHEDULER) && DT_NODE_EXISTS(DT_ALIAS(accel0))
+    if (!i2c_sched.init(i2c_sched_stack, K_THREAD_STACK_SIZEOF(i2c_sched_stack), K_PRIO_PREEMPT(2))) {
+        LOG_ERR("Failed to initialize I2C scheduler");
+    }
+    else if (!executor.spawn(accel_task())) {
+        LOG_ERR("Failed to spawn accelerometer task");
     }
+#endif
+
+#if defined(CONFIG_APP_LATENCY_PROBE_LOOPBACK)
+    if (!core::latency_probe_t::get_instance().start_loopback()) {
+        LOG_ERR("Failed to start latency probe loopback");
+    }
+#endif
+
+    executor.run();
 
     return 0;
 }
@@ -0,0 +1,135 @@
+/**
+ * @file           : event_bus.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Static publish/subscribe channels
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include "core/event_bus.hpp"
+
+using namespace core;
+
+channel_base_t::channel_base_t(const char *name, channel_subscriber_t *subscribers, size_t subscribers_max)
+    : name{name},
+      subscribers{subscribers},
+      subscribers_max{subscribers_max},
+      subscribers_num{0},
+      lock{},
+      seq{0},
+      publish_cycles{0},
+      stats{}
+{
+}
+
+const char *channel_base_t::get_name() const
+{
+    return this->name;
+}
+
+bool channel_base_t::subscribe(channel_notify_fn notify_cb, void *notify_arg, size_t &subscriber)
+{
+    bool is_subscribed = false;
+
+    k_spinlock_key_t key = k_spin_lock(&this->lock);
+    if (this->subscribers_num < this->subscribers_max) {
+        channel_subscriber_t &slot = this->subscribers[this->subscribers_num];
+        slot.notify_cb = notify_cb;
+        slot.notify_arg = notify_arg;
+        slot.seen_seq = this->seq;
+
+        subscriber = this->subscribers_num++;
+        is_subscribed = true;
+    }
+    k_spin_unlock(&this->lock, key);
+
+    return is_subscribed;
+}
+
+channel_stats_t channel_base_t::get_stats()
+{
+    k_spinlock_key_t key = k_spin_lock(&this->lock);
+    channel_stats_t stats = this->stats;
+    k_spin_unlock(&this->lock, key);
+
+    return stats;
+}
+
+void channel_base_t::reset_stats()
+{
+    k_spinlock_key_t key = k_spin_lock(&this->lock);
+    this->stats = {};
+    k_spin_unlock(&this->lock, key);
+}
+
+k_spinlock_key_t channel_base_t::begin_publish()
+{
+    return k_spin_lock(&this->lock);
+}
+
+void channel_base_t::end_publish(k_spinlock_key_t key)
+{
+    /* Subscribers that have not read the previous message lose it */
+    size_t subscribers_num = this->subscribers_num;
+    for (size_t i = 0; i < subscribers_num; ++i) {
+        if (this->subscribers[i].seen_seq != this->seq) {
+            ++this->stats.dropped;
+        }
+    }
+
+    /* Zero marks "nothing published" */
+    if (++this->seq == 0) {
+        this->seq = 1;
+    }
+    this->publish_cycles = k_cycle_get_32();
+    ++this->stats.published;
+    k_spin_unlock(&this->lock, key);
+
+    /* Slots below the captured number are never modified again */
+    for (size_t i = 0; i < subscribers_num; ++i) {
+        const channel_subscriber_t &slot = this->subscribers[i];
+        if (slot.notify_cb != nullptr) {
+            slot.notify_cb(slot.notify_arg);
+        }
+    }
+}
+
+bool channel_base_t::begin_read(size_t subscriber, k_spinlock_key_t &key)
+{
+    key = k_spin_lock(&this->lock);
+    if ((subscriber >= this->subscribers_num) || (this->subscribers[subscriber].seen_seq == this->seq)) {
+        k_spin_unlock(&this->lock, key);
+        return false;
+    }
+
+    return true;
+}
+
+void channel_base_t::end_read(size_t subscriber, k_spinlock_key_t key)
+{
+    uint32_t latency_cycles = k_cycle_get_32() - this->publish_cycles;
+    if (latency_cycles > this->stats.latency_max_cycles) {
+        this->stats.latency_max_cycles = latency_cycles;
+    }
+    this->stats.latency_sum_cycles += latency_cycles;
+    ++this->stats.consumed;
+
+    this->subscribers[subscriber].seen_seq = this->seq;
+    k_spin_unlock(&this->lock, key);
+}
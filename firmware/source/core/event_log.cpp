@@ -0,0 +1,300 @@
+/**
+ * @file           : event_log.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Append-only binary event log in internal flash
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include "core/event_log.hpp"
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+
+using namespace core;
+
+LOG_MODULE_REGISTER(event_log, LOG_LEVEL_INF);
+
+namespace
+{
+
+/* Tag byte, 5 bytes ms delta varint and 5 bytes per value varint */
+constexpr size_t MAX_RECORD_SIZE = 1U + 5U + 5U * event_log_t::MAX_VALUES_NUM;
+
+constexpr uint8_t MAX_EVENT_ID = 62U;
+constexpr uint8_t VALUES_NUM_SHIFT = 6U;
+
+K_THREAD_STACK_DEFINE(work_queue_stack, 1024);
+
+constexpr uint32_t zigzag(int32_t value)
+{
+    return (static_cast<uint32_t>(value) << 1U) ^ static_cast<uint32_t>(value >> 31U);
+}
+
+}
+
+event_log_t::event_log_t()
+    : area{nullptr}, write_offset{0}, boot_num{0}, active{&pages[0]}, pending{nullptr}, lock{}, dropped_num{0}
+{
+    this->pages[0].size = 0;
+    this->pages[0].written = 0;
+    this->pages[1].size = 0;
+    this->pages[1].written = 0;
+
+    k_work_queue_init(&this->work_queue);
+    k_work_init(&this->write_work, event_log_t::write_work_handler);
+    k_work_init_delayable(&this->flush_work, event_log_t::flush_work_handler);
+}
+
+event_log_t &event_log_t::get_instance()
+{
+    static event_log_t event_log{};
+    return event_log;
+}
+
+bool event_log_t::init()
+{
+    const struct flash_area *area = nullptr;
+    if ((flash_area_open(FIXED_PARTITION_ID(event_log_partition), &area) != 0) ||
+        !device_is_ready(flash_area_get_device(area))) {
+        return false;
+    }
+
+    /* Erasing the oldest sector must keep the newest one */
+    struct flash_pages_info sector;
+    if ((flash_get_page_info_by_offs(flash_area_get_device(area), area->fa_off, &sector) != 0) ||
+        (sector.size >= area->fa_size)) {
+        LOG_ERR("Log partition needs at least two flash sectors");
+        return false;
+    }
+
+    /* The log ends at the first erased page, the newest boot number is the largest one */
+    bool is_end_found = false;
+    uint16_t last_boot_num = 0;
+    for (size_t offset = 0; offset < area->fa_size; offset += event_log_t::PAGE_SIZE) {
+        uint8_t header[4];
+        if (flash_area_read(area, offset, header, sizeof(header)) != 0) {
+            return false;
+        }
+
+        uint16_t magic = sys_get_le16(&header[0]);
+        if (magic == 0xFFFFU) {
+            this->write_offset = offset;
+            is_end_found = true;
+            break;
+        }
+
+        if (magic == event_log_t::PAGE_MAGIC) {
+            last_boot_num = MAX(last_boot_num, sys_get_le16(&header[2]));
+        }
+    }
+
+    /* Log written before the ring layout may fill the partition, the ring continues from its beginning */
+    if (!is_end_found) {
+        if (flash_area_erase(area, 0, sector.size) != 0) {
+            return false;
+        }
+        this->write_offset = 0;
+    }
+
+    struct k_work_queue_config config = {.name = "event_log", .no_yield = false};
+    k_work_queue_start(&this->work_queue, work_queue_stack, K_THREAD_STACK_SIZEOF(work_queue_stack),
+                       K_LOWEST_APPLICATION_THREAD_PRIO, &config);
+
+    this->boot_num = last_boot_num + 1U;
+    this->area = area;
+    LOG_INF("boot %u, log offset %u", this->boot_num, static_cast<uint32_t>(this->write_offset));
+
+    this->append(event_id_t::Boot);
+
+    if (CONFIG_APP_EVENT_LOG_FLUSH_PERIOD_S == 0) {
+        return true;
+    }
+
+    return k_work_schedule_for_queue(&this->work_queue, &this->flush_work,
+                                     K_SECONDS(CONFIG_APP_EVENT_LOG_FLUSH_PERIOD_S)) >= 0;
+}
+
+bool event_log_t::append(event_id_t id, std::initializer_list<int32_t> values)
+{
+    const uint8_t id_num = static_cast<uint8_t>(id);
+    if ((this->area == nullptr) || (id_num > MAX_EVENT_ID) || (values.size() > event_log_t::MAX_VALUES_NUM)) {
+        return false;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&this->lock);
+    int64_t now_ms = k_uptime_get();
+
+    bool is_full = (this->active->size + MAX_RECORD_SIZE) > event_log_t::PAGE_SIZE;
+    bool is_stale = (this->active->size != 0) && ((now_ms - this->active->last_ms) > UINT32_MAX);
+    if (is_full || is_stale) {
+        if (this->pending != nullptr) {
+            ++this->dropped_num;
+            k_spin_unlock(&this->lock, key);
+            return false;
+        }
+        this->submit_active_page();
+    }
+
+    page_t &page = *this->active;
+    if (page.size == 0) {
+        this->start_page(page, now_ms);
+    }
+
+    uint8_t *dst = &page.data[page.size];
+    size_t size = 0;
+    dst[size++] = static_cast<uint8_t>((values.size() << VALUES_NUM_SHIFT) | id_num);
+    size += event_log_t::put_varint(&dst[size], static_cast<uint32_t>(now_ms - page.last_ms));
+
+    int32_t *last_values = this->last_values[id_num];
+    for (int32_t value : values) {
+        /* Wrapping difference, sensor summaries change little between records */
+        uint32_t delta = static_cast<uint32_t>(value) - static_cast<uint32_t>(*last_values);
+        size += event_log_t::put_varint(&dst[size], zigzag(static_cast<int32_t>(delta)));
+        *last_values++ = value;
+    }
+
+    page.size += size;
+    page.last_ms = now_ms;
+
+    k_spin_unlock(&this->lock, key);
+    return true;
+}
+
+void event_log_t::flush()
+{
+    if (this->area != nullptr) {
+        k_work_submit_to_queue(&this->work_queue, &this->write_work);
+    }
+}
+
+uint32_t event_log_t::get_dropped_num() const
+{
+    return this->dropped_num;
+}
+
+void event_log_t::start_page(page_t &page, int64_t now_ms)
+{
+    sys_put_le16(event_log_t::PAGE_MAGIC, &page.data[0]);
+    sys_put_le16(this->boot_num, &page.data[2]);
+    sys_put_le32(static_cast<uint32_t>(now_ms), &page.data[4]);
+    page.size = event_log_t::HEADER_SIZE;
+    page.written = 0;
+    page.offset = this->write_offset;
+    page.last_ms = now_ms;
+
+    this->write_offset = this->next_page_offset(this->write_offset);
+
+    memset(this->last_values, 0, sizeof(this->last_values));
+}
+
+void event_log_t::submit_active_page()
+{
+    this->pending = this->active;
+    this->active = (this->active == &this->pages[0]) ? &this->pages[1] : &this->pages[0];
+    this->active->size = 0;
+
+    k_work_submit_to_queue(&this->work_queue, &this->write_work);
+}
+
+size_t event_log_t::next_page_offset(size_t offset) const
+{
+    offset += event_log_t::PAGE_SIZE;
+    return ((offset + event_log_t::PAGE_SIZE) > this->area->fa_size) ? 0 : offset;
+}
+
+void event_log_t::write_page(page_t &page)
+{
+    /* Records below the snapshot size are complete, appends only add bytes after them */
+    k_spinlock_key_t key = k_spin_lock(&this->lock);
+    size_t size = page.size;
+    k_spin_unlock(&this->lock, key);
+
+    if (page.written >= size) {
+        return;
+    }
+
+    if (page.written == 0) {
+        size_t next_offset = this->next_page_offset(page.offset);
+        struct flash_pages_info sector;
+        if ((flash_get_page_info_by_offs(flash_area_get_device(this->area), this->area->fa_off + next_offset,
+                                         &sector) == 0) &&
+            (static_cast<size_t>(sector.start_offset - this->area->fa_off) == next_offset)) {
+            /* Flash is unavailable for the CPU while the sector is erased */
+            if (flash_area_erase(this->area, next_offset, sector.size) != 0) {
+                LOG_ERR("Failed to erase log sector at %u", static_cast<uint32_t>(next_offset));
+            }
+        }
+    }
+
+    /* Erased bytes after the written ones stay programmable, flash write block is a byte */
+    if (flash_area_write(this->area, page.offset + page.written, &page.data[page.written], size - page.written) != 0) {
+        LOG_ERR("Failed to write log page at %u", static_cast<uint32_t>(page.offset));
+    }
+    page.written = size;
+}
+
+size_t event_log_t::put_varint(uint8_t *dst, uint32_t value)
+{
+    size_t size = 0;
+    while (value >= 0x80U) {
+        dst[size++] = static_cast<uint8_t>(value | 0x80U);
+        value >>= 7U;
+    }
+    dst[size++] = static_cast<uint8_t>(value);
+
+    return size;
+}
+
+void event_log_t::write_work_handler(k_work *work)
+{
+    event_log_t &event_log = *CONTAINER_OF(work, event_log_t, write_work);
+
+    /* Only this handler releases the pending page, it can't change under it */
+    k_spinlock_key_t key = k_spin_lock(&event_log.lock);
+    page_t *pending = event_log.pending;
+    k_spin_unlock(&event_log.lock, key);
+
+    if (pending != nullptr) {
+        event_log.write_page(*pending);
+
+        key = k_spin_lock(&event_log.lock);
+        event_log.pending = nullptr;
+        k_spin_unlock(&event_log.lock, key);
+    }
+
+    /* Filled up active page becomes pending and is written by the next run */
+    key = k_spin_lock(&event_log.lock);
+    page_t *active = event_log.active;
+    k_spin_unlock(&event_log.lock, key);
+
+    event_log.write_page(*active);
+}
+
+void event_log_t::flush_work_handler(k_work *work)
+{
+    k_work_delayable *dwork = k_work_delayable_from_work(work);
+    event_log_t *instance_ptr = CONTAINER_OF(dwork, event_log_t, flush_work);
+
+    instance_ptr->flush();
+    k_work_schedule_for_queue(&instance_ptr->work_queue, dwork, K_SECONDS(CONFIG_APP_EVENT_LOG_FLUSH_PERIOD_S));
+}
@@ -0,0 +1,241 @@
+/**
+ * @file           : executor.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Cooperative C++20 coroutine executor
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include "core/executor.hpp"
+
+#include <cstddef>
+#include <zephyr/kernel.h>
+
+using namespace core;
+
+namespace
+{
+
+/* Frames hold 64-bit members, so blocks keep the alignment operator new guarantees */
+constexpr size_t FRAME_ALIGN = alignof(std::max_align_t);
+constexpr size_t FRAME_BLOCK_SIZE = ROUND_UP(CONFIG_APP_EXECUTOR_FRAME_SIZE, FRAME_ALIGN);
+
+K_MEM_SLAB_DEFINE_STATIC(frame_pool, FRAME_BLOCK_SIZE, CONFIG_APP_EXECUTOR_FRAME_COUNT, FRAME_ALIGN);
+
+/* Every frame is queued at most once, so the queue never overflows */
+K_MSGQ_DEFINE(ready_queue, sizeof(void *), CONFIG_APP_EXECUTOR_FRAME_COUNT, sizeof(void *));
+
+}
+
+task_t task_t::promise_type::get_return_object() noexcept
+{
+    return task_t{std::coroutine_handle<promise_type>::from_promise(*this)};
+}
+
+task_t task_t::promise_type::get_return_object_on_allocation_failure() noexcept
+{
+    return task_t{};
+}
+
+void *task_t::promise_type::operator new(size_t size) noexcept
+{
+    if (size > CONFIG_APP_EXECUTOR_FRAME_SIZE) {
+        return nullptr;
+    }
+
+    void *frame_ptr = nullptr;
+    if (k_mem_slab_alloc(&frame_pool, &frame_ptr, K_NO_WAIT) < 0) {
+        return nullptr;
+    }
+
+    return frame_ptr;
+}
+
+void task_t::promise_type::operator delete(void *ptr) noexcept
+{
+    k_mem_slab_free(&frame_pool, ptr);
+}
+
+task_t::task_t(std::coroutine_handle<promise_type> handle)
+    : handle{handle}
+{
+}
+
+task_t::task_t(task_t &&other) noexcept
+    : handle{other.handle}
+{
+    other.handle = nullptr;
+}
+
+task_t::~task_t()
+{
+    /* Task was never spawned */
+    if (this->handle) {
+        this->handle.destroy();
+    }
+}
+
+bool task_t::is_valid() const
+{
+    return static_cast<bool>(this->handle);
+}
+
+executor_t &executor_t::get_instance()
+{
+    static executor_t executor{};
+    return executor;
+}
+
+bool executor_t::spawn(task_t &&task)
+{
+    if (!task.is_valid()) {
+        return false;
+    }
+
+    std::coroutine_handle<> handle = task.handle;
+    task.handle = nullptr;
+    this->schedule(handle);
+
+    return true;
+}
+
+void executor_t::schedule(std::coroutine_handle<> handle)
+{
+    void *frame_ptr = handle.address();
+
+    int32_t ret = k_msgq_put(&ready_queue, &frame_ptr, K_NO_WAIT);
+    __ASSERT(ret == 0, "Coroutine ready queue overflow");
+    ARG_UNUSED(ret);
+}
+
+void executor_t::run()
+{
+    for (;;) {
+        void *frame_ptr = nullptr;
+        k_msgq_get(&ready_queue, &frame_ptr, K_FOREVER);
+        std::coroutine_handle<>::from_address(frame_ptr).resume();
+    }
+}
+
+sleep_awaiter_t::sleep_awaiter_t(k_timeout_t timeout)
+    : timeout{timeout}
+{
+}
+
+bool sleep_awaiter_t::await_ready() const noexcept
+{
+    return K_TIMEOUT_EQ(this->timeout, K_NO_WAIT);
+}
+
+void sleep_awaiter_t::await_suspend(std::coroutine_handle<> handle) noexcept
+{
+    this->handle = handle;
+    k_timer_init(&this->timer, sleep_awaiter_t::timer_expiry, nullptr);
+    k_timer_start(&this->timer, this->timeout, K_NO_WAIT);
+}
+
+void sleep_awaiter_t::timer_expiry(k_timer *timer)
+{
+    sleep_awaiter_t *awaiter_ptr = CONTAINER_OF(timer, sleep_awaiter_t, timer);
+    executor_t::get_instance().schedule(awaiter_ptr->handle);
+}
+
+event_t::event_t()
+    : lock{}, waiter{nullptr}, is_set{false}
+{
+}
+
+void event_t::signal()
+{
+    std::coroutine_handle<> handle = nullptr;
+
+    k_spinlock_key_t key = k_spin_lock(&this->lock);
+    if (this->waiter) {
+        handle = this->waiter;
+        this->waiter = nullptr;
+    }
+    else {
+        this->is_set = true;
+    }
+    k_spin_unlock(&this->lock, key);
+
+    if (handle) {
+        executor_t::get_instance().schedule(handle);
+    }
+}
+
+void event_t::signal_cb(void *arg)
+{
+    reinterpret_cast<event_t *>(arg)->signal();
+}
+
+bool event_t::await_ready() noexcept
+{
+    k_spinlock_key_t key = k_spin_lock(&this->lock);
+    bool was_set = this->is_set;
+    this->is_set = false;
+    k_spin_unlock(&this->lock, key);
+
+    return was_set;
+}
+
+bool event_t::await_suspend(std::coroutine_handle<> handle) noexcept
+{
+    bool is_suspended = true;
+
+    /* The event may have been signalled after await_ready() check */
+    k_spinlock_key_t key = k_spin_lock(&this->lock);
+    if (this->is_set) {
+        this->is_set = false;
+        is_suspended = false;
+    }
+    else {
+        this->waiter = handle;
+    }
+    k_spin_unlock(&this->lock, key);
+
+    return is_suspended;
+}
+
+bool gpio_edge_t::attach(drivers::gpio::gpio_t &gpio, drivers::gpio::pin_irq_trigger_t irq_trigger)
+{
+    return gpio.attach_irq(event_t::signal_cb, this, irq_trigger);
+}
+
+#if defined(CONFIG_SENSOR)
+sensor_fetch_awaiter_t::sensor_fetch_awaiter_t(const device_t *dev)
+    : dev{dev}, ret{0}
+{
+}
+
+void sensor_fetch_awaiter_t::await_suspend(std::coroutine_handle<> handle) noexcept
+{
+    this->handle = handle;
+    k_work_init(&this->work, sensor_fetch_awaiter_t::work_handler);
+    k_work_submit(&this->work);
+}
+
+void sensor_fetch_awaiter_t::work_handler(k_work *work)
+{
+    sensor_fetch_awaiter_t *awaiter_ptr = CONTAINER_OF(work, sensor_fetch_awaiter_t, work);
+
+    awaiter_ptr->ret = sensor_sample_fetch(awaiter_ptr->dev);
+    executor_t::get_instance().schedule(awaiter_ptr->handle);
+}
+#endif /* defined(CONFIG_SENSOR) */
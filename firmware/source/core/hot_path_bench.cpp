@@ -0,0 +1,235 @@
+/**
+ * @file           : hot_path_bench.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Flash versus SRAM hot path benchmark
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include "core/hot_path_bench.hpp"
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/timing/timing.h>
+#if defined(CONFIG_SOC_SERIES_STM32F4X)
+#include <stm32_ll_system.h>
+#endif
+
+#include "core/hot_path.hpp"
+#include "drivers/gpio.hpp"
+#include "drivers/led.hpp"
+
+using namespace core;
+
+LOG_MODULE_REGISTER(hot_path_bench, LOG_LEVEL_INF);
+
+extern "C" {
+extern char __fw_hot_start[];
+extern char __fw_hot_end[];
+}
+
+namespace core
+{
+
+/* LED output channel doing nothing, so only the LED driver code is measured */
+struct bench_led_output_t
+{
+    bool init() { return true; }
+    void set() {}
+    void reset() {}
+};
+
+/* The same channel for the LED driver instantiated without FW_HOT, so it stays in flash */
+struct bench_flash_led_output_t : bench_led_output_t
+{
+};
+
+} // core
+
+namespace drivers
+{
+
+LED_INSTANTIATE(core::bench_led_output_t);
+template class led_t<core::bench_flash_led_output_t>;
+
+} // driver
+
+namespace
+{
+
+constexpr uint32_t KERNEL_STEPS = 64U;
+
+template <typename Output>
+struct led_case_t
+{
+    drivers::led_t<Output> led;
+    int64_t now_ms;
+};
+
+/* Blink phase and BSRR word composition, the same code is built into both placements */
+ALWAYS_INLINE uint32_t kernel_body(uint32_t acc)
+{
+    for (uint32_t i = 0; i < KERNEL_STEPS; ++i) {
+        uint32_t phase = (acc + (i * 7U)) % 550U;
+        uint32_t pin_mask = BIT(i & 0x0FU);
+        acc = (acc << 1) ^ ((phase < 220U) ? pin_mask : (pin_mask << 16U));
+    }
+
+    return acc;
+}
+
+__noinline void kernel_flash(void *arg)
+{
+    uint32_t *acc = static_cast<uint32_t *>(arg);
+    *acc = kernel_body(*acc);
+}
+
+FW_HOT void kernel_sram(void *arg)
+{
+    uint32_t *acc = static_cast<uint32_t *>(arg);
+    *acc = kernel_body(*acc);
+}
+
+template <typename Output>
+void led_prepare(void *arg)
+{
+    led_case_t<Output> *led_case = static_cast<led_case_t<Output> *>(arg);
+
+    /* A new solid pattern on every run makes update() do the whole job */
+    led_case->now_ms += 1;
+    led_case->led.set_layer(drivers::led_layer_t::Base,
+                            drivers::led_pattern_t::solid((led_case->now_ms & 1) != 0, led_case->now_ms));
+}
+
+template <typename Output>
+void led_update(void *arg)
+{
+    led_case_t<Output> *led_case = static_cast<led_case_t<Output> *>(arg);
+    led_case->led.update(led_case->now_ms);
+}
+
+void bench_irq_handler(void *arg)
+{
+    ARG_UNUSED(arg);
+}
+
+void invalidate_flash_cache()
+{
+#if defined(CONFIG_SOC_SERIES_STM32F4X)
+    /* ART caches are reset only while disabled */
+    LL_FLASH_DisableInstCache();
+    LL_FLASH_DisableDataCache();
+    LL_FLASH_EnableInstCacheReset();
+    LL_FLASH_EnableDataCacheReset();
+    LL_FLASH_DisableInstCacheReset();
+    LL_FLASH_DisableDataCacheReset();
+    LL_FLASH_EnableInstCache();
+    LL_FLASH_EnableDataCache();
+#endif
+}
+
+}
+
+void hot_path_bench_t::run()
+{
+    timing_init();
+    timing_start();
+
+    LOG_INF("hot path code in SRAM: %u bytes", static_cast<uint32_t>(__fw_hot_end - __fw_hot_start));
+
+    uint32_t acc = 1U;
+    led_case_t<bench_led_output_t> led_case{drivers::led_t<bench_led_output_t>{}, 0};
+    led_case.led.init();
+    led_case_t<bench_flash_led_output_t> flash_led_case{drivers::led_t<bench_flash_led_output_t>{}, 0};
+    flash_led_case.led.init();
+
+    /* Handler context of a Pin without holdoff, the handler only dispatches the edge */
+    static drivers::gpio::gpio_irq_wrapper_t irq_ctx{};
+    irq_ctx.irq_handler = bench_irq_handler;
+    irq_ctx.holdoff_us = 0;
+
+    for (bool is_cold : {false, true}) {
+        hot_path_bench_t::log_result(is_cold ? "kernel flash cold" : "kernel flash warm",
+                                     hot_path_bench_t::measure(nullptr, kernel_flash, &acc, is_cold));
+        hot_path_bench_t::log_result(is_cold ? "kernel sram cold" : "kernel sram warm",
+                                     hot_path_bench_t::measure(nullptr, kernel_sram, &acc, is_cold));
+        hot_path_bench_t::log_result(is_cold ? "led update flash cold" : "led update flash warm",
+                                     hot_path_bench_t::measure(led_prepare<bench_flash_led_output_t>,
+                                                               led_update<bench_flash_led_output_t>,
+                                                               &flash_led_case, is_cold));
+        hot_path_bench_t::log_result(is_cold ? "led update sram cold" : "led update sram warm",
+                                     hot_path_bench_t::measure(led_prepare<bench_led_output_t>,
+                                                               led_update<bench_led_output_t>, &led_case, is_cold));
+        hot_path_bench_t::log_result(is_cold ? "pin irq flash cold" : "pin irq flash warm",
+                                     hot_path_bench_t::measure(nullptr, hot_path_bench_t::pin_irq_flash,
+                                                               &irq_ctx.cb_ctx, is_cold));
+        hot_path_bench_t::log_result(is_cold ? "pin irq sram cold" : "pin irq sram warm",
+                                     hot_path_bench_t::measure(nullptr, hot_path_bench_t::pin_irq_sram,
+                                                               &irq_ctx.cb_ctx, is_cold));
+    }
+
+    timing_stop();
+}
+
+void hot_path_bench_t::pin_irq_flash(void *arg)
+{
+    drivers::gpio::gpio_t::pin_irq_handler_flash(nullptr, static_cast<gpio_callback_t *>(arg), 0);
+}
+
+void hot_path_bench_t::pin_irq_sram(void *arg)
+{
+    drivers::gpio::gpio_t::pin_irq_handler(nullptr, static_cast<gpio_callback_t *>(arg), 0);
+}
+
+bench_result_t hot_path_bench_t::measure(void (*prepare)(void *arg), void (*fn)(void *arg), void *arg, bool is_cold)
+{
+    bench_result_t result{UINT32_MAX, 0, 0, 0};
+
+    for (uint32_t i = 0; i < CONFIG_APP_HOT_PATH_BENCH_ITERATIONS; ++i) {
+        if (prepare != nullptr) {
+            prepare(arg);
+        }
+
+        unsigned int key = irq_lock();
+        if (is_cold) {
+            invalidate_flash_cache();
+        }
+        timing_t start = timing_counter_get();
+        fn(arg);
+        timing_t end = timing_counter_get();
+        irq_unlock(key);
+
+        uint32_t cycles = static_cast<uint32_t>(timing_cycles_get(&start, &end));
+        result.min_cycles = MIN(result.min_cycles, cycles);
+        result.max_cycles = MAX(result.max_cycles, cycles);
+        result.sum_cycles += cycles;
+        ++result.runs;
+    }
+
+    return result;
+}
+
+void hot_path_bench_t::log_result(const char *name, const bench_result_t &result)
+{
+    uint32_t avg_cycles = static_cast<uint32_t>(result.sum_cycles / MAX(result.runs, 1U));
+
+    LOG_INF("%s: min %u avg %u max %u jitter %u cycles, avg %u ns", name, result.min_cycles, avg_cycles,
+            result.max_cycles, result.max_cycles - result.min_cycles,
+            static_cast<uint32_t>(timing_cycles_to_ns(avg_cycles)));
+}
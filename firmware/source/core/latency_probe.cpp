@@ -0,0 +1,275 @@
+/**
+ * @file           : latency_probe.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Input to output latency probe
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include "core/latency_probe.hpp"
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/drivers/gpio.h>
+#if defined(CONFIG_APP_LATENCY_PROBE_LOOPBACK) && !DT_NODE_HAS_PROP(DT_PATH(zephyr_user), loopback_gpios)
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#endif
+
+using namespace core;
+
+LOG_MODULE_REGISTER(latency_probe, LOG_LEVEL_INF);
+
+namespace
+{
+
+constexpr const char *INTERVAL_NAMES[latency_probe_t::INTERVALS_NUM] = {
+    "irq->event", "event->command", "command->pin", "irq->pin"
+};
+
+#if defined(CONFIG_APP_LATENCY_PROBE_LOOPBACK)
+K_THREAD_STACK_DEFINE(thread_stack, 1024);
+
+/* A path not completed within this timeout is dropped */
+constexpr uint32_t LOOPBACK_TIMEOUT_MS = 1000U;
+
+#if DT_NODE_HAS_PROP(DT_PATH(zephyr_user), loopback_gpios)
+/* Spare output Pin wired to the button input */
+const struct gpio_dt_spec loopback_spec = GPIO_DT_SPEC_GET(DT_PATH(zephyr_user), loopback_gpios);
+#else
+/* The button input itself is driven by the GPIO emulator */
+const struct gpio_dt_spec loopback_spec = GPIO_DT_SPEC_GET(DT_ALIAS(sw0), gpios);
+#endif
+#endif /* defined(CONFIG_APP_LATENCY_PROBE_LOOPBACK) */
+
+}
+
+latency_probe_t &latency_probe_t::get_instance()
+{
+    static latency_probe_t latency_probe{};
+    return latency_probe;
+}
+
+void latency_probe_t::stamp(probe_stage_t stage)
+{
+    uint32_t now_cycles = k_cycle_get_32();
+    size_t idx = static_cast<size_t>(stage);
+    bool is_complete = false;
+
+    k_spinlock_key_t key = k_spin_lock(&this->lock);
+    if (idx == this->next_stage) {
+        this->stamps[idx] = now_cycles;
+        if (idx == (INTERVALS_NUM - 1U)) {
+            this->record();
+            this->next_stage = 0;
+            is_complete = true;
+        }
+        else {
+            this->next_stage = idx + 1U;
+        }
+    }
+    k_spin_unlock(&this->lock, key);
+
+#if defined(CONFIG_APP_LATENCY_PROBE_LOOPBACK)
+    if (is_complete) {
+        k_sem_give(&this->done_sem);
+    }
+#else
+    ARG_UNUSED(is_complete);
+#endif
+}
+
+void latency_probe_t::abort()
+{
+    k_spinlock_key_t key = k_spin_lock(&this->lock);
+    this->next_stage = 0;
+    k_spin_unlock(&this->lock, key);
+}
+
+bool latency_probe_t::get_histogram(size_t interval, probe_histogram_t &histogram)
+{
+    if (interval >= INTERVALS_NUM) {
+        return false;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&this->lock);
+    histogram = this->histograms[interval];
+    k_spin_unlock(&this->lock, key);
+
+    return true;
+}
+
+uint32_t latency_probe_t::get_percentile_us(size_t interval, uint32_t pct)
+{
+    if ((interval >= INTERVALS_NUM) || (pct > 100U)) {
+        return 0;
+    }
+
+    uint32_t bound_us = 0;
+
+    k_spinlock_key_t key = k_spin_lock(&this->lock);
+    const probe_histogram_t &histogram = this->histograms[interval];
+    if (histogram.count > 0) {
+        /* Rank of the percentile sample, 1-based */
+        uint64_t rank = ((static_cast<uint64_t>(histogram.count) * pct) + 99U) / 100U;
+        rank = (rank == 0) ? 1U : rank;
+
+        uint64_t seen = 0;
+        if (interval == TOTAL_INTERVAL) {
+            size_t i = 0;
+            for (; i < LINEAR_BUCKETS_NUM; ++i) {
+                seen += this->linear_buckets[i];
+                if (seen >= rank) {
+                    break;
+                }
+            }
+            bound_us = (i < (LINEAR_BUCKETS_NUM - 1U)) ? ((i + 1U) * CONFIG_APP_LATENCY_PROBE_BUCKET_US) : histogram.max_us;
+        }
+        else {
+            size_t i = 0;
+            for (; i < probe_histogram_t::LOG2_BUCKETS_NUM; ++i) {
+                seen += histogram.log2_buckets[i];
+                if (seen >= rank) {
+                    break;
+                }
+            }
+            bound_us = (i == 0) ? 0 : ((i < 32U) ? (BIT(i) - 1U) : UINT32_MAX);
+        }
+        bound_us = MIN(bound_us, histogram.max_us);
+    }
+    k_spin_unlock(&this->lock, key);
+
+    return bound_us;
+}
+
+void latency_probe_t::report()
+{
+    for (size_t i = 0; i < INTERVALS_NUM; ++i) {
+        probe_histogram_t histogram;
+        this->get_histogram(i, histogram);
+        if (histogram.count == 0) {
+            LOG_INF("latency %s: no samples", INTERVAL_NAMES[i]);
+            continue;
+        }
+
+        LOG_INF("latency %s: n %u min %u avg %u p50 %u p90 %u p99 %u max %u us",
+                INTERVAL_NAMES[i], histogram.count, histogram.min_us,
+                static_cast<uint32_t>(histogram.sum_us / histogram.count),
+                this->get_percentile_us(i, 50U), this->get_percentile_us(i, 90U),
+                this->get_percentile_us(i, 99U), histogram.max_us);
+    }
+}
+
+void latency_probe_t::reset()
+{
+    k_spinlock_key_t key = k_spin_lock(&this->lock);
+    for (auto &histogram : this->histograms) {
+        histogram = {};
+    }
+    for (auto &bucket : this->linear_buckets) {
+        bucket = 0;
+    }
+    this->next_stage = 0;
+    k_spin_unlock(&this->lock, key);
+}
+
+void latency_probe_t::record()
+{
+    for (size_t i = 0; i < TOTAL_INTERVAL; ++i) {
+        latency_probe_t::add_sample(this->histograms[i], k_cyc_to_us_floor32(this->stamps[i + 1U] - this->stamps[i]));
+    }
+
+    uint32_t total_us = k_cyc_to_us_floor32(this->stamps[TOTAL_INTERVAL] - this->stamps[0]);
+    latency_probe_t::add_sample(this->histograms[TOTAL_INTERVAL], total_us);
+
+    size_t bucket = total_us / CONFIG_APP_LATENCY_PROBE_BUCKET_US;
+    ++this->linear_buckets[MIN(bucket, LINEAR_BUCKETS_NUM - 1U)];
+}
+
+void latency_probe_t::add_sample(probe_histogram_t &histogram, uint32_t us)
+{
+    if ((histogram.count == 0) || (us < histogram.min_us)) {
+        histogram.min_us = us;
+    }
+    if (us > histogram.max_us) {
+        histogram.max_us = us;
+    }
+    ++histogram.count;
+    histogram.sum_us += us;
+
+    size_t bucket = (us == 0) ? 0 : (32U - static_cast<size_t>(__builtin_clz(us)));
+    ++histogram.log2_buckets[bucket];
+}
+
+#if defined(CONFIG_APP_LATENCY_PROBE_LOOPBACK)
+bool latency_probe_t::start_loopback()
+{
+    k_sem_init(&this->done_sem, 0, 1);
+
+#if DT_NODE_HAS_PROP(DT_PATH(zephyr_user), loopback_gpios)
+    if (!gpio_is_ready_dt(&loopback_spec) || (gpio_pin_configure_dt(&loopback_spec, GPIO_OUTPUT_INACTIVE) < 0)) {
+        return false;
+    }
+#endif
+
+    k_tid_t tid = k_thread_create(&this->thread,
+                                  thread_stack, K_THREAD_STACK_SIZEOF(thread_stack),
+                                  latency_probe_t::loopback_thread,
+                                  this, nullptr, nullptr,
+                                  K_LOWEST_APPLICATION_THREAD_PRIO, 0, K_NO_WAIT);
+    k_thread_name_set(tid, "latency_loop");
+
+    return true;
+}
+
+void latency_probe_t::drive_loopback(bool is_pressed)
+{
+#if DT_NODE_HAS_PROP(DT_PATH(zephyr_user), loopback_gpios)
+    gpio_pin_set_dt(&loopback_spec, is_pressed ? 1 : 0);
+#else
+    bool is_active_low = (loopback_spec.dt_flags & GPIO_ACTIVE_LOW) != 0;
+    gpio_emul_input_set(loopback_spec.port, loopback_spec.pin, (is_pressed != is_active_low) ? 1 : 0);
+#endif
+}
+
+void latency_probe_t::loopback_thread(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    latency_probe_t *instance_ptr = reinterpret_cast<latency_probe_t *>(arg1);
+
+    for (uint32_t iteration = 1;; ++iteration) {
+        k_sem_reset(&instance_ptr->done_sem);
+        instance_ptr->drive_loopback(true);
+        if (k_sem_take(&instance_ptr->done_sem, K_MSEC(LOOPBACK_TIMEOUT_MS)) != 0) {
+            ++instance_ptr->timeouts;
+            instance_ptr->abort();
+        }
+
+        /* Release longer than the button debounce, so the next press is a clean edge */
+        instance_ptr->drive_loopback(false);
+        k_sleep(K_MSEC(CONFIG_APP_LATENCY_PROBE_RELEASE_MS));
+
+        if ((iteration % CONFIG_APP_LATENCY_PROBE_REPORT_EVERY) == 0) {
+            LOG_INF("loopback iterations %u timeouts %u", iteration, instance_ptr->timeouts);
+            instance_ptr->report();
+        }
+    }
+}
+#endif /* defined(CONFIG_APP_LATENCY_PROBE_LOOPBACK) */
@@ -0,0 +1,140 @@
+/**
+ * @file           : stack_monitor.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Runtime thread and ISR stack high-water monitor
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include "core/stack_monitor.hpp"
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+using namespace core;
+
+LOG_MODULE_REGISTER(stack_monitor, LOG_LEVEL_INF);
+
+extern "C" {
+K_KERNEL_STACK_ARRAY_DECLARE(z_interrupt_stacks, CONFIG_MP_MAX_NUM_CPUS, CONFIG_ISR_STACK_SIZE);
+}
+
+namespace
+{
+
+/* Fill pattern of unused stack memory with CONFIG_INIT_STACKS */
+constexpr uint8_t STACK_FILL_PATTERN = 0xAAU;
+
+/* Stack pointer alignment on ARM EABI */
+constexpr size_t STACK_ALIGN = 8U;
+
+}
+
+stack_monitor_t::stack_monitor_t()
+{
+    k_work_init_delayable(&this->report_work, stack_monitor_t::report_work_handler);
+}
+
+stack_monitor_t &stack_monitor_t::get_instance()
+{
+    static stack_monitor_t stack_monitor{};
+    return stack_monitor;
+}
+
+bool stack_monitor_t::init()
+{
+    if (CONFIG_APP_STACK_MONITOR_PERIOD_S == 0) {
+        return true;
+    }
+
+    return k_work_schedule(&this->report_work, K_SECONDS(CONFIG_APP_STACK_MONITOR_PERIOD_S)) >= 0;
+}
+
+void stack_monitor_t::report()
+{
+    k_thread_foreach_unlocked(stack_monitor_t::thread_report_cb, nullptr);
+
+    usage_t isr_usage;
+    if (stack_monitor_t::get_isr_usage(isr_usage)) {
+        stack_monitor_t::log_usage(isr_usage);
+    }
+}
+
+bool stack_monitor_t::get_isr_usage(usage_t &usage)
+{
+    const uint8_t *stack_ptr = reinterpret_cast<const uint8_t *>(Z_KERNEL_STACK_BUFFER(z_interrupt_stacks[0]));
+    size_t size = K_KERNEL_STACK_SIZEOF(z_interrupt_stacks[0]);
+
+    /* Stack grows down, so untouched bytes are at the lowest addresses */
+    size_t unused = 0;
+    while ((unused < size) && (stack_ptr[unused] == STACK_FILL_PATTERN)) {
+        ++unused;
+    }
+    if (unused == 0) {
+        return false;
+    }
+
+    usage.name = "isr";
+    usage.size = size;
+    usage.used = size - unused;
+    usage.recommended = stack_monitor_t::recommend_size(usage.used);
+
+    return true;
+}
+
+size_t stack_monitor_t::recommend_size(size_t used)
+{
+    size_t size = used + (used * CONFIG_APP_STACK_MONITOR_MARGIN_PCT) / 100U;
+    return ROUND_UP(size, STACK_ALIGN);
+}
+
+void stack_monitor_t::thread_report_cb(const k_thread *thread, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    size_t unused = 0;
+    if (k_thread_stack_space_get(thread, &unused) < 0) {
+        return;
+    }
+
+    usage_t usage;
+    usage.name = k_thread_name_get(const_cast<k_tid_t>(thread));
+    usage.size = thread->stack_info.size;
+    usage.used = usage.size - unused;
+    usage.recommended = stack_monitor_t::recommend_size(usage.used);
+
+    stack_monitor_t::log_usage(usage);
+}
+
+void stack_monitor_t::log_usage(const usage_t &usage)
+{
+    LOG_INF("stack %s: size %u used %u recommended %u",
+            ((usage.name != nullptr) && (usage.name[0] != '\0')) ? usage.name : "unnamed",
+            static_cast<uint32_t>(usage.size), static_cast<uint32_t>(usage.used),
+            static_cast<uint32_t>(usage.recommended));
+}
+
+void stack_monitor_t::report_work_handler(k_work *work)
+{
+    k_work_delayable *dwork = k_work_delayable_from_work(work);
+    stack_monitor_t *instance_ptr = CONTAINER_OF(dwork, stack_monitor_t, report_work);
+
+    instance_ptr->report();
+    k_work_schedule(dwork, K_SECONDS(CONFIG_APP_STACK_MONITOR_PERIOD_S));
+}
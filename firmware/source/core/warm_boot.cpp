@@ -0,0 +1,58 @@
+/**
+ * @file           : warm_boot.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Warm boot detection
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include "core/warm_boot.hpp"
+
+#include <stdint.h>
+#include <zephyr/drivers/hwinfo.h>
+
+namespace
+{
+
+/* Resets, which keep SRAM contents */
+constexpr uint32_t WARM_RESETS = RESET_WATCHDOG | RESET_SOFTWARE | RESET_PIN;
+
+/* Resets, which lose SRAM contents or leave them undefined */
+constexpr uint32_t COLD_RESETS = RESET_POR | RESET_BROWNOUT | RESET_LOW_POWER_WAKE;
+
+bool is_checked = false;
+bool is_warm = false;
+
+}
+
+bool core::is_warm_boot()
+{
+    if (is_checked) {
+        return is_warm;
+    }
+
+    uint32_t cause = 0;
+    if (hwinfo_get_reset_cause(&cause) == 0) {
+        is_warm = ((cause & WARM_RESETS) != 0) && ((cause & COLD_RESETS) == 0);
+        hwinfo_clear_reset_cause();
+    }
+    is_checked = true;
+
+    return is_warm;
+}
@@ -0,0 +1,242 @@
+/**
+ * @file           : analog_input.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : DMA-streamed double-buffered analog input
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include "drivers/analog_input.hpp"
+
+#if defined(CONFIG_SOC_FAMILY_STM32) && defined(CONFIG_DMA)
+#include <zephyr/drivers/dma.h>
+#include <zephyr/drivers/clock_control.h>
+#include <stm32_ll_adc.h>
+#include <stm32_ll_tim.h>
+
+#include "drivers/stm32_timer.hpp"
+#endif
+
+using namespace drivers;
+
+#if defined(CONFIG_SOC_FAMILY_STM32) && defined(CONFIG_DMA)
+stm32_adc_dma_backend_t::stm32_adc_dma_backend_t(const config_t &config)
+    : config{config}, tim_rate_hz{0}, half_handler{nullptr}, half_handler_arg{nullptr}
+{
+}
+
+bool stm32_adc_dma_backend_t::init()
+{
+    const device_t *clk_dev = DEVICE_DT_GET(STM32_CLOCK_CONTROL_NODE);
+    auto *adc_subsys = reinterpret_cast<clock_control_subsys_t>(&this->config.adc_pclken);
+    if (!device_is_ready(this->config.dma_dev) || !device_is_ready(clk_dev) ||
+        (clock_control_on(clk_dev, adc_subsys) != 0) ||
+        !stm32_timer_clock_on(this->config.tim_pclken, this->tim_rate_hz)) {
+        return false;
+    }
+
+    /* 96 MHz APB2 / 4 = 24 MHz ADC clock, 56 + 12 cycles per conversion limit the rate to 350 kHz */
+    ADC_TypeDef *adc = this->config.adc;
+    LL_ADC_Disable(adc);
+    LL_ADC_SetCommonClock(__LL_ADC_COMMON_INSTANCE(adc), LL_ADC_CLOCK_SYNC_PCLK_DIV4);
+    LL_ADC_SetResolution(adc, LL_ADC_RESOLUTION_12B);
+    LL_ADC_SetDataAlignment(adc, LL_ADC_DATA_ALIGN_RIGHT);
+    LL_ADC_SetSequencersScanMode(adc, LL_ADC_SEQ_SCAN_DISABLE);
+    LL_ADC_REG_SetSequencerLength(adc, LL_ADC_REG_SEQ_SCAN_DISABLE);
+    LL_ADC_REG_SetSequencerRanks(adc, LL_ADC_REG_RANK_1, this->config.adc_channel);
+    LL_ADC_SetChannelSamplingTime(adc, this->config.adc_channel, LL_ADC_SAMPLINGTIME_56CYCLES);
+    LL_ADC_REG_SetContinuousMode(adc, LL_ADC_REG_CONV_SINGLE);
+    LL_ADC_REG_SetTriggerSource(adc, this->config.adc_trigger);
+    LL_ADC_REG_SetDMATransfer(adc, LL_ADC_REG_DMA_TRANSFER_UNLIMITED);
+
+    return true;
+}
+
+bool stm32_adc_dma_backend_t::start(uint16_t *buffer, size_t samples_num, uint32_t sample_rate_hz,
+                                        analog_half_handler_fn half_handler, void *arg)
+{
+    if ((sample_rate_hz == 0) || (samples_num == 0) || (samples_num > UINT16_MAX)) {
+        return false;
+    }
+
+    const uint32_t period_cycles = this->tim_rate_hz / sample_rate_hz;
+    const uint32_t prescaler = (period_cycles - 1U) / (UINT16_MAX + 1U);
+    const uint32_t auto_reload = period_cycles / (prescaler + 1U);
+    if (auto_reload < 2U) {
+        return false;
+    }
+
+    this->half_handler = half_handler;
+    this->half_handler_arg = arg;
+
+    struct dma_block_config block = {};
+    block.source_address = reinterpret_cast<uintptr_t>(&this->config.adc->DR);
+    block.dest_address = reinterpret_cast<uintptr_t>(buffer);
+    block.block_size = samples_num * sizeof(uint16_t);
+    block.source_addr_adj = DMA_ADDR_ADJ_NO_CHANGE;
+    block.dest_addr_adj = DMA_ADDR_ADJ_INCREMENT;
+    block.source_reload_en = 1;
+    block.dest_reload_en = 1;
+
+    struct dma_config dma_cfg = {};
+    dma_cfg.dma_slot = this->config.dma_slot;
+    dma_cfg.channel_direction = PERIPHERAL_TO_MEMORY;
+    dma_cfg.channel_priority = 2;
+    dma_cfg.source_data_size = sizeof(uint16_t);
+    dma_cfg.dest_data_size = sizeof(uint16_t);
+    dma_cfg.source_burst_length = 1;
+    dma_cfg.dest_burst_length = 1;
+    dma_cfg.block_count = 1;
+    dma_cfg.head_block = &block;
+    dma_cfg.user_data = this;
+    dma_cfg.dma_callback = stm32_adc_dma_backend_t::dma_callback;
+
+    if ((dma_config(this->config.dma_dev, this->config.dma_stream, &dma_cfg) != 0) ||
+        (dma_start(this->config.dma_dev, this->config.dma_stream) != 0)) {
+        return false;
+    }
+
+    ADC_TypeDef *adc = this->config.adc;
+    LL_ADC_Enable(adc);
+    LL_ADC_REG_StartConversionExtTrig(adc, LL_ADC_REG_TRIG_EXT_RISING);
+
+    /* Channel 1 PWM rising edge once per period triggers a conversion */
+    TIM_TypeDef *tim = this->config.tim;
+    LL_TIM_DisableCounter(tim);
+    LL_TIM_SetPrescaler(tim, prescaler);
+    LL_TIM_SetAutoReload(tim, auto_reload - 1U);
+    LL_TIM_OC_SetMode(tim, LL_TIM_CHANNEL_CH1, LL_TIM_OCMODE_PWM1);
+    LL_TIM_OC_SetCompareCH1(tim, auto_reload / 2U);
+    LL_TIM_CC_EnableChannel(tim, LL_TIM_CHANNEL_CH1);
+    LL_TIM_GenerateEvent_UPDATE(tim);
+    LL_TIM_SetCounter(tim, 0);
+    LL_TIM_EnableCounter(tim);
+
+    return true;
+}
+
+void stm32_adc_dma_backend_t::stop()
+{
+    LL_TIM_DisableCounter(this->config.tim);
+    LL_ADC_REG_StopConversionExtTrig(this->config.adc);
+    dma_stop(this->config.dma_dev, this->config.dma_stream);
+    LL_ADC_Disable(this->config.adc);
+}
+
+void stm32_adc_dma_backend_t::dma_callback(const device_t *dev, void *user_data, uint32_t channel, int status)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(channel);
+
+    auto *backend = static_cast<stm32_adc_dma_backend_t *>(user_data);
+    if (status < 0) {
+        return;
+    }
+
+    /* Half transfer is reported as a block, full transfer as completion */
+    backend->half_handler(backend->half_handler_arg, (status == DMA_STATUS_BLOCK) ? 0U : 1U);
+}
+#endif /* defined(CONFIG_SOC_FAMILY_STM32) && defined(CONFIG_DMA) */
+
+#if defined(CONFIG_ADC_ASYNC)
+adc_sequence_backend_t::adc_sequence_backend_t(const struct adc_dt_spec &spec)
+    : spec{spec}, sequence{}, options{}, samples_num{0}, is_running{false},
+      half_handler{nullptr}, half_handler_arg{nullptr}
+{
+    k_poll_signal_init(&this->signal);
+    k_work_init(&this->restart_work, adc_sequence_backend_t::restart_work_handler);
+}
+
+bool adc_sequence_backend_t::init()
+{
+    if (!adc_is_ready_dt(&this->spec)) {
+        return false;
+    }
+
+    return adc_channel_setup_dt(&this->spec) == 0;
+}
+
+bool adc_sequence_backend_t::start(uint16_t *buffer, size_t samples_num, uint32_t sample_rate_hz,
+                                       analog_half_handler_fn half_handler, void *arg)
+{
+    if ((sample_rate_hz == 0) || (samples_num < 2U) || (samples_num > (UINT16_MAX + 1U))) {
+        return false;
+    }
+
+    this->samples_num = samples_num;
+    this->half_handler = half_handler;
+    this->half_handler_arg = arg;
+
+    this->options.interval_us = USEC_PER_SEC / sample_rate_hz;
+    this->options.callback = adc_sequence_backend_t::sampling_callback;
+    this->options.user_data = this;
+    this->options.extra_samplings = static_cast<uint16_t>(samples_num - 1U);
+
+    if (adc_sequence_init_dt(&this->spec, &this->sequence) != 0) {
+        return false;
+    }
+    this->sequence.options = &this->options;
+    this->sequence.buffer = buffer;
+    this->sequence.buffer_size = samples_num * sizeof(uint16_t);
+
+    this->is_running = true;
+    if (adc_read_async(this->spec.dev, &this->sequence, &this->signal) != 0) {
+        this->is_running = false;
+        return false;
+    }
+
+    return true;
+}
+
+void adc_sequence_backend_t::stop()
+{
+    this->is_running = false;
+}
+
+enum adc_action adc_sequence_backend_t::sampling_callback(const device_t *dev, const struct adc_sequence *sequence,
+                                                          uint16_t sampling_index)
+{
+    ARG_UNUSED(dev);
+
+    auto *backend = static_cast<adc_sequence_backend_t *>(sequence->options->user_data);
+    size_t filled_num = static_cast<size_t>(sampling_index) + 1U;
+
+    if (filled_num == (backend->samples_num / 2U)) {
+        backend->half_handler(backend->half_handler_arg, 0);
+    }
+    else if (filled_num == backend->samples_num) {
+        backend->half_handler(backend->half_handler_arg, 1);
+        if (backend->is_running) {
+            k_work_submit(&backend->restart_work);
+        }
+    }
+
+    return ADC_ACTION_CONTINUE;
+}
+
+void adc_sequence_backend_t::restart_work_handler(k_work *work)
+{
+    adc_sequence_backend_t *instance_ptr = CONTAINER_OF(work, adc_sequence_backend_t, restart_work);
+
+    if (instance_ptr->is_running &&
+        (adc_read_async(instance_ptr->spec.dev, &instance_ptr->sequence, &instance_ptr->signal) != 0)) {
+        instance_ptr->is_running = false;
+    }
+}
+#endif /* defined(CONFIG_ADC_ASYNC) */
@@ -0,0 +1,221 @@
+/**
+ * @file           : bam.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Bit-angle modulation LED dimming engine
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include "drivers/bam.hpp"
+
+#include <errno.h>
+#include <algorithm>
+
+using namespace drivers;
+
+namespace
+{
+
+/* Frame length in time units, sum of 2^n over all bit-planes */
+constexpr uint32_t FRAME_UNITS = (1U << bam_engine_t::BITS_NUM) - 1U;
+
+constexpr uint8_t ALARM_CHANNEL = 0U;
+
+}
+
+bam_engine_t::bam_engine_t(const device_t *counter_dev, uint32_t frame_rate_hz)
+    : counter_dev{counter_dev}, frame_rate_hz{frame_rate_hz}, unit_ticks{0}, counter_top{0}, alarm_ticks{0},
+      plane{0}, is_late{false}, late_alarms_num{0}, ports{}, ports_num{0}, shown_planes{}, next_planes{},
+      is_next_dirty{false}, lock{}
+{
+}
+
+bool bam_engine_t::add_channel(const device_t *port_ptr, uint8_t pin, bool is_active_low, size_t &channel)
+{
+    auto port_it = std::find_if(this->ports.begin(), this->ports.begin() + this->ports_num,
+                                [port_ptr](const port_t &port) { return port.port_ptr == port_ptr; });
+    if (port_it == (this->ports.begin() + this->ports_num)) {
+        if (this->ports_num == bam_engine_t::MAX_PORTS_NUM) {
+            return false;
+        }
+        port_it->port_ptr = port_ptr;
+        ++this->ports_num;
+    }
+
+    port_it->pins |= BIT(pin);
+    if (is_active_low) {
+        port_it->active_low_pins |= BIT(pin);
+    }
+
+    channel = this->channels.size();
+    this->channels.push_back({static_cast<uint8_t>(port_it - this->ports.begin()), pin, 0});
+
+    return true;
+}
+
+bool bam_engine_t::init()
+{
+    if (!device_is_ready(this->counter_dev)) {
+        return false;
+    }
+
+    /* The shortest plane leaves room for the alarm ISR, the frame rate drops if needed */
+    uint32_t freq_hz = counter_get_frequency(this->counter_dev);
+    uint32_t min_unit_ticks = static_cast<uint32_t>(DIV_ROUND_UP(static_cast<uint64_t>(freq_hz) *
+                                                                     CONFIG_APP_BAM_MIN_PLANE_US, USEC_PER_SEC));
+    this->unit_ticks = std::max(freq_hz / (this->frame_rate_hz * FRAME_UNITS), min_unit_ticks);
+    if (this->unit_ticks == 0) {
+        return false;
+    }
+    this->counter_top = counter_get_top_value(this->counter_dev);
+
+    /* Alarms further ahead than the guard period are late, so the longest plane must be shorter */
+    uint32_t guard_ticks = this->counter_top / 2U;
+    if ((static_cast<uint64_t>(this->unit_ticks) << (bam_engine_t::BITS_NUM - 1U)) >= guard_ticks) {
+        return false;
+    }
+
+    /* Active LOW is applied on Port write, so Pins are configured raw and OFF */
+    for (const auto &channel : this->channels) {
+        const port_t &port = this->ports[channel.port_idx];
+        gpio_flags_t flags = ((port.active_low_pins & BIT(channel.pin)) != 0) ? GPIO_OUTPUT_HIGH : GPIO_OUTPUT_LOW;
+        if (!device_is_ready(port.port_ptr) || (gpio_pin_configure(port.port_ptr, channel.pin, flags) < 0)) {
+            return false;
+        }
+    }
+
+    /* Without a guard period a late alarm is armed for a full counter wrap */
+    int ret = counter_set_guard_period(this->counter_dev, guard_ticks, COUNTER_GUARD_PERIOD_LATE_TO_SET);
+    if ((ret != 0) && (ret != -ENOTSUP)) {
+        return false;
+    }
+
+    if (counter_start(this->counter_dev) != 0) {
+        return false;
+    }
+
+    uint32_t now_ticks = 0;
+    if (counter_get_value(this->counter_dev, &now_ticks) != 0) {
+        return false;
+    }
+
+    this->plane = 0;
+    this->is_late = false;
+    this->late_alarms_num = 0;
+    this->alarm_ticks = static_cast<uint32_t>((static_cast<uint64_t>(now_ticks) + this->unit_ticks) %
+                                              (static_cast<uint64_t>(this->counter_top) + 1U));
+
+    struct counter_alarm_cfg alarm_cfg = {
+        .callback = bam_engine_t::alarm_handler,
+        .ticks = this->alarm_ticks,
+        .user_data = this,
+        .flags = COUNTER_ALARM_CFG_ABSOLUTE | COUNTER_ALARM_CFG_EXPIRE_WHEN_LATE,
+    };
+
+    /* A late alarm expires right away */
+    ret = counter_set_channel_alarm(this->counter_dev, ALARM_CHANNEL, &alarm_cfg);
+    if (ret == -ETIME) {
+        this->is_late = true;
+        return true;
+    }
+
+    return ret == 0;
+}
+
+void bam_engine_t::set_brightness(size_t channel, uint8_t brightness)
+{
+    if (channel >= this->channels.size()) {
+        return;
+    }
+
+    channel_t &ch = this->channels[channel];
+    gpio_port_pins_t pin_mask = BIT(ch.pin);
+
+    k_spinlock_key_t key = k_spin_lock(&this->lock);
+    ch.brightness = brightness;
+    for (size_t bit = 0; bit < bam_engine_t::BITS_NUM; ++bit) {
+        gpio_port_value_t &plane_mask = this->next_planes[bit][ch.port_idx];
+        plane_mask = ((brightness & BIT(bit)) != 0) ? (plane_mask | pin_mask) : (plane_mask & ~pin_mask);
+    }
+    this->is_next_dirty = true;
+    k_spin_unlock(&this->lock, key);
+}
+
+uint8_t bam_engine_t::get_brightness(size_t channel) const
+{
+    return (channel < this->channels.size()) ? this->channels[channel].brightness : 0;
+}
+
+uint32_t bam_engine_t::get_frame_rate_hz() const
+{
+    if (this->unit_ticks == 0) {
+        return 0;
+    }
+
+    return counter_get_frequency(this->counter_dev) / (this->unit_ticks * FRAME_UNITS);
+}
+
+uint32_t bam_engine_t::get_late_alarms_num() const
+{
+    return this->late_alarms_num;
+}
+
+void bam_engine_t::alarm_handler(const device_t *dev, uint8_t chan_id, uint32_t ticks, void *user_data)
+{
+    auto *engine = static_cast<bam_engine_t *>(user_data);
+
+    /* A late alarm has expired at `ticks`, the schedule restarts from there */
+    if (engine->is_late) {
+        engine->alarm_ticks = ticks;
+        engine->is_late = false;
+    }
+
+    /* Brightness changes are latched at the frame start, so no frame mixes old and new planes */
+    if (engine->plane == 0) {
+        k_spinlock_key_t key = k_spin_lock(&engine->lock);
+        if (engine->is_next_dirty) {
+            engine->shown_planes = engine->next_planes;
+            engine->is_next_dirty = false;
+        }
+        k_spin_unlock(&engine->lock, key);
+    }
+
+    const auto &plane_masks = engine->shown_planes[engine->plane];
+    for (size_t i = 0; i < engine->ports_num; ++i) {
+        const port_t &port = engine->ports[i];
+        gpio_port_set_masked_raw(port.port_ptr, port.pins, plane_masks[i] ^ port.active_low_pins);
+    }
+
+    /* Alarms follow the ideal schedule, so interrupt latency does not accumulate */
+    uint64_t plane_ticks = static_cast<uint64_t>(engine->unit_ticks) << engine->plane;
+    engine->alarm_ticks = static_cast<uint32_t>((engine->alarm_ticks + plane_ticks) %
+                                                (static_cast<uint64_t>(engine->counter_top) + 1U));
+    engine->plane = (engine->plane + 1U) % bam_engine_t::BITS_NUM;
+
+    struct counter_alarm_cfg alarm_cfg = {
+        .callback = bam_engine_t::alarm_handler,
+        .ticks = engine->alarm_ticks,
+        .user_data = engine,
+        .flags = COUNTER_ALARM_CFG_ABSOLUTE | COUNTER_ALARM_CFG_EXPIRE_WHEN_LATE,
+    };
+    if (counter_set_channel_alarm(dev, chan_id, &alarm_cfg) == -ETIME) {
+        engine->is_late = true;
+        ++engine->late_alarms_num;
+    }
+}
@@ -26,11 +26,22 @@
 
 #include <zephyr/kernel.h>
 
+#include "core/hot_path.hpp"
+
 using namespace drivers;
 using namespace drivers::gpio;
 
+namespace
+{
+
+/* Latched edge farther from the push IRQ stamp belongs to another push */
+constexpr int64_t EDGE_TIME_WINDOW_US = 1000;
+
+}
+
 button_t::button_t(const device_t *port_ptr, uint8_t pin, bool is_active_low)
-    : gpio{port_ptr, pin, is_active_low}, press_tstamp{0}
+    : gpio{port_ptr, pin, is_active_low}, press_tstamp{0}, push_tstamp_us{0}, push_cb{nullptr}, push_cb_arg{nullptr},
+      edge_time_cb{nullptr}, edge_time_arg{nullptr}
 {
 }
 
@@ -55,9 +66,47 @@ bool button_t::is_pressed()
                (k_uptime_get() - this->press_tstamp) > 100U;
 }
 
-void button_t::push_irq_callback(void *arg)
+bool button_t::is_active()
+{
+    return this->gpio.read_active_state() == pin_active_state_t::Active;
+}
+
+void button_t::set_push_callback(gpio_irq_handler_fn push_cb, void *push_cb_arg)
+{
+    this->push_cb_arg = push_cb_arg;
+    this->push_cb = push_cb;
+}
+
+void button_t::set_edge_time_source(edge_time_fn edge_time_cb, void *edge_time_arg)
+{
+    this->edge_time_arg = edge_time_arg;
+    this->edge_time_cb = edge_time_cb;
+}
+
+int64_t button_t::get_push_time_us() const
+{
+    int64_t push_us = this->push_tstamp_us;
+    if (this->edge_time_cb == nullptr) {
+        return push_us;
+    }
+
+    int64_t edge_us = this->edge_time_cb(this->edge_time_arg);
+    if ((edge_us < 0) || (edge_us < (push_us - EDGE_TIME_WINDOW_US)) || (edge_us > (push_us + EDGE_TIME_WINDOW_US))) {
+        return push_us;
+    }
+
+    return edge_us;
+}
+
+FW_HOT void button_t::push_irq_callback(void *arg)
 {
     button_t *instance_ptr = reinterpret_cast<button_t *>(arg);
 
-    instance_ptr->press_tstamp = k_uptime_get();
+    int64_t push_us = static_cast<int64_t>(k_ticks_to_us_floor64(k_uptime_ticks()));
+    instance_ptr->push_tstamp_us = push_us;
+    instance_ptr->press_tstamp = push_us / USEC_PER_MSEC;
+
+    if (instance_ptr->push_cb != nullptr) {
+        instance_ptr->push_cb(instance_ptr->push_cb_arg);
+    }
 }
@@ -26,13 +26,44 @@
 
 #include <zephyr/kernel.h>
 
+#include "core/hot_path.hpp"
+
 using namespace drivers::gpio;
 
+namespace
+{
+
+/* GPIO Port cache pool, see gpio_t::enable_port_cache() */
+gpio_port_cache_t port_caches[CONFIG_APP_GPIO_PORT_CACHE_NUM];
+k_spinlock port_caches_lock;
+
+/* Pin IRQ handling, built into the SRAM handler and its flash copy for the benchmark */
+ALWAYS_INLINE void handle_pin_irq(const device_t *port, gpio_callback_t *cb)
+{
+    struct gpio_irq_wrapper_t *container = CONTAINER_OF(cb, gpio_irq_wrapper_t, cb_ctx);
+
+    if (container->holdoff_us != 0) {
+        gpio_pin_interrupt_configure(port, container->pin, GPIO_INT_DISABLE);
+        container->masked_level = gpio_pin_get_raw(port, container->pin);
+        atomic_inc(&container->holdoffs);
+        k_timer_start(&container->holdoff_timer, K_USEC(container->holdoff_us), K_NO_WAIT);
+    }
+
+    atomic_inc(&container->delivered);
+    container->irq_handler(container->arg);
+}
+
+}
+
 gpio_t::gpio_t(const device_t *port_ptr, uint8_t pin, bool is_active_low)
-    : port_ptr(port_ptr), pin(pin), is_active_low(is_active_low)
+    : port_ptr(port_ptr), pin(pin), is_active_low(is_active_low), is_output(false), port_cache(nullptr)
 {
     // Raise abort() if std::bad_alloc exception throws with -fno-exceptions
     this->irq_ctx = std::make_unique<gpio_irq_wrapper_t>();
+    this->irq_ctx->port_ptr = port_ptr;
+    this->irq_ctx->pin = pin;
+    this->irq_ctx->is_active_low = is_active_low;
+    k_timer_init(&this->irq_ctx->holdoff_timer, gpio_t::holdoff_expiry_handler, nullptr);
 }
 
 bool gpio_t::config_as_output(pin_output_mode_t omode, pin_active_state_t init_state, pin_output_slew_t speed)
@@ -57,21 +88,54 @@ bool gpio_t::config_as_output(pin_output_mode_t omode, pin_active_state_t init_s
         return false;
     }
 
+    this->is_output = true;
+    if (this->port_cache != nullptr) {
+        bool is_high = (init_state == pin_active_state_t::Active) != this->is_active_low;
+        if (is_high) {
+            atomic_or(&this->port_cache->output, BIT(this->pin));
+        }
+        else {
+            atomic_and(&this->port_cache->output, ~BIT(this->pin));
+        }
+    }
+
     return true;
 }
 
-void gpio_t::set()
+FW_HOT void gpio_t::set()
 {
+    if (this->port_cache != nullptr) {
+        this->write_cached(!this->is_active_low);
+        return;
+    }
+
     gpio_pin_set(this->port_ptr, this->pin, 1);
 }
 
-void gpio_t::reset()
+FW_HOT void gpio_t::reset()
 {
+    if (this->port_cache != nullptr) {
+        this->write_cached(this->is_active_low);
+        return;
+    }
+
     gpio_pin_set(this->port_ptr, this->pin, 0);
 }
 
 void gpio_t::toggle()
 {
+    if (this->port_cache != nullptr) {
+        /* The shadow flips atomically, so concurrent toggles never write a stale level */
+        atomic_val_t prev = atomic_xor(&this->port_cache->output, BIT(this->pin));
+        if ((prev & BIT(this->pin)) != 0) {
+            gpio_port_clear_bits_raw(this->port_ptr, BIT(this->pin));
+        }
+        else {
+            gpio_port_set_bits_raw(this->port_ptr, BIT(this->pin));
+        }
+        return;
+    }
+
     gpio_pin_toggle(this->port_ptr, this->pin);
 }
 
@@ -97,19 +161,148 @@ bool gpio_t::config_as_input(pin_pull_t pull)
         return false;
     }
 
+    this->is_output = false;
+    return true;
+}
+
+bool gpio_t::config_as_analog()
+{
+    if (!device_is_ready(this->port_ptr)) {
+        return false;
+    }
+
+    /* STM32 GPIO driver puts disconnected Pins into Analog mode */
+    int32_t ret = gpio_pin_configure(this->port_ptr, this->pin, GPIO_DISCONNECTED);
+    if (ret < 0) {
+        return false;
+    }
+
+    this->is_output = false;
     return true;
 }
 
 pin_state_t gpio_t::read_state()
 {
+    if (this->port_cache != nullptr) {
+        const atomic_t *state = this->is_output ? &this->port_cache->output : &this->port_cache->input;
+        return ((atomic_get(state) & BIT(this->pin)) != 0) ? pin_state_t::Set : pin_state_t::Reset;
+    }
+
     return (gpio_pin_get_raw(this->port_ptr, this->pin) == 1) ? pin_state_t::Set : pin_state_t::Reset;
 }
 
 pin_active_state_t gpio_t::read_active_state()
 {
+    if (this->port_cache != nullptr) {
+        bool is_high = (this->read_state() == pin_state_t::Set);
+        return (is_high != this->is_active_low) ? pin_active_state_t::Active : pin_active_state_t::Inactive;
+    }
+
     return (gpio_pin_get(this->port_ptr, this->pin) == 1) ? pin_active_state_t::Active : pin_active_state_t::Inactive;
 }
 
+bool gpio_t::enable_port_cache()
+{
+    if (this->port_cache != nullptr) {
+        return true;
+    }
+
+    gpio_port_cache_t *cache = nullptr;
+    bool is_new = false;
+
+    k_spinlock_key_t key = k_spin_lock(&port_caches_lock);
+    for (auto &entry : port_caches) {
+        if (entry.port_ptr == this->port_ptr) {
+            cache = &entry;
+            break;
+        }
+        if ((entry.port_ptr == nullptr) && (cache == nullptr)) {
+            cache = &entry;
+            is_new = true;
+        }
+    }
+    if (is_new) {
+        cache->port_ptr = this->port_ptr;
+        atomic_set(&cache->input, 0);
+        atomic_set(&cache->output, 0);
+    }
+    k_spin_unlock(&port_caches_lock, key);
+
+    if (cache == nullptr) {
+        return false;
+    }
+
+    /* Seed the snapshot and the shadow with the current Port state */
+    gpio_port_value_t value;
+    if (gpio_port_get_raw(this->port_ptr, &value) < 0) {
+        return false;
+    }
+    atomic_set(&cache->input, static_cast<atomic_val_t>(value));
+    if ((value & BIT(this->pin)) != 0) {
+        atomic_or(&cache->output, BIT(this->pin));
+    }
+    else {
+        atomic_and(&cache->output, ~BIT(this->pin));
+    }
+
+    this->port_cache = cache;
+    return true;
+}
+
+bool gpio_t::sample_all()
+{
+    bool is_ok = true;
+
+    for (auto &entry : port_caches) {
+        const device_t *port_ptr = entry.port_ptr;
+        if (port_ptr == nullptr) {
+            /* Entries are taken in order and never released */
+            break;
+        }
+
+        gpio_port_value_t value;
+        if (gpio_port_get_raw(port_ptr, &value) < 0) {
+            is_ok = false;
+            continue;
+        }
+        atomic_set(&entry.input, static_cast<atomic_val_t>(value));
+    }
+
+    return is_ok;
+}
+
+bool gpio_t::read_port_state(gpio_port_value_t &value)
+{
+    return gpio_port_get_raw(this->port_ptr, &value) == 0;
+}
+
+const device_t *gpio_t::get_port() const
+{
+    return this->port_ptr;
+}
+
+uint8_t gpio_t::get_pin() const
+{
+    return this->pin;
+}
+
+bool gpio_t::get_is_active_low() const
+{
+    return this->is_active_low;
+}
+
+FW_HOT void gpio_t::write_cached(bool is_high)
+{
+    if (is_high) {
+        atomic_or(&this->port_cache->output, BIT(this->pin));
+        gpio_port_set_bits_raw(this->port_ptr, BIT(this->pin));
+    }
+    else {
+        atomic_and(&this->port_cache->output, ~BIT(this->pin));
+        gpio_port_clear_bits_raw(this->port_ptr, BIT(this->pin));
+    }
+}
+
 bool gpio_t::attach_irq(gpio_irq_handler_fn irq_handler, void *irq_handler_arg, pin_irq_trigger_t irq_trigger)
 {
     if (irq_handler == nullptr) {
@@ -137,6 +330,7 @@ bool gpio_t::attach_irq(gpio_irq_handler_fn irq_handler, void *irq_handler_arg,
 
     this->irq_ctx->irq_handler = irq_handler;
     this->irq_ctx->arg = irq_handler_arg;
+    this->irq_ctx->edge_flags = edge_flags;
     gpio_init_callback(&this->irq_ctx->cb_ctx, gpio_t::pin_irq_handler, BIT(this->pin));
     ret = gpio_add_callback(this->port_ptr, &this->irq_ctx->cb_ctx);
     if (ret < 0) {
@@ -152,6 +346,8 @@ bool gpio_t::detach_irq()
         return false;
     }
 
+    k_timer_stop(&this->irq_ctx->holdoff_timer);
+
     int32_t ret = gpio_remove_callback(this->port_ptr, &this->irq_ctx->cb_ctx);
     if (ret < 0) {
         return false;
@@ -160,8 +356,60 @@ bool gpio_t::detach_irq()
     return true;
 }
 
-void gpio_t::pin_irq_handler(const device_t *port, gpio_callback_t *cb, gpio_port_pins_t pins)
+void gpio_t::set_irq_holdoff(uint32_t holdoff_us)
 {
-    struct gpio_irq_wrapper_t *container = CONTAINER_OF(cb, gpio_irq_wrapper_t, cb_ctx);
-    container->irq_handler(container->arg);
+    this->irq_ctx->holdoff_us = holdoff_us;
+}
+
+gpio_irq_stats_t gpio_t::get_irq_stats() const
+{
+    return {
+        .delivered = static_cast<uint32_t>(atomic_get(&this->irq_ctx->delivered)),
+        .changed_holdoffs = static_cast<uint32_t>(atomic_get(&this->irq_ctx->changed_holdoffs)),
+        .holdoffs = static_cast<uint32_t>(atomic_get(&this->irq_ctx->holdoffs)),
+    };
+}
+
+void gpio_t::reset_irq_stats()
+{
+    atomic_clear(&this->irq_ctx->delivered);
+    atomic_clear(&this->irq_ctx->changed_holdoffs);
+    atomic_clear(&this->irq_ctx->holdoffs);
+}
+
+FW_HOT void gpio_t::pin_irq_handler(const device_t *port, gpio_callback_t *cb, gpio_port_pins_t pins)
+{
+    handle_pin_irq(port, cb);
+}
+
+#if defined(CONFIG_APP_HOT_PATH_BENCH)
+__noinline void gpio_t::pin_irq_handler_flash(const device_t *port, gpio_callback_t *cb, gpio_port_pins_t pins)
+{
+    handle_pin_irq(port, cb);
+}
+#endif
+
+void gpio_t::holdoff_expiry_handler(k_timer *timer)
+{
+    struct gpio_irq_wrapper_t *container = CONTAINER_OF(timer, gpio_irq_wrapper_t, holdoff_timer);
+
+    /* Re-armed before sampling, so an edge right after the sample raises its own interrupt */
+    gpio_pin_interrupt_configure(container->port_ptr, container->pin, container->edge_flags);
+    int level = gpio_pin_get_raw(container->port_ptr, container->pin);
+
+    /* An edge since re-arming is delivered by its interrupt, which masks at the new level */
+    if ((level < 0) || (level == container->masked_level)) {
+        return;
+    }
+
+    /* The Pin settled on the other level, the last suppressed edge defines whether it triggers */
+    atomic_inc(&container->changed_holdoffs);
+
+    bool is_active = (level == 1) != container->is_active_low;
+    bool is_triggered = ((container->edge_flags == GPIO_INT_EDGE_BOTH) ||
+                         ((container->edge_flags == GPIO_INT_EDGE_TO_ACTIVE) && is_active) ||
+                         ((container->edge_flags == GPIO_INT_EDGE_TO_INACTIVE) && !is_active));
+    if (is_triggered) {
+        gpio_t::pin_irq_handler(container->port_ptr, &container->cb_ctx, BIT(container->pin));
+    }
 }
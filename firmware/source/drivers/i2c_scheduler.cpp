@@ -0,0 +1,312 @@
+/**
+ * @file           : i2c_scheduler.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Asynchronous I2C bus transaction scheduler
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include "drivers/i2c_scheduler.hpp"
+
+#include <string.h>
+#include <algorithm>
+#include <zephyr/kernel.h>
+
+using namespace drivers;
+
+i2c_scheduler_t::i2c_scheduler_t(const device_t *bus_dev)
+    : bus_dev{bus_dev}, lock{}, head{nullptr}, tail{nullptr}, burst{}, stats{}, window_start_ms{0}
+{
+}
+
+bool i2c_scheduler_t::init(k_thread_stack_t *stack_ptr, size_t stack_size, int prio)
+{
+    if (!device_is_ready(this->bus_dev)) {
+        return false;
+    }
+
+    k_sem_init(&this->queue_sem, 0, 1);
+#if defined(CONFIG_I2C_CALLBACK)
+    k_sem_init(&this->transfer_sem, 0, 1);
+#endif
+    this->reset_stats();
+
+    k_tid_t tid = k_thread_create(&this->thread, stack_ptr, stack_size, i2c_scheduler_t::scheduler_thread,
+                                  this, nullptr, nullptr, prio, 0, K_NO_WAIT);
+    k_thread_name_set(tid, "i2c_sched");
+
+    return true;
+}
+
+bool i2c_scheduler_t::submit(i2c_request_t &request)
+{
+    if ((request.buf == nullptr) || (request.len == 0)) {
+        return false;
+    }
+
+    request.next = nullptr;
+
+    k_spinlock_key_t key = k_spin_lock(&this->lock);
+    if (this->tail == nullptr) {
+        this->head = &request;
+    }
+    else {
+        this->tail->next = &request;
+    }
+    this->tail = &request;
+    k_spin_unlock(&this->lock, key);
+
+    k_sem_give(&this->queue_sem);
+    return true;
+}
+
+bool i2c_scheduler_t::read_regs(i2c_request_t &request, uint16_t addr, uint8_t reg, uint8_t *buf, size_t len,
+                                    uint8_t auto_inc_mask, i2c_done_fn done_cb, void *done_arg)
+{
+    request.addr = addr;
+    request.reg = reg;
+    request.auto_inc_mask = auto_inc_mask;
+    request.is_write = false;
+    request.buf = buf;
+    request.len = len;
+    request.done_cb = done_cb;
+    request.done_arg = done_arg;
+
+    return this->submit(request);
+}
+
+bool i2c_scheduler_t::write_regs(i2c_request_t &request, uint16_t addr, uint8_t reg, uint8_t *buf, size_t len,
+                                     uint8_t auto_inc_mask, i2c_done_fn done_cb, void *done_arg)
+{
+    request.addr = addr;
+    request.reg = reg;
+    request.auto_inc_mask = auto_inc_mask;
+    request.is_write = true;
+    request.buf = buf;
+    request.len = len;
+    request.done_cb = done_cb;
+    request.done_arg = done_arg;
+
+    return this->submit(request);
+}
+
+i2c_bus_stats_t i2c_scheduler_t::get_stats()
+{
+    k_spinlock_key_t key = k_spin_lock(&this->lock);
+    i2c_bus_stats_t stats = this->stats;
+    stats.window_us = static_cast<uint64_t>(k_uptime_get() - this->window_start_ms) * USEC_PER_MSEC;
+    k_spin_unlock(&this->lock, key);
+
+    return stats;
+}
+
+uint32_t i2c_scheduler_t::get_utilization_pct()
+{
+    i2c_bus_stats_t stats = this->get_stats();
+    if (stats.window_us == 0) {
+        return 0;
+    }
+
+    return static_cast<uint32_t>(MIN((stats.busy_us * 100U) / stats.window_us, 100U));
+}
+
+void i2c_scheduler_t::reset_stats()
+{
+    k_spinlock_key_t key = k_spin_lock(&this->lock);
+    this->stats = {};
+    this->window_start_ms = k_uptime_get();
+    k_spin_unlock(&this->lock, key);
+}
+
+size_t i2c_scheduler_t::take_batch(i2c_request_t **batch)
+{
+    size_t batch_size = 0;
+
+    k_spinlock_key_t key = k_spin_lock(&this->lock);
+    while ((this->head != nullptr) && (batch_size < BATCH_MAX)) {
+        batch[batch_size++] = this->head;
+        this->head = this->head->next;
+    }
+    if (this->head == nullptr) {
+        this->tail = nullptr;
+    }
+    k_spin_unlock(&this->lock, key);
+
+    return batch_size;
+}
+
+void i2c_scheduler_t::run_batch(i2c_request_t **batch, size_t batch_size)
+{
+    bool is_done[BATCH_MAX] = {};
+
+    for (size_t i = 0; i < batch_size; ++i) {
+        if (is_done[i]) {
+            continue;
+        }
+
+        i2c_request_t *request = batch[i];
+        if (request->is_write || (request->len > BURST_MAX)) {
+            uint8_t reg = request->reg | ((request->len > 1U) ? request->auto_inc_mask : 0U);
+            this->complete(request, this->transfer(request->addr, reg, request->buf, request->len, request->is_write));
+            is_done[i] = true;
+            continue;
+        }
+
+        /* Collect later reads of the same device up to its next write */
+        size_t group[BATCH_MAX];
+        size_t group_size = 0;
+        group[group_size++] = i;
+        for (size_t j = i + 1U; j < batch_size; ++j) {
+            const i2c_request_t *other = batch[j];
+            if (is_done[j] || (other->addr != request->addr)) {
+                continue;
+            }
+            if (other->is_write) {
+                break;
+            }
+            if ((other->auto_inc_mask == request->auto_inc_mask) && (other->len <= BURST_MAX)) {
+                group[group_size++] = j;
+            }
+        }
+
+        std::sort(group, group + group_size, [batch](size_t a, size_t b) { return batch[a]->reg < batch[b]->reg; });
+
+        /* Every run of touching or overlapping register ranges is one burst */
+        size_t first = 0;
+        while (first < group_size) {
+            uint32_t start = batch[group[first]]->reg;
+            uint32_t end = start + batch[group[first]]->len;
+            size_t last = first + 1U;
+            while (last < group_size) {
+                const i2c_request_t *next = batch[group[last]];
+                uint32_t next_end = std::max<uint32_t>(end, next->reg + next->len);
+                if ((next->reg > end) || ((next_end - start) > BURST_MAX)) {
+                    break;
+                }
+                end = next_end;
+                ++last;
+            }
+
+            if ((last - first) == 1U) {
+                i2c_request_t *single = batch[group[first]];
+                uint8_t reg = single->reg | ((single->len > 1U) ? single->auto_inc_mask : 0U);
+                this->complete(single, this->transfer(single->addr, reg, single->buf, single->len, false));
+            }
+            else {
+                size_t burst_len = end - start;
+                uint8_t reg = static_cast<uint8_t>(start) | request->auto_inc_mask;
+                int ret = this->transfer(request->addr, reg, this->burst, burst_len, false);
+
+                k_spinlock_key_t key = k_spin_lock(&this->lock);
+                this->stats.merged += (last - first) - 1U;
+                k_spin_unlock(&this->lock, key);
+
+                for (size_t k = first; k < last; ++k) {
+                    i2c_request_t *merged = batch[group[k]];
+                    if (ret == 0) {
+                        memcpy(merged->buf, &this->burst[merged->reg - start], merged->len);
+                    }
+                    this->complete(merged, ret);
+                }
+            }
+
+            for (size_t k = first; k < last; ++k) {
+                is_done[group[k]] = true;
+            }
+            first = last;
+        }
+    }
+}
+
+int i2c_scheduler_t::transfer(uint16_t addr, uint8_t reg, uint8_t *buf, size_t len, bool is_write)
+{
+    struct i2c_msg msgs[2];
+    msgs[0].buf = &reg;
+    msgs[0].len = 1U;
+    msgs[0].flags = I2C_MSG_WRITE;
+    msgs[1].buf = buf;
+    msgs[1].len = len;
+    msgs[1].flags = (is_write ? I2C_MSG_WRITE : (I2C_MSG_RESTART | I2C_MSG_READ)) | I2C_MSG_STOP;
+
+    uint32_t start_cycles = k_cycle_get_32();
+#if defined(CONFIG_I2C_CALLBACK)
+    int ret = i2c_transfer_cb(this->bus_dev, msgs, ARRAY_SIZE(msgs), addr, i2c_scheduler_t::transfer_done_cb, this);
+    if (ret == 0) {
+        k_sem_take(&this->transfer_sem, K_FOREVER);
+        ret = this->transfer_result;
+    }
+#else
+    int ret = i2c_transfer(this->bus_dev, msgs, ARRAY_SIZE(msgs), addr);
+#endif
+    uint32_t busy_us = k_cyc_to_us_floor32(k_cycle_get_32() - start_cycles);
+
+    k_spinlock_key_t key = k_spin_lock(&this->lock);
+    ++this->stats.transactions;
+    this->stats.busy_us += busy_us;
+    if (ret == 0) {
+        this->stats.bytes += len;
+    }
+    else {
+        ++this->stats.errors;
+    }
+    k_spin_unlock(&this->lock, key);
+
+    return ret;
+}
+
+void i2c_scheduler_t::complete(i2c_request_t *request, int result)
+{
+    k_spinlock_key_t key = k_spin_lock(&this->lock);
+    ++this->stats.requests;
+    k_spin_unlock(&this->lock, key);
+
+    if (request->done_cb != nullptr) {
+        request->done_cb(result, request->done_arg);
+    }
+}
+
+void i2c_scheduler_t::scheduler_thread(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    i2c_scheduler_t *instance_ptr = reinterpret_cast<i2c_scheduler_t *>(arg1);
+    i2c_request_t *batch[BATCH_MAX];
+
+    for (;;) {
+        k_sem_take(&instance_ptr->queue_sem, K_FOREVER);
+
+        /* Requests queued while a batch runs form the next batch */
+        size_t batch_size;
+        while ((batch_size = instance_ptr->take_batch(batch)) > 0) {
+            instance_ptr->run_batch(batch, batch_size);
+        }
+    }
+}
+
+#if defined(CONFIG_I2C_CALLBACK)
+void i2c_scheduler_t::transfer_done_cb(const device_t *dev, int result, void *arg)
+{
+    ARG_UNUSED(dev);
+
+    i2c_scheduler_t *instance_ptr = reinterpret_cast<i2c_scheduler_t *>(arg);
+    instance_ptr->transfer_result = result;
+    k_sem_give(&instance_ptr->transfer_sem);
+}
+#endif
@@ -0,0 +1,187 @@
+/**
+ * @file           : key_matrix.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Scanned key matrix driver
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include "drivers/key_matrix.hpp"
+
+#include <algorithm>
+#include <zephyr/kernel.h>
+
+using namespace drivers;
+using namespace drivers::gpio;
+
+key_matrix_t::key_matrix_t(const struct gpio_dt_spec *rows, size_t rows_num,
+                               const struct gpio_dt_spec *cols, size_t cols_num)
+    : is_cols_contiguous{false}, debounced{0}, cnt0{0}, cnt1{0},
+      event_handler{nullptr}, event_handler_arg{nullptr}, settle_us{0}
+{
+    this->rows.reserve(rows_num);
+    for (size_t i = 0; i < rows_num; ++i) {
+        this->rows.emplace_back(rows[i].port, rows[i].pin, (rows[i].dt_flags & GPIO_ACTIVE_LOW) != 0);
+    }
+
+    this->cols.reserve(cols_num);
+    for (size_t i = 0; i < cols_num; ++i) {
+        this->cols.emplace_back(cols[i].port, cols[i].pin, (cols[i].dt_flags & GPIO_ACTIVE_LOW) != 0);
+    }
+}
+
+bool key_matrix_t::init(pin_pull_t cols_pull, key_event_handler_fn event_handler, void *event_handler_arg,
+                            uint32_t settle_us)
+{
+    if (((this->rows.size() * this->cols.size()) > key_matrix_t::MAX_KEYS_NUM) ||
+        (this->cols.size() > key_matrix_t::MAX_COLS_NUM)) {
+        return false;
+    }
+
+    /* Open Drain rows do not short each other when several keys in a column are pressed */
+    for (auto &row : this->rows) {
+        if (!row.get_is_active_low()) {
+            return false;
+        }
+
+        if (!row.config_as_output(pin_output_mode_t::OpenDrain, pin_active_state_t::Inactive)) {
+            return false;
+        }
+    }
+
+    this->cols_ports.clear();
+    this->cols_port_idx.clear();
+    for (auto &col : this->cols) {
+        if (!col.config_as_input(cols_pull)) {
+            return false;
+        }
+
+        auto port_it = std::find(this->cols_ports.begin(), this->cols_ports.end(), col.get_port());
+        if (port_it == this->cols_ports.end()) {
+            port_it = this->cols_ports.insert(this->cols_ports.end(), col.get_port());
+        }
+        this->cols_port_idx.push_back(static_cast<uint8_t>(port_it - this->cols_ports.begin()));
+    }
+
+    this->is_cols_contiguous = (this->cols_ports.size() == 1);
+    for (size_t i = 1; this->is_cols_contiguous && (i < this->cols.size()); ++i) {
+        this->is_cols_contiguous = (this->cols[i].get_pin() == (this->cols[0].get_pin() + i)) &&
+                                       (this->cols[i].get_is_active_low() == this->cols[0].get_is_active_low());
+    }
+
+    this->event_handler = event_handler;
+    this->event_handler_arg = event_handler_arg;
+    this->settle_us = settle_us;
+
+    this->debounced = 0;
+    this->cnt0 = 0;
+    this->cnt1 = 0;
+
+    return true;
+}
+
+void key_matrix_t::scan()
+{
+    uint64_t raw = this->sample();
+
+    /* 2-bit vertical counters: count changed keys, reset stable ones */
+    uint64_t delta = raw ^ this->debounced;
+    this->cnt1 = (this->cnt1 ^ this->cnt0) & delta;
+    this->cnt0 = ~this->cnt0 & delta;
+
+    uint64_t toggled = delta & ~(this->cnt0 | this->cnt1);
+    if (toggled == 0) {
+        return;
+    }
+    this->debounced ^= toggled;
+
+    if (this->event_handler == nullptr) {
+        return;
+    }
+
+    while (toggled != 0) {
+        uint8_t key = static_cast<uint8_t>(__builtin_ctzll(toggled));
+        toggled &= toggled - 1U;
+
+        key_event_t event = ((this->debounced & BIT64(key)) != 0) ? key_event_t::Press : key_event_t::Release;
+        this->event_handler(this->event_handler_arg, key, event);
+    }
+}
+
+bool key_matrix_t::is_pressed(uint8_t key) const
+{
+    if (key >= key_matrix_t::MAX_KEYS_NUM) {
+        return false;
+    }
+
+    return (this->debounced & BIT64(key)) != 0;
+}
+
+uint64_t key_matrix_t::get_pressed_keys() const
+{
+    return this->debounced;
+}
+
+uint64_t key_matrix_t::sample()
+{
+    uint64_t raw = 0;
+    size_t shift = 0;
+
+    for (auto &row : this->rows) {
+        row.set();
+        k_busy_wait(this->settle_us);
+
+        raw |= static_cast<uint64_t>(this->sample_cols()) << shift;
+
+        row.reset();
+        shift += this->cols.size();
+    }
+
+    return raw;
+}
+
+uint32_t key_matrix_t::sample_cols()
+{
+    const uint32_t cols_mask = BIT(this->cols.size()) - 1U;
+    gpio_port_value_t snapshots[key_matrix_t::MAX_COLS_NUM] = {};
+
+    if (this->is_cols_contiguous) {
+        if (!this->cols[0].read_port_state(snapshots[0])) {
+            return 0;
+        }
+
+        uint32_t bits = (snapshots[0] >> this->cols[0].get_pin()) & cols_mask;
+        return this->cols[0].get_is_active_low() ? (bits ^ cols_mask) : bits;
+    }
+
+    /* Read every involved GPIO Port once */
+    for (size_t i = 0; i < this->cols_ports.size(); ++i) {
+        if (gpio_port_get_raw(this->cols_ports[i], &snapshots[i]) < 0) {
+            return 0;
+        }
+    }
+
+    uint32_t bits = 0;
+    for (size_t i = 0; i < this->cols.size(); ++i) {
+        uint32_t level = (snapshots[this->cols_port_idx[i]] >> this->cols[i].get_pin()) & 1U;
+        bits |= (level ^ (this->cols[i].get_is_active_low() ? 1U : 0U)) << i;
+    }
+
+    return bits;
+}
@@ -0,0 +1,165 @@
+/**
+ * @file           : led_pattern.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : LED pattern closed-form evaluator
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include "drivers/led_pattern.hpp"
+
+#include <algorithm>
+
+#include "core/hot_path.hpp"
+
+using namespace drivers;
+
+led_pattern_t led_pattern_t::solid(bool is_on, int64_t start_ms, uint32_t duration_ms)
+{
+    led_pattern_t pattern;
+
+    pattern.start_ms = start_ms;
+    pattern.on_ms = duration_ms;
+    pattern.off_ms = 0;
+    pattern.pend_ms = 0;
+    pattern.blinks_num = 0;
+    pattern.is_solid = true;
+    pattern.is_solid_on = is_on;
+
+    return pattern;
+}
+
+led_pattern_t led_pattern_t::blink(int64_t start_ms, uint32_t on_ms, uint32_t off_ms, size_t blinks_num,
+                                       uint32_t pend_ms)
+{
+    led_pattern_t pattern;
+
+    pattern.start_ms = start_ms;
+    pattern.on_ms = on_ms;
+    pattern.off_ms = off_ms;
+    pattern.pend_ms = pend_ms;
+    pattern.blinks_num = blinks_num;
+    pattern.is_solid = false;
+    pattern.is_solid_on = false;
+
+    return pattern;
+}
+
+FW_HOT bool led_pattern_t::is_on_at(int64_t time_ms) const
+{
+    if (!this->is_active_at(time_ms)) {
+        return false;
+    }
+
+    if (this->is_solid) {
+        return this->is_solid_on;
+    }
+
+    int64_t elapsed_ms = time_ms - this->start_ms - this->pend_ms;
+    if ((elapsed_ms < 0) || (this->on_ms == 0)) {
+        return false;
+    }
+
+    /* phase = (t - t0) mod period, blinks past the last one are cut by end_ms() */
+    int64_t period_ms = static_cast<int64_t>(this->on_ms) + this->off_ms;
+    return (elapsed_ms % period_ms) < this->on_ms;
+}
+
+FW_HOT bool led_pattern_t::is_active_at(int64_t time_ms) const
+{
+    return time_ms < this->end_ms();
+}
+
+FW_HOT int64_t led_pattern_t::end_ms() const
+{
+    if (this->is_solid) {
+        return (this->on_ms == led_pattern_t::SOLID_FOREVER) ? led_pattern_t::NO_TRANSITION
+                                                             : (this->start_ms + this->on_ms);
+    }
+
+    if (this->blinks_num == led_pattern_t::BLINK_FOREVER) {
+        return led_pattern_t::NO_TRANSITION;
+    }
+
+    int64_t period_ms = static_cast<int64_t>(this->on_ms) + this->off_ms;
+    return this->start_ms + this->pend_ms + static_cast<int64_t>(this->blinks_num) * period_ms;
+}
+
+FW_HOT int64_t led_pattern_t::next_transition_ms(int64_t now_ms) const
+{
+    int64_t end_ms = this->end_ms();
+    if (now_ms >= end_ms) {
+        return led_pattern_t::NO_TRANSITION;
+    }
+
+    if (this->is_solid || (this->on_ms == 0)) {
+        return end_ms;
+    }
+
+    int64_t begin_ms = this->start_ms + this->pend_ms;
+    if (now_ms < begin_ms) {
+        return begin_ms;
+    }
+
+    /* End of ON period or end of OFF period, the last one is the pattern end */
+    int64_t period_ms = static_cast<int64_t>(this->on_ms) + this->off_ms;
+    int64_t phase_ms = (now_ms - begin_ms) % period_ms;
+    int64_t next_ms = (phase_ms < this->on_ms) ? (now_ms + (this->on_ms - phase_ms))
+                                               : (now_ms + (period_ms - phase_ms));
+
+    return std::min(next_ms, end_ms);
+}
+
+led_pattern_t led_pattern_t::shifted(int64_t offset_ms) const
+{
+    led_pattern_t pattern = *this;
+    pattern.start_ms += offset_ms;
+    return pattern;
+}
+
+led_pattern_record_t led_pattern_t::to_record() const
+{
+    led_pattern_record_t record = {};
+
+    record.start_ms = this->start_ms;
+    record.on_ms = this->on_ms;
+    record.off_ms = this->off_ms;
+    record.pend_ms = this->pend_ms;
+    record.blinks_num = (this->blinks_num == led_pattern_t::BLINK_FOREVER) ? UINT32_MAX
+                                                                           : static_cast<uint32_t>(this->blinks_num);
+    record.flags = (this->is_solid ? led_pattern_t::RECORD_SOLID : 0U) |
+                   (this->is_solid_on ? led_pattern_t::RECORD_SOLID_ON : 0U);
+
+    return record;
+}
+
+led_pattern_t led_pattern_t::from_record(const led_pattern_record_t &record)
+{
+    led_pattern_t pattern;
+
+    pattern.start_ms = record.start_ms;
+    pattern.on_ms = record.on_ms;
+    pattern.off_ms = record.off_ms;
+    pattern.pend_ms = record.pend_ms;
+    pattern.blinks_num = (record.blinks_num == UINT32_MAX) ? led_pattern_t::BLINK_FOREVER : record.blinks_num;
+    pattern.is_solid = (record.flags & led_pattern_t::RECORD_SOLID) != 0;
+    pattern.is_solid_on = (record.flags & led_pattern_t::RECORD_SOLID_ON) != 0;
+
+    return pattern;
+}
@@ -0,0 +1,213 @@
+/**
+ * @file           : led_strip.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Addressable RGB LED strip driver
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include "drivers/led_strip.hpp"
+
+#include <algorithm>
+
+using namespace drivers;
+
+namespace
+{
+
+/**
+ * @brief           Expand a color byte into 4 SPI bytes, MSB first
+ * @details         Every WS2812 bit becomes a nibble: `1110` for `1`, `1000` for `0`.
+ *                      The word is stored so that the first SPI byte is at the
+ *                      lowest address on a little-endian CPU
+ */
+constexpr uint32_t expand_byte(uint8_t byte)
+{
+    uint32_t spi_bits = 0;
+    for (int bit = 7; bit >= 0; --bit) {
+        spi_bits = (spi_bits << 4U) | ((((byte >> bit) & 1U) != 0) ? 0xEU : 0x8U);
+    }
+
+    return __builtin_bswap32(spi_bits);
+}
+
+constexpr std::array<uint32_t, 256> make_expand_lut()
+{
+    std::array<uint32_t, 256> lut = {};
+    for (size_t i = 0; i < lut.size(); ++i) {
+        lut[i] = expand_byte(static_cast<uint8_t>(i));
+    }
+
+    return lut;
+}
+
+constexpr std::array<uint32_t, 256> EXPAND_LUT = make_expand_lut();
+
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "Expansion table assumes little-endian CPU");
+static_assert(EXPAND_LUT[0x80] == 0x888888E8U, "Unexpected WS2812 symbols encoding");
+
+} // namespace
+
+led_strip_t::led_strip_t(const device_t *spi_dev, size_t pixels_num)
+    : spi_dev{spi_dev}, spi_cfg{}, pixels(pixels_num, rgb_t{0, 0, 0}), is_dirty{true},
+      buffers_lock{}, sending_idx{led_strip_t::NO_BUFFER}, ready_idx{led_strip_t::NO_BUFFER},
+      sent_frames_num{0}, dropped_frames_num{0}
+{
+    /* Reset tail stays zero, so MOSI is LOW long enough to latch the frame */
+    for (auto &buffer : this->tx_buffers) {
+        buffer.assign(3U * pixels_num + led_strip_t::RESET_WORDS_NUM, 0);
+    }
+
+    this->spi_cfg.frequency = led_strip_t::SPI_FREQUENCY_HZ;
+    this->spi_cfg.operation = SPI_OP_MODE_MASTER | SPI_WORD_SET(8) | SPI_TRANSFER_MSB;
+}
+
+bool led_strip_t::init(k_thread_stack_t *stack_ptr, size_t stack_size, int prio)
+{
+    if (!device_is_ready(this->spi_dev)) {
+        return false;
+    }
+
+    k_sem_init(&this->frame_sem, 0, 1);
+
+    k_tid_t tid = k_thread_create(&this->thread, stack_ptr, stack_size, led_strip_t::sender_thread,
+                                  this, nullptr, nullptr, prio, 0, K_NO_WAIT);
+    k_thread_name_set(tid, "led_strip");
+
+    return true;
+}
+
+size_t led_strip_t::get_pixels_num() const
+{
+    return this->pixels.size();
+}
+
+void led_strip_t::set_pixel(size_t idx, rgb_t color)
+{
+    if (idx < this->pixels.size()) {
+        this->pixels[idx] = color;
+        this->is_dirty = true;
+    }
+}
+
+rgb_t led_strip_t::get_pixel(size_t idx) const
+{
+    return (idx < this->pixels.size()) ? this->pixels[idx] : rgb_t{0, 0, 0};
+}
+
+void led_strip_t::fill(size_t first, size_t count, rgb_t color)
+{
+    if (first >= this->pixels.size()) {
+        return;
+    }
+
+    count = std::min(count, this->pixels.size() - first);
+    std::fill_n(this->pixels.begin() + first, count, color);
+    this->is_dirty = true;
+}
+
+void led_strip_t::show()
+{
+    /* Pick the buffer not owned by SPI DMA, an unsent queued frame is superseded */
+    k_spinlock_key_t key = k_spin_lock(&this->buffers_lock);
+    int target_idx = (this->sending_idx == 0) ? 1 : 0;
+    if (this->ready_idx != led_strip_t::NO_BUFFER) {
+        this->ready_idx = led_strip_t::NO_BUFFER;
+        ++this->dropped_frames_num;
+    }
+    k_spin_unlock(&this->buffers_lock, key);
+
+    led_strip_t::encode(this->pixels.data(), this->pixels.size(), this->tx_buffers[target_idx].data());
+    this->is_dirty = false;
+
+    key = k_spin_lock(&this->buffers_lock);
+    this->ready_idx = target_idx;
+    k_spin_unlock(&this->buffers_lock, key);
+
+    k_sem_give(&this->frame_sem);
+}
+
+bool led_strip_t::refresh()
+{
+    if (!this->is_dirty) {
+        return false;
+    }
+
+    this->show();
+    return true;
+}
+
+uint32_t led_strip_t::get_sent_frames_num() const
+{
+    return this->sent_frames_num;
+}
+
+uint32_t led_strip_t::get_dropped_frames_num() const
+{
+    return this->dropped_frames_num;
+}
+
+void led_strip_t::encode(const rgb_t *pixels, size_t pixels_num, uint32_t *out)
+{
+    for (size_t i = 0; i < pixels_num; ++i) {
+        *out++ = EXPAND_LUT[pixels[i].g];
+        *out++ = EXPAND_LUT[pixels[i].r];
+        *out++ = EXPAND_LUT[pixels[i].b];
+    }
+}
+
+void led_strip_t::sender_thread(void *arg1, void *arg2, void *arg3)
+{
+    ARG_UNUSED(arg2);
+    ARG_UNUSED(arg3);
+
+    auto *strip = static_cast<led_strip_t *>(arg1);
+
+    while (true) {
+        k_sem_take(&strip->frame_sem, K_FOREVER);
+
+        k_spinlock_key_t key = k_spin_lock(&strip->buffers_lock);
+        int idx = strip->ready_idx;
+        strip->ready_idx = led_strip_t::NO_BUFFER;
+        strip->sending_idx = idx;
+        k_spin_unlock(&strip->buffers_lock, key);
+
+        if (idx == led_strip_t::NO_BUFFER) {
+            continue;
+        }
+
+        /* Thread sleeps while SPI DMA shifts the frame out */
+        struct spi_buf buf = {
+            .buf = strip->tx_buffers[idx].data(),
+            .len = strip->tx_buffers[idx].size() * sizeof(uint32_t),
+        };
+        const struct spi_buf_set tx = {
+            .buffers = &buf,
+            .count = 1,
+        };
+
+        if (spi_write(strip->spi_dev, &strip->spi_cfg, &tx) == 0) {
+            ++strip->sent_frames_num;
+        }
+
+        key = k_spin_lock(&strip->buffers_lock);
+        strip->sending_idx = led_strip_t::NO_BUFFER;
+        k_spin_unlock(&strip->buffers_lock, key);
+    }
+}
@@ -0,0 +1,176 @@
+/**
+ * @file           : pulse_capture.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Timer input capture driver
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include "drivers/pulse_capture.hpp"
+
+#if defined(CONFIG_SOC_FAMILY_STM32) && defined(CONFIG_DMA)
+#include <zephyr/drivers/dma.h>
+#include <stm32_ll_gpio.h>
+#include <stm32_ll_tim.h>
+
+#include "drivers/stm32_timer.hpp"
+#endif
+
+using namespace drivers;
+
+#if defined(CONFIG_SOC_FAMILY_STM32) && defined(CONFIG_DMA)
+stm32_tim_capture_backend_t::stm32_tim_capture_backend_t(const config_t &config)
+    : config{config}, edges_num{0}, half_handler{nullptr}, half_handler_arg{nullptr}
+{
+}
+
+bool stm32_tim_capture_backend_t::init()
+{
+    uint32_t tim_rate_hz = 0;
+    if (!device_is_ready(this->config.dma_dev) || !stm32_timer_clock_on(this->config.tim_pclken, tim_rate_hz) ||
+        (this->config.tick_hz == 0) || ((tim_rate_hz % this->config.tick_hz) != 0) ||
+        ((tim_rate_hz / this->config.tick_hz) > (UINT16_MAX + 1U))) {
+        return false;
+    }
+
+    /* Free running counter, the prescaler is loaded by the update event */
+    TIM_TypeDef *tim = this->config.tim;
+    LL_TIM_DisableCounter(tim);
+    LL_TIM_SetPrescaler(tim, (tim_rate_hz / this->config.tick_hz) - 1U);
+    LL_TIM_SetAutoReload(tim, this->get_counter_mask());
+    LL_TIM_GenerateEvent_UPDATE(tim);
+
+    LL_TIM_IC_SetActiveInput(tim, LL_TIM_CHANNEL_CH1, LL_TIM_ACTIVEINPUT_DIRECTTI);
+    LL_TIM_IC_SetPrescaler(tim, LL_TIM_CHANNEL_CH1, LL_TIM_ICPSC_DIV1);
+    LL_TIM_IC_SetFilter(tim, LL_TIM_CHANNEL_CH1, this->config.ic_filter);
+    LL_TIM_IC_SetPolarity(tim, LL_TIM_CHANNEL_CH1, LL_TIM_IC_POLARITY_BOTHEDGE);
+
+    /* The input stays readable in alternate function mode, so EXTI keeps working on it */
+    if (this->config.pin <= LL_GPIO_PIN_7) {
+        LL_GPIO_SetAFPin_0_7(this->config.gpio, this->config.pin, this->config.alternate);
+    }
+    else {
+        LL_GPIO_SetAFPin_8_15(this->config.gpio, this->config.pin, this->config.alternate);
+    }
+    LL_GPIO_SetPinMode(this->config.gpio, this->config.pin, LL_GPIO_MODE_ALTERNATE);
+
+    return true;
+}
+
+bool stm32_tim_capture_backend_t::start(uint32_t *buffer, size_t edges_num,
+                                            capture_half_handler_fn half_handler, void *arg)
+{
+    if ((edges_num < 2U) || (edges_num > UINT16_MAX)) {
+        return false;
+    }
+
+    this->edges_num = edges_num;
+    this->half_handler = half_handler;
+    this->half_handler_arg = arg;
+
+    struct dma_block_config block = {};
+    block.source_address = reinterpret_cast<uintptr_t>(&this->config.tim->CCR1);
+    block.dest_address = reinterpret_cast<uintptr_t>(buffer);
+    block.block_size = edges_num * sizeof(uint32_t);
+    block.source_addr_adj = DMA_ADDR_ADJ_NO_CHANGE;
+    block.dest_addr_adj = DMA_ADDR_ADJ_INCREMENT;
+    block.source_reload_en = 1;
+    block.dest_reload_en = 1;
+
+    struct dma_config dma_cfg = {};
+    dma_cfg.dma_slot = this->config.dma_slot;
+    dma_cfg.channel_direction = PERIPHERAL_TO_MEMORY;
+    dma_cfg.channel_priority = 2;
+    dma_cfg.source_data_size = sizeof(uint32_t);
+    dma_cfg.dest_data_size = sizeof(uint32_t);
+    dma_cfg.source_burst_length = 1;
+    dma_cfg.dest_burst_length = 1;
+    dma_cfg.block_count = 1;
+    dma_cfg.head_block = &block;
+    dma_cfg.user_data = this;
+    dma_cfg.dma_callback = stm32_tim_capture_backend_t::dma_callback;
+
+    if ((dma_config(this->config.dma_dev, this->config.dma_stream, &dma_cfg) != 0) ||
+        (dma_start(this->config.dma_dev, this->config.dma_stream) != 0)) {
+        return false;
+    }
+
+    /* Every capture requests a DMA transfer, which also clears the capture flag */
+    TIM_TypeDef *tim = this->config.tim;
+    LL_TIM_SetCounter(tim, 0);
+    LL_TIM_CC_EnableChannel(tim, LL_TIM_CHANNEL_CH1);
+    LL_TIM_EnableDMAReq_CC1(tim);
+    LL_TIM_EnableCounter(tim);
+
+    return true;
+}
+
+void stm32_tim_capture_backend_t::stop()
+{
+    LL_TIM_DisableCounter(this->config.tim);
+    LL_TIM_DisableDMAReq_CC1(this->config.tim);
+    LL_TIM_CC_DisableChannel(this->config.tim, LL_TIM_CHANNEL_CH1);
+    dma_stop(this->config.dma_dev, this->config.dma_stream);
+}
+
+size_t stm32_tim_capture_backend_t::get_write_index()
+{
+    struct dma_status status = {};
+    if (dma_get_status(this->config.dma_dev, this->config.dma_stream, &status) != 0) {
+        return 0;
+    }
+
+    /* STM32 DMA driver reports the NDTR register, i.e. remaining transfers of the pass */
+    return (this->edges_num - status.pending_length) % this->edges_num;
+}
+
+uint32_t stm32_tim_capture_backend_t::get_counter()
+{
+    return LL_TIM_GetCounter(this->config.tim);
+}
+
+uint32_t stm32_tim_capture_backend_t::get_counter_mask()
+{
+    return IS_TIM_32B_COUNTER_INSTANCE(this->config.tim) ? UINT32_MAX : UINT16_MAX;
+}
+
+uint32_t stm32_tim_capture_backend_t::get_tick_hz()
+{
+    return this->config.tick_hz;
+}
+
+bool stm32_tim_capture_backend_t::is_high()
+{
+    return LL_GPIO_IsInputPinSet(this->config.gpio, this->config.pin) != 0;
+}
+
+void stm32_tim_capture_backend_t::dma_callback(const device_t *dev, void *user_data, uint32_t channel, int status)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(channel);
+
+    auto *backend = static_cast<stm32_tim_capture_backend_t *>(user_data);
+    if (status < 0) {
+        return;
+    }
+
+    /* Half transfer is reported as a block, full transfer as completion */
+    backend->half_handler(backend->half_handler_arg, (status == DMA_STATUS_BLOCK) ? 0U : 1U);
+}
+#endif /* defined(CONFIG_SOC_FAMILY_STM32) && defined(CONFIG_DMA) */
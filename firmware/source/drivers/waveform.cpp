@@ -0,0 +1,218 @@
+/**
+ * @file           : waveform.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Timer-triggered DMA GPIO waveform engine
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include "drivers/waveform.hpp"
+
+#include <string.h>
+
+#if defined(CONFIG_SOC_FAMILY_STM32) && defined(CONFIG_DMA)
+#include <zephyr/drivers/dma.h>
+#include <stm32_ll_tim.h>
+
+#include "drivers/stm32_timer.hpp"
+#endif
+
+using namespace drivers;
+using namespace drivers::waveform;
+
+namespace
+{
+
+constexpr uint8_t PORT_PINS_NUM = 16U;
+
+} // namespace
+
+encoder_t::encoder_t(uint32_t *buffer, size_t samples_num)
+    : buffer{buffer}, samples_num{samples_num}
+{
+}
+
+void encoder_t::clear()
+{
+    memset(this->buffer, 0, this->samples_num * sizeof(uint32_t));
+}
+
+bool encoder_t::add_edge(size_t tick, uint8_t pin, bool level)
+{
+    if ((tick >= this->samples_num) || (pin >= PORT_PINS_NUM)) {
+        return false;
+    }
+
+    /* Reset bits take precedence over set bits in BSRR, so drop the opposite request */
+    const uint32_t set_bit = BIT(pin);
+    const uint32_t reset_bit = BIT(pin + PORT_PINS_NUM);
+    if (level) {
+        this->buffer[tick] = (this->buffer[tick] & ~reset_bit) | set_bit;
+    }
+    else {
+        this->buffer[tick] = (this->buffer[tick] & ~set_bit) | reset_bit;
+    }
+
+    return true;
+}
+
+bool encoder_t::add_pulses(uint8_t pin, size_t start_tick, size_t width_ticks, size_t period_ticks,
+                               size_t pulses_num)
+{
+    if ((width_ticks == 0) || (width_ticks >= period_ticks) || (pulses_num == 0)) {
+        return false;
+    }
+
+    const size_t last_fall_tick = start_tick + (pulses_num - 1) * period_ticks + width_ticks;
+    if ((pin >= PORT_PINS_NUM) || (last_fall_tick >= this->samples_num)) {
+        return false;
+    }
+
+    for (size_t i = 0; i < pulses_num; ++i) {
+        const size_t rise_tick = start_tick + i * period_ticks;
+        this->add_edge(rise_tick, pin, true);
+        this->add_edge(rise_tick + width_ticks, pin, false);
+    }
+
+    return true;
+}
+
+const uint32_t *encoder_t::data() const
+{
+    return this->buffer;
+}
+
+size_t encoder_t::size() const
+{
+    return this->samples_num;
+}
+
+uint16_t encoder_t::apply(uint16_t odr, size_t ticks_num) const
+{
+    for (size_t i = 0; (this->samples_num != 0) && (i < ticks_num); ++i) {
+        const uint32_t word = this->buffer[i % this->samples_num];
+        odr = static_cast<uint16_t>((odr | (word & 0xFFFFU)) & ~(word >> PORT_PINS_NUM));
+    }
+
+    return odr;
+}
+
+#if defined(CONFIG_SOC_FAMILY_STM32) && defined(CONFIG_DMA)
+stm32_tim_dma_backend_t::stm32_tim_dma_backend_t(const config_t &config)
+    : config{config}, is_running{false}, is_circular{false}
+{
+}
+
+bool stm32_tim_dma_backend_t::init()
+{
+    uint32_t tim_rate = 0;
+    if (!device_is_ready(this->config.dma_dev) || !stm32_timer_clock_on(this->config.tim_pclken, tim_rate)) {
+        return false;
+    }
+
+    const uint64_t tick_cycles = (static_cast<uint64_t>(tim_rate) * this->config.tick_ns) / NSEC_PER_SEC;
+    if ((tick_cycles == 0) || (tick_cycles > (UINT16_MAX + 1ULL))) {
+        return false;
+    }
+
+    TIM_TypeDef *tim = this->config.tim;
+    LL_TIM_DisableCounter(tim);
+    LL_TIM_DisableDMAReq_UPDATE(tim);
+    LL_TIM_SetPrescaler(tim, 0);
+    LL_TIM_SetAutoReload(tim, static_cast<uint32_t>(tick_cycles - 1));
+    LL_TIM_EnableARRPreload(tim);
+    LL_TIM_SetUpdateSource(tim, LL_TIM_UPDATESOURCE_COUNTER);
+    LL_TIM_GenerateEvent_UPDATE(tim);
+
+    return true;
+}
+
+bool stm32_tim_dma_backend_t::start(const uint32_t *buffer, size_t samples_num, play_mode_t mode)
+{
+    if (this->is_running || (samples_num == 0) || (samples_num > UINT16_MAX)) {
+        return false;
+    }
+
+    this->is_circular = (mode == play_mode_t::Circular);
+
+    struct dma_block_config block = {};
+    block.source_address = reinterpret_cast<uintptr_t>(buffer);
+    block.dest_address = reinterpret_cast<uintptr_t>(&this->config.gpio->BSRR);
+    block.block_size = samples_num * sizeof(uint32_t);
+    block.source_addr_adj = DMA_ADDR_ADJ_INCREMENT;
+    block.dest_addr_adj = DMA_ADDR_ADJ_NO_CHANGE;
+    block.source_reload_en = this->is_circular ? 1 : 0;
+    block.dest_reload_en = this->is_circular ? 1 : 0;
+
+    struct dma_config dma_cfg = {};
+    dma_cfg.dma_slot = this->config.dma_slot;
+    dma_cfg.channel_direction = MEMORY_TO_PERIPHERAL;
+    dma_cfg.channel_priority = 3;
+    dma_cfg.source_data_size = sizeof(uint32_t);
+    dma_cfg.dest_data_size = sizeof(uint32_t);
+    dma_cfg.source_burst_length = 1;
+    dma_cfg.dest_burst_length = 1;
+    dma_cfg.block_count = 1;
+    dma_cfg.head_block = &block;
+    dma_cfg.user_data = this;
+    dma_cfg.dma_callback = stm32_tim_dma_backend_t::dma_callback;
+
+    if ((dma_config(this->config.dma_dev, this->config.dma_stream, &dma_cfg) != 0) ||
+        (dma_start(this->config.dma_dev, this->config.dma_stream) != 0)) {
+        return false;
+    }
+
+    /* From here on every update event moves one word, no CPU involvement until the end */
+    this->is_running = true;
+    TIM_TypeDef *tim = this->config.tim;
+    LL_TIM_SetCounter(tim, 0);
+    LL_TIM_EnableDMAReq_UPDATE(tim);
+    LL_TIM_EnableCounter(tim);
+
+    return true;
+}
+
+void stm32_tim_dma_backend_t::stop()
+{
+    LL_TIM_DisableCounter(this->config.tim);
+    LL_TIM_DisableDMAReq_UPDATE(this->config.tim);
+    dma_stop(this->config.dma_dev, this->config.dma_stream);
+    this->is_running = false;
+}
+
+bool stm32_tim_dma_backend_t::is_busy()
+{
+    return this->is_running;
+}
+
+void stm32_tim_dma_backend_t::dma_callback(const device_t *dev, void *user_data, uint32_t channel, int status)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(channel);
+
+    auto *self = static_cast<stm32_tim_dma_backend_t *>(user_data);
+    if (self->is_circular && (status >= 0)) {
+        return;
+    }
+
+    LL_TIM_DisableCounter(self->config.tim);
+    LL_TIM_DisableDMAReq_UPDATE(self->config.tim);
+    self->is_running = false;
+}
+#endif /* defined(CONFIG_SOC_FAMILY_STM32) && defined(CONFIG_DMA) */
@@ -0,0 +1,182 @@
+/**
+ * @file           : sim_harness.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : native_sim waveform recorder and input stimulus
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include "sim/sim_harness.hpp"
+
+#include <stdlib.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+
+using namespace sim;
+
+sim_harness_t::sim_harness_t()
+    : probes{
+          {GPIO_DT_SPEC_GET(DT_ALIAS(led0), gpios), "orange_led", -1},
+          {GPIO_DT_SPEC_GET(DT_ALIAS(led1), gpios), "green_led", -1},
+          {GPIO_DT_SPEC_GET(DT_ALIAS(led2), gpios), "red_led", -1},
+          {GPIO_DT_SPEC_GET(DT_ALIAS(led3), gpios), "blue_led", -1},
+          {GPIO_DT_SPEC_GET(DT_ALIAS(sw0), gpios), "user_button", -1},
+      },
+      probes_num{5},
+      steps{}, steps_num{0}, step_idx{0}, repeat_period_ms{0}, sequence_start_ms{0},
+      button_spec{GPIO_DT_SPEC_GET(DT_ALIAS(sw0), gpios)}
+{
+    k_timer_init(&this->sample_timer, sim_harness_t::sample_timer_expiry, nullptr);
+    k_timer_init(&this->stimulus_timer, sim_harness_t::stimulus_timer_expiry, nullptr);
+}
+
+sim_harness_t &sim_harness_t::get_instance()
+{
+    static sim_harness_t sim_harness{};
+    return sim_harness;
+}
+
+bool sim_harness_t::init()
+{
+    for (size_t i = 0; i < this->probes_num; ++i) {
+        if (!device_is_ready(this->probes[i].spec.port)) {
+            return false;
+        }
+    }
+
+    if (!this->parse_stimulus()) {
+        return false;
+    }
+
+    printk("vcd: $timescale 1 ms $end\n");
+    printk("vcd: $scope module firmware $end\n");
+    for (size_t i = 0; i < this->probes_num; ++i) {
+        printk("vcd: $var wire 1 %c %s $end\n", static_cast<char>('!' + i), this->probes[i].name);
+    }
+    printk("vcd: $upscope $end\n");
+    printk("vcd: $enddefinitions $end\n");
+
+    k_timer_start(&this->sample_timer, K_NO_WAIT, K_MSEC(CONFIG_APP_SIM_SAMPLE_PERIOD_MS));
+
+    if (this->steps_num != 0) {
+        this->step_idx = 0;
+        this->sequence_start_ms = k_uptime_get();
+        this->schedule_stimulus();
+    }
+
+    return true;
+}
+
+bool sim_harness_t::parse_stimulus()
+{
+    const char *str = CONFIG_APP_SIM_STIMULUS;
+    char *end = nullptr;
+
+    this->steps_num = 0;
+    this->repeat_period_ms = 0;
+
+    while ((*str != '\0') && (*str != ';')) {
+        if (this->steps_num == sim_harness_t::MAX_STEPS_NUM) {
+            return false;
+        }
+
+        step_t &step = this->steps[this->steps_num];
+        step.time_ms = strtoul(str, &end, 10);
+        if ((end == str) || (*end != ':')) {
+            return false;
+        }
+        if ((this->steps_num != 0) && (step.time_ms < this->steps[this->steps_num - 1].time_ms)) {
+            return false;
+        }
+
+        str = end + 1;
+        step.level = static_cast<int>(strtoul(str, &end, 10));
+        if ((end == str) || (step.level > 1)) {
+            return false;
+        }
+        ++this->steps_num;
+
+        str = end;
+        if (*str == ',') {
+            ++str;
+        }
+    }
+
+    if (*str == ';') {
+        ++str;
+        this->repeat_period_ms = strtoul(str, &end, 10);
+        if ((end == str) || (*end != '\0')) {
+            return false;
+        }
+        if ((this->steps_num != 0) && (this->repeat_period_ms <= this->steps[this->steps_num - 1].time_ms)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void sim_harness_t::schedule_stimulus()
+{
+    int64_t deadline_ms = this->sequence_start_ms + this->steps[this->step_idx].time_ms;
+    k_timer_start(&this->stimulus_timer, K_TIMEOUT_ABS_MS(deadline_ms), K_NO_WAIT);
+}
+
+void sim_harness_t::sample_timer_expiry(k_timer *timer)
+{
+    sim_harness_t *instance_ptr = CONTAINER_OF(timer, sim_harness_t, sample_timer);
+    bool is_time_printed = false;
+
+    for (size_t i = 0; i < instance_ptr->probes_num; ++i) {
+        probe_t &probe = instance_ptr->probes[i];
+
+        int level = (gpio_pin_is_output(probe.spec.port, probe.spec.pin) == 1)
+                        ? gpio_emul_output_get(probe.spec.port, probe.spec.pin)
+                        : gpio_pin_get_raw(probe.spec.port, probe.spec.pin);
+        if ((level < 0) || (level == probe.level)) {
+            continue;
+        }
+
+        if (!is_time_printed) {
+            printk("vcd: #%u\n", k_uptime_get_32());
+            is_time_printed = true;
+        }
+        printk("vcd: %d%c\n", level, static_cast<char>('!' + i));
+        probe.level = level;
+    }
+}
+
+void sim_harness_t::stimulus_timer_expiry(k_timer *timer)
+{
+    sim_harness_t *instance_ptr = CONTAINER_OF(timer, sim_harness_t, stimulus_timer);
+
+    const step_t &step = instance_ptr->steps[instance_ptr->step_idx];
+    gpio_emul_input_set(instance_ptr->button_spec.port, instance_ptr->button_spec.pin, step.level);
+
+    if (++instance_ptr->step_idx == instance_ptr->steps_num) {
+        if (instance_ptr->repeat_period_ms == 0) {
+            return;
+        }
+
+        instance_ptr->step_idx = 0;
+        instance_ptr->sequence_start_ms += instance_ptr->repeat_period_ms;
+    }
+
+    instance_ptr->schedule_stimulus();
+}
@@ -0,0 +1,183 @@
+/**
+ * @file           : main.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Analog input tests on the ADC emulator
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/adc.h>
+#include <zephyr/drivers/adc/adc_emul.h>
+#include <zephyr/ztest.h>
+
+#include "drivers/analog_input.hpp"
+
+using namespace drivers;
+
+namespace
+{
+
+constexpr size_t BLOCK_SIZE = 8;
+constexpr size_t BLOCKS_NUM = 4;
+constexpr uint32_t SAMPLE_RATE_HZ = 1000;
+
+/* 12-bit codes with exact millivolts at 3300 mV reference */
+constexpr uint32_t CODE_1024_MV = 825;
+constexpr uint32_t CODE_2048_MV = 1650;
+constexpr uint32_t CODE_3072_MV = 2475;
+
+using input_t = analog_input_t<adc_sequence_backend_t, BLOCK_SIZE>;
+
+const struct adc_dt_spec adc_spec = ADC_DT_SPEC_GET(DT_PATH(zephyr_user));
+const device_t *const gpio_dev = DEVICE_DT_GET(DT_NODELABEL(gpio0));
+
+/* Copies of the first handed blocks */
+struct blocks_t
+{
+    const uint16_t *ptrs[BLOCKS_NUM];
+    uint16_t samples[BLOCKS_NUM][BLOCK_SIZE];
+    size_t samples_nums[BLOCKS_NUM];
+    size_t blocks_num;
+    struct k_sem sem;
+};
+
+blocks_t blocks;
+
+void block_handler(void *arg, const uint16_t *samples, size_t samples_num)
+{
+    blocks_t &received = *static_cast<blocks_t *>(arg);
+    if (received.blocks_num >= BLOCKS_NUM) {
+        return;
+    }
+
+    received.ptrs[received.blocks_num] = samples;
+    received.samples_nums[received.blocks_num] = samples_num;
+    memcpy(received.samples[received.blocks_num], samples, samples_num * sizeof(uint16_t));
+    ++received.blocks_num;
+    k_sem_give(&received.sem);
+}
+
+/* Every second sample is the high value */
+struct alternating_t
+{
+    uint32_t low_mv;
+    uint32_t high_mv;
+    uint32_t samples_num;
+};
+
+int alternating_value(const struct device *dev, unsigned int chan, void *data, uint32_t *result)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(chan);
+
+    alternating_t *source = static_cast<alternating_t *>(data);
+    *result = ((source->samples_num++ % 2U) == 0) ? source->low_mv : source->high_mv;
+    return 0;
+}
+
+void wait_blocks(input_t &input)
+{
+    for (size_t i = 0; i < BLOCKS_NUM; ++i) {
+        zassert_equal(k_sem_take(&blocks.sem, K_SECONDS(5)), 0, "block %zu", i);
+    }
+    input.stop();
+
+    /* The sequence in progress is not restarted but runs to its end */
+    k_msleep((2U * BLOCK_SIZE * MSEC_PER_SEC) / SAMPLE_RATE_HZ + 10U);
+}
+
+void analog_input_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    memset(&blocks, 0, sizeof(blocks));
+    k_sem_init(&blocks.sem, 0, BLOCKS_NUM);
+}
+
+}
+
+ZTEST(analog_input, test_ping_pong_delivery)
+{
+    input_t input{gpio_dev, 0, adc_spec};
+    zassert_true(input.init());
+    zassert_ok(adc_emul_const_value_set(adc_spec.dev, adc_spec.channel_id, CODE_2048_MV));
+
+    zassert_true(input.start(SAMPLE_RATE_HZ, block_handler, &blocks));
+    wait_blocks(input);
+
+    /* Halves alternate, every block is handed in place and in full */
+    zassert_not_equal(blocks.ptrs[0], blocks.ptrs[1]);
+    zassert_equal(blocks.ptrs[0] + BLOCK_SIZE, blocks.ptrs[1]);
+    for (size_t i = 0; i < BLOCKS_NUM; ++i) {
+        zassert_equal(blocks.ptrs[i], blocks.ptrs[i % 2U], "block %zu", i);
+        zassert_equal(blocks.samples_nums[i], BLOCK_SIZE, "block %zu", i);
+        for (size_t j = 0; j < BLOCK_SIZE; ++j) {
+            zassert_equal(blocks.samples[i][j], 2048, "block %zu sample %zu", i, j);
+        }
+    }
+    zassert_true(input.get_blocks_num() >= BLOCKS_NUM);
+}
+
+ZTEST(analog_input, test_decimation)
+{
+    input_t input{gpio_dev, 0, adc_spec};
+    zassert_true(input.init());
+
+    /* Pairs of 1024 and 3072 codes average to 2048, pairs of 1024 and 2048 to 1536 */
+    alternating_t source{CODE_1024_MV, CODE_3072_MV, 0};
+    zassert_ok(adc_emul_value_func_set(adc_spec.dev, adc_spec.channel_id, alternating_value, &source));
+
+    zassert_true(input.start(SAMPLE_RATE_HZ, block_handler, &blocks, 2));
+    wait_blocks(input);
+
+    for (size_t i = 0; i < BLOCKS_NUM; ++i) {
+        zassert_equal(blocks.samples_nums[i], BLOCK_SIZE / 2U, "block %zu", i);
+        for (size_t j = 0; j < (BLOCK_SIZE / 2U); ++j) {
+            zassert_equal(blocks.samples[i][j], 2048, "block %zu sample %zu", i, j);
+        }
+    }
+
+    analog_input_before(nullptr);
+    source = {CODE_1024_MV, CODE_2048_MV, 0};
+    zassert_true(input.start(SAMPLE_RATE_HZ, block_handler, &blocks, 4));
+    wait_blocks(input);
+
+    for (size_t i = 0; i < BLOCKS_NUM; ++i) {
+        zassert_equal(blocks.samples_nums[i], BLOCK_SIZE / 4U, "block %zu", i);
+        for (size_t j = 0; j < (BLOCK_SIZE / 4U); ++j) {
+            zassert_equal(blocks.samples[i][j], 1536, "block %zu sample %zu", i, j);
+        }
+    }
+}
+
+ZTEST(analog_input, test_invalid_start)
+{
+    input_t input{gpio_dev, 0, adc_spec};
+    zassert_true(input.init());
+
+    zassert_false(input.start(SAMPLE_RATE_HZ, nullptr, &blocks));
+    zassert_false(input.start(SAMPLE_RATE_HZ, block_handler, &blocks, 0));
+    zassert_false(input.start(SAMPLE_RATE_HZ, block_handler, &blocks, 3));
+    zassert_false(input.start(0, block_handler, &blocks));
+}
+
+ZTEST_SUITE(analog_input, NULL, NULL, analog_input_before, NULL, NULL);
@@ -0,0 +1,210 @@
+/**
+ * @file           : fake_counter.c
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Fake counter with alarm control from tests
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include "fake_counter.h"
+
+#include <errno.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/counter.h>
+
+struct fake_counter_data
+{
+    uint32_t ticks;
+    bool is_running;
+    uint32_t guard_ticks;
+    uint32_t guard_flags;
+    struct counter_alarm_cfg alarm;
+    bool is_alarm_set;
+    bool is_alarm_expired;
+};
+
+static int fake_counter_init(const struct device *dev)
+{
+    ARG_UNUSED(dev);
+
+    return 0;
+}
+
+static int fake_counter_start(const struct device *dev)
+{
+    struct fake_counter_data *data = dev->data;
+
+    data->is_running = true;
+
+    return 0;
+}
+
+static int fake_counter_stop(const struct device *dev)
+{
+    struct fake_counter_data *data = dev->data;
+
+    data->is_running = false;
+
+    return 0;
+}
+
+static int fake_counter_get_value(const struct device *dev, uint32_t *ticks)
+{
+    struct fake_counter_data *data = dev->data;
+
+    *ticks = data->ticks;
+
+    return 0;
+}
+
+/* Absolute alarms only, late ones as the STM32 timer driver detects them */
+static int fake_counter_set_alarm(const struct device *dev, uint8_t chan_id, const struct counter_alarm_cfg *alarm_cfg)
+{
+    ARG_UNUSED(chan_id);
+
+    struct fake_counter_data *data = dev->data;
+
+    if ((alarm_cfg->flags & COUNTER_ALARM_CFG_ABSOLUTE) == 0) {
+        return -ENOTSUP;
+    }
+
+    uint32_t ahead_ticks = (alarm_cfg->ticks - data->ticks) & FAKE_COUNTER_TOP;
+    bool is_late = (data->guard_ticks != 0) && (ahead_ticks > (FAKE_COUNTER_TOP - data->guard_ticks));
+    if (is_late && ((alarm_cfg->flags & COUNTER_ALARM_CFG_EXPIRE_WHEN_LATE) == 0)) {
+        return -ETIME;
+    }
+
+    data->alarm = *alarm_cfg;
+    data->is_alarm_set = true;
+    data->is_alarm_expired = is_late;
+
+    return is_late ? -ETIME : 0;
+}
+
+static int fake_counter_cancel_alarm(const struct device *dev, uint8_t chan_id)
+{
+    ARG_UNUSED(chan_id);
+
+    struct fake_counter_data *data = dev->data;
+
+    data->is_alarm_set = false;
+
+    return 0;
+}
+
+static uint32_t fake_counter_get_top_value(const struct device *dev)
+{
+    ARG_UNUSED(dev);
+
+    return FAKE_COUNTER_TOP;
+}
+
+static int fake_counter_set_guard_period(const struct device *dev, uint32_t ticks, uint32_t flags)
+{
+    struct fake_counter_data *data = dev->data;
+
+    if (ticks > FAKE_COUNTER_TOP) {
+        return -EINVAL;
+    }
+
+    data->guard_ticks = ticks;
+    data->guard_flags = flags;
+
+    return 0;
+}
+
+static const struct counter_driver_api fake_counter_api = {
+    .start = fake_counter_start,
+    .stop = fake_counter_stop,
+    .get_value = fake_counter_get_value,
+    .set_alarm = fake_counter_set_alarm,
+    .cancel_alarm = fake_counter_cancel_alarm,
+    .get_top_value = fake_counter_get_top_value,
+    .set_guard_period = fake_counter_set_guard_period,
+};
+
+static const struct counter_config_info fake_counter_config = {
+    .max_top_value = FAKE_COUNTER_TOP,
+    .freq = FAKE_COUNTER_FREQ_HZ,
+    .flags = COUNTER_CONFIG_INFO_COUNT_UP,
+    .channels = 1,
+};
+
+static struct fake_counter_data fake_counter_data;
+
+DEVICE_DEFINE(fake_counter, "fake_counter", fake_counter_init, NULL, &fake_counter_data, &fake_counter_config,
+              POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEVICE, &fake_counter_api);
+
+const struct device *fake_counter_get(void)
+{
+    return DEVICE_GET(fake_counter);
+}
+
+void fake_counter_reset(const struct device *dev)
+{
+    struct fake_counter_data *data = dev->data;
+
+    *data = (struct fake_counter_data){0};
+}
+
+void fake_counter_set_value(const struct device *dev, uint32_t ticks)
+{
+    struct fake_counter_data *data = dev->data;
+
+    data->ticks = ticks & FAKE_COUNTER_TOP;
+}
+
+uint32_t fake_counter_get_guard_period(const struct device *dev, uint32_t *flags)
+{
+    struct fake_counter_data *data = dev->data;
+
+    *flags = data->guard_flags;
+
+    return data->guard_ticks;
+}
+
+bool fake_counter_get_alarm(const struct device *dev, struct counter_alarm_cfg *cfg, bool *is_expired)
+{
+    struct fake_counter_data *data = dev->data;
+
+    *cfg = data->alarm;
+    *is_expired = data->is_alarm_expired;
+
+    return data->is_alarm_set;
+}
+
+bool fake_counter_fire(const struct device *dev, uint32_t delay_ticks)
+{
+    struct fake_counter_data *data = dev->data;
+
+    if (!data->is_alarm_set) {
+        return false;
+    }
+
+    if (!data->is_alarm_expired) {
+        data->ticks = data->alarm.ticks;
+    }
+    data->ticks = (data->ticks + delay_ticks) & FAKE_COUNTER_TOP;
+    data->is_alarm_set = false;
+
+    /* The handler may set the next alarm */
+    data->alarm.callback(dev, 0, data->ticks, data->alarm.user_data);
+
+    return true;
+}
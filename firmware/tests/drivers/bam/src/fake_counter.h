@@ -0,0 +1,93 @@
+/**
+ * @file           : fake_counter.h
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Fake counter with alarm control from tests
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/counter.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief           Counter frequency
+ */
+#define FAKE_COUNTER_FREQ_HZ        1000000U
+
+/**
+ * @brief           Counter top value, 16-bit like most STM32 timers
+ */
+#define FAKE_COUNTER_TOP            0xFFFFU
+
+/**
+ * @brief           Get counter device
+ */
+const struct device *fake_counter_get(void);
+
+/**
+ * @brief           Clear alarm and guard period, stop counter
+ * @param[in]       dev Counter device
+ */
+void fake_counter_reset(const struct device *dev);
+
+/**
+ * @brief           Set counter value
+ * @param[in]       dev Counter device
+ * @param[in]       ticks Counter value
+ */
+void fake_counter_set_value(const struct device *dev, uint32_t ticks);
+
+/**
+ * @brief           Get guard period
+ * @param[in]       dev Counter device
+ * @param[out]      flags Guard period flags
+ * @return          Guard period in ticks, `0` if not set
+ */
+uint32_t fake_counter_get_guard_period(const struct device *dev, uint32_t *flags);
+
+/**
+ * @brief           Get pending alarm
+ * @param[in]       dev Counter device
+ * @param[out]      cfg Alarm configuration
+ * @param[out]      is_expired `true` if the alarm was set too late and expired right away
+ * @return          `true` if an alarm is pending
+ */
+bool fake_counter_get_alarm(const struct device *dev, struct counter_alarm_cfg *cfg, bool *is_expired);
+
+/**
+ * @brief           Fire pending alarm
+ * @details         Counter jumps to the alarm value plus the delay, an expired
+ *                      alarm fires at the current value
+ * @param[in]       dev Counter device
+ * @param[in]       delay_ticks Interrupt latency in ticks
+ * @return          `true` if an alarm was pending
+ */
+bool fake_counter_fire(const struct device *dev, uint32_t delay_ticks);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,170 @@
+/**
+ * @file           : main.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Bit-angle modulation engine tests on a fake counter
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/counter.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/ztest.h>
+
+#include "drivers/bam.hpp"
+#include "fake_counter.h"
+
+using namespace drivers;
+
+namespace
+{
+
+constexpr uint8_t HIGH_PIN = 3;
+constexpr uint8_t LOW_PIN = 4;
+
+/* 1 MHz / (100 Hz * 255 units) */
+constexpr uint32_t UNIT_TICKS = 39;
+
+const device_t *const gpio_dev = DEVICE_DT_GET(DT_NODELABEL(gpio0));
+
+/* Pending alarm is set in time at `ticks` */
+void check_alarm(uint32_t ticks)
+{
+    struct counter_alarm_cfg cfg = {};
+    bool is_expired = true;
+    zassert_true(fake_counter_get_alarm(fake_counter_get(), &cfg, &is_expired));
+    zassert_false(is_expired);
+    zassert_equal(cfg.ticks, ticks);
+    zassert_equal(cfg.flags, COUNTER_ALARM_CFG_ABSOLUTE | COUNTER_ALARM_CFG_EXPIRE_WHEN_LATE);
+}
+
+void bam_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    fake_counter_reset(fake_counter_get());
+}
+
+}
+
+ZTEST(bam, test_init)
+{
+    const device_t *counter_dev = fake_counter_get();
+    fake_counter_set_value(counter_dev, 1000);
+
+    bam_engine_t engine{counter_dev};
+    size_t channel = 0;
+    zassert_true(engine.add_channel(gpio_dev, HIGH_PIN, false, channel));
+    zassert_true(engine.init());
+    zassert_equal(engine.get_frame_rate_hz(), 100);
+
+    /* Guard period is set before the first alarm */
+    uint32_t guard_flags = 0;
+    zassert_equal(fake_counter_get_guard_period(counter_dev, &guard_flags), FAKE_COUNTER_TOP / 2U);
+    zassert_equal(guard_flags, COUNTER_GUARD_PERIOD_LATE_TO_SET);
+
+    check_alarm(1000 + UNIT_TICKS);
+    zassert_equal(gpio_emul_output_get(gpio_dev, HIGH_PIN), 0);
+}
+
+ZTEST(bam, test_planes)
+{
+    const device_t *counter_dev = fake_counter_get();
+
+    /* The frame wraps the counter */
+    uint32_t alarm_ticks = FAKE_COUNTER_TOP - 100U;
+    fake_counter_set_value(counter_dev, alarm_ticks);
+
+    bam_engine_t engine{counter_dev};
+    size_t high_channel = 0;
+    size_t low_channel = 0;
+    zassert_true(engine.add_channel(gpio_dev, HIGH_PIN, false, high_channel));
+    zassert_true(engine.add_channel(gpio_dev, LOW_PIN, true, low_channel));
+    zassert_true(engine.init());
+    zassert_equal(gpio_emul_output_get(gpio_dev, LOW_PIN), 1);
+
+    constexpr uint8_t BRIGHTNESS = 0xA5;
+    engine.set_brightness(high_channel, BRIGHTNESS);
+    engine.set_brightness(low_channel, BRIGHTNESS);
+    zassert_equal(engine.get_brightness(high_channel), BRIGHTNESS);
+
+    alarm_ticks += UNIT_TICKS;
+    for (size_t plane = 0; plane < bam_engine_t::BITS_NUM; ++plane) {
+        zassert_true(fake_counter_fire(counter_dev, 0));
+
+        int level = ((BRIGHTNESS & BIT(plane)) != 0) ? 1 : 0;
+        zassert_equal(gpio_emul_output_get(gpio_dev, HIGH_PIN), level, "plane %zu", plane);
+        zassert_equal(gpio_emul_output_get(gpio_dev, LOW_PIN), 1 - level, "plane %zu", plane);
+
+        /* Plane n lasts 2^n units */
+        alarm_ticks = (alarm_ticks + (UNIT_TICKS << plane)) & FAKE_COUNTER_TOP;
+        check_alarm(alarm_ticks);
+    }
+    zassert_equal(engine.get_late_alarms_num(), 0);
+}
+
+ZTEST(bam, test_late_alarm)
+{
+    const device_t *counter_dev = fake_counter_get();
+    fake_counter_set_value(counter_dev, 0);
+
+    bam_engine_t engine{counter_dev};
+    size_t channel = 0;
+    zassert_true(engine.add_channel(gpio_dev, HIGH_PIN, false, channel));
+    zassert_true(engine.init());
+    zassert_true(fake_counter_fire(counter_dev, 0));
+
+    /* The interrupt comes after the next plane should have started */
+    zassert_true(fake_counter_fire(counter_dev, 3U * UNIT_TICKS));
+    struct counter_alarm_cfg cfg = {};
+    bool is_expired = false;
+    zassert_true(fake_counter_get_alarm(counter_dev, &cfg, &is_expired));
+    zassert_true(is_expired);
+    zassert_equal(engine.get_late_alarms_num(), 1);
+
+    /* The expired alarm restarts the schedule instead of waiting for a counter wrap */
+    uint32_t now_ticks = 0;
+    zassert_ok(counter_get_value(counter_dev, &now_ticks));
+    zassert_true(fake_counter_fire(counter_dev, 0));
+    check_alarm(now_ticks + (UNIT_TICKS << 2U));
+    zassert_equal(engine.get_late_alarms_num(), 1);
+}
+
+ZTEST(bam, test_min_plane)
+{
+    const device_t *counter_dev = fake_counter_get();
+    fake_counter_set_value(counter_dev, 0);
+
+    /* 1 MHz / (1 kHz * 255 units) leaves 3 ticks for the shortest plane */
+    bam_engine_t engine{counter_dev, 1000U};
+    zassert_true(engine.init());
+    check_alarm(CONFIG_APP_BAM_MIN_PLANE_US);
+    zassert_equal(engine.get_frame_rate_hz(), FAKE_COUNTER_FREQ_HZ / (CONFIG_APP_BAM_MIN_PLANE_US * 255U));
+}
+
+ZTEST(bam, test_frame_too_long)
+{
+    /* The longest plane must fit the guard period of the 16-bit counter */
+    bam_engine_t engine{fake_counter_get(), 1U};
+    zassert_false(engine.init());
+}
+
+ZTEST_SUITE(bam, NULL, NULL, bam_before, NULL, NULL);
@@ -0,0 +1,255 @@
+/**
+ * @file           : main.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : I2C scheduler tests on a register file emulator
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/ztest.h>
+
+#include "drivers/i2c_scheduler.hpp"
+#include "reg_file_emul.h"
+
+using namespace drivers;
+
+namespace
+{
+
+/* LSM303DLHC accelerometer registers */
+constexpr uint8_t CTRL_REG1 = 0x20;
+constexpr uint8_t STATUS_REG = 0x27;
+constexpr uint8_t OUT_X_L = 0x28;
+constexpr uint8_t OUT_Y_L = 0x2A;
+constexpr uint8_t OUT_Z_L = 0x2C;
+
+constexpr uint8_t AUTO_INC = REG_FILE_EMUL_AUTO_INC;
+constexpr uint16_t ADDR = DT_REG_ADDR(DT_NODELABEL(reg_file));
+
+/* Marks a request, which has not completed yet */
+constexpr int NOT_DONE = 1;
+
+K_THREAD_STACK_DEFINE(scheduler_stack, 1024);
+i2c_scheduler_t scheduler{DEVICE_DT_GET(DT_BUS(DT_NODELABEL(reg_file)))};
+
+const struct emul *const target = EMUL_DT_GET(DT_NODELABEL(reg_file));
+
+bool is_scheduler_ready;
+struct k_sem done_sem;
+
+void done_cb(int result, void *arg)
+{
+    *static_cast<int *>(arg) = result;
+    k_sem_give(&done_sem);
+}
+
+void wait_done(size_t requests_num)
+{
+    for (size_t i = 0; i < requests_num; ++i) {
+        zassert_equal(k_sem_take(&done_sem, K_SECONDS(1)), 0, "request %zu", i);
+    }
+}
+
+/* Queues STATUS, OUT_X, OUT_Y and OUT_Z reads in one batch */
+struct accel_read_t
+{
+    i2c_request_t requests[4];
+    uint8_t status;
+    uint8_t out[3][2];
+    int results[4];
+
+    size_t submit()
+    {
+        memset(this->out, 0xEE, sizeof(this->out));
+        this->status = 0xEE;
+        for (int &result : this->results) {
+            result = NOT_DONE;
+        }
+
+        /* The scheduler thread takes the batch after all requests are queued */
+        const uint8_t regs[] = {STATUS_REG, OUT_X_L, OUT_Y_L, OUT_Z_L};
+        uint8_t *bufs[] = {&this->status, this->out[0], this->out[1], this->out[2]};
+        size_t queued_num = 0;
+
+        k_sched_lock();
+        for (size_t i = 0; i < ARRAY_SIZE(regs); ++i) {
+            size_t len = (i == 0) ? 1U : 2U;
+            if (scheduler.read_regs(this->requests[i], ADDR, regs[i], bufs[i], len, AUTO_INC,
+                                    done_cb, &this->results[i])) {
+                ++queued_num;
+            }
+        }
+        k_sched_unlock();
+
+        return queued_num;
+    }
+};
+
+void *i2c_scheduler_setup()
+{
+    k_sem_init(&done_sem, 0, 16);
+    is_scheduler_ready = scheduler.init(scheduler_stack, K_THREAD_STACK_SIZEOF(scheduler_stack), K_PRIO_PREEMPT(1));
+    return nullptr;
+}
+
+void i2c_scheduler_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    zassert_true(is_scheduler_ready);
+    reg_file_emul_reset(target);
+    k_sem_reset(&done_sem);
+    scheduler.reset_stats();
+}
+
+}
+
+ZTEST(i2c_scheduler, test_status_and_axes_merge)
+{
+    const uint8_t regs[] = {0x0F, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06};
+    reg_file_emul_set_regs(target, STATUS_REG, regs, sizeof(regs));
+
+    accel_read_t read;
+    zassert_equal(read.submit(), 4);
+    wait_done(4);
+
+    /* One auto-increment burst from STATUS to OUT_Z_H */
+    zassert_equal(reg_file_emul_get_transfers_num(target), 1);
+    reg_file_emul_transfer transfer = reg_file_emul_get_transfer(target, 0);
+    zassert_equal(transfer.reg, STATUS_REG | AUTO_INC);
+    zassert_equal(transfer.len, 7);
+    zassert_false(transfer.is_write);
+
+    for (int result : read.results) {
+        zassert_equal(result, 0);
+    }
+    zassert_equal(read.status, 0x0F);
+    zassert_mem_equal(read.out, &regs[1], sizeof(read.out));
+
+    i2c_bus_stats_t stats = scheduler.get_stats();
+    zassert_equal(stats.requests, 4);
+    zassert_equal(stats.transactions, 1);
+    zassert_equal(stats.merged, 3);
+    zassert_equal(stats.errors, 0);
+    zassert_equal(stats.bytes, 7);
+}
+
+ZTEST(i2c_scheduler, test_no_merge_across_write)
+{
+    const uint8_t regs[] = {0x01, 0x02, 0x03, 0x04};
+    reg_file_emul_set_regs(target, OUT_X_L, regs, sizeof(regs));
+
+    i2c_request_t requests[3];
+    uint8_t out_x[2] = {};
+    uint8_t out_y[2] = {0xAA, 0xBB};
+    uint8_t out_y_read[2] = {};
+    int results[3] = {NOT_DONE, NOT_DONE, NOT_DONE};
+
+    k_sched_lock();
+    bool is_queued = scheduler.read_regs(requests[0], ADDR, OUT_X_L, out_x, 2U, AUTO_INC, done_cb, &results[0]);
+    is_queued = scheduler.write_regs(requests[1], ADDR, OUT_Y_L, out_y, 2U, AUTO_INC, done_cb, &results[1]) && is_queued;
+    is_queued = scheduler.read_regs(requests[2], ADDR, OUT_Y_L, out_y_read, 2U, AUTO_INC, done_cb, &results[2]) &&
+                is_queued;
+    k_sched_unlock();
+    zassert_true(is_queued);
+    wait_done(3);
+
+    /* Touching reads are served in queue order around the write */
+    zassert_equal(reg_file_emul_get_transfers_num(target), 3);
+    const reg_file_emul_transfer expected[] = {
+        {OUT_X_L | AUTO_INC, 2U, false},
+        {OUT_Y_L | AUTO_INC, 2U, true},
+        {OUT_Y_L | AUTO_INC, 2U, false},
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(expected); ++i) {
+        reg_file_emul_transfer transfer = reg_file_emul_get_transfer(target, i);
+        zassert_equal(transfer.reg, expected[i].reg, "transfer %zu", i);
+        zassert_equal(transfer.len, expected[i].len, "transfer %zu", i);
+        zassert_equal(transfer.is_write, expected[i].is_write, "transfer %zu", i);
+        zassert_equal(results[i], 0, "request %zu", i);
+    }
+
+    zassert_mem_equal(out_x, &regs[0], sizeof(out_x));
+    zassert_mem_equal(out_y_read, out_y, sizeof(out_y_read));
+    zassert_equal(scheduler.get_stats().merged, 0);
+
+    /* Single register access does not set the auto-increment bit */
+    uint8_t ctrl_reg1 = 0x57;
+    int result = NOT_DONE;
+    zassert_true(scheduler.write_regs(requests[0], ADDR, CTRL_REG1, &ctrl_reg1, 1U, AUTO_INC, done_cb, &result));
+    wait_done(1);
+
+    zassert_equal(result, 0);
+    zassert_equal(reg_file_emul_get_transfer(target, 3).reg, CTRL_REG1);
+    uint8_t reg_value;
+    reg_file_emul_get_regs(target, CTRL_REG1, &reg_value, 1U);
+    zassert_equal(reg_value, 0x57);
+}
+
+ZTEST(i2c_scheduler, test_error_propagation)
+{
+    reg_file_emul_set_error(target, -EIO);
+
+    /* Every merged request gets the burst error, buffers stay untouched */
+    accel_read_t read;
+    zassert_equal(read.submit(), 4);
+    wait_done(4);
+
+    zassert_equal(reg_file_emul_get_transfers_num(target), 1);
+    for (int read_result : read.results) {
+        zassert_equal(read_result, -EIO);
+    }
+    zassert_equal(read.status, 0xEE);
+    for (const auto &axis : read.out) {
+        zassert_equal(axis[0], 0xEE);
+        zassert_equal(axis[1], 0xEE);
+    }
+
+    uint8_t ctrl_reg1 = 0x57;
+    int result = NOT_DONE;
+    i2c_request_t request;
+    zassert_true(scheduler.write_regs(request, ADDR, CTRL_REG1, &ctrl_reg1, 1U, AUTO_INC, done_cb, &result));
+    wait_done(1);
+    zassert_equal(result, -EIO);
+
+    i2c_bus_stats_t stats = scheduler.get_stats();
+    zassert_equal(stats.requests, 5);
+    zassert_equal(stats.transactions, 2);
+    zassert_equal(stats.errors, 2);
+    zassert_equal(stats.bytes, 0);
+
+    /* The bus recovers once the target answers again */
+    reg_file_emul_set_error(target, 0);
+    zassert_equal(read.submit(), 4);
+    wait_done(4);
+    for (int read_result : read.results) {
+        zassert_equal(read_result, 0);
+    }
+    zassert_equal(read.status, 0);
+
+    zassert_false(scheduler.read_regs(request, ADDR, STATUS_REG, nullptr, 1U, AUTO_INC, done_cb, &result));
+    zassert_false(scheduler.read_regs(request, ADDR, STATUS_REG, &ctrl_reg1, 0U, AUTO_INC, done_cb, &result));
+}
+
+ZTEST_SUITE(i2c_scheduler, NULL, i2c_scheduler_setup, i2c_scheduler_before, NULL, NULL);
@@ -0,0 +1,151 @@
+/**
+ * @file           : reg_file_emul.c
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Register file I2C target emulator
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#define DT_DRV_COMPAT vnd_i2c_reg_file
+
+#include "reg_file_emul.h"
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/emul.h>
+#include <zephyr/drivers/i2c.h>
+#include <zephyr/drivers/i2c_emul.h>
+
+struct reg_file_emul_data
+{
+    uint8_t regs[REG_FILE_EMUL_REGS_NUM];
+    struct reg_file_emul_transfer log[REG_FILE_EMUL_LOG_SIZE];
+    size_t transfers_num;
+    int error;
+};
+
+/* Register address write followed by data read or write, as served by the scheduler */
+static int reg_file_emul_transfer(const struct emul *target, struct i2c_msg *msgs, int num_msgs, int addr)
+{
+    ARG_UNUSED(addr);
+
+    struct reg_file_emul_data *data = target->data;
+
+    if ((num_msgs != 2) || ((msgs[0].flags & I2C_MSG_READ) != 0) || (msgs[0].len != 1U)) {
+        return -EIO;
+    }
+
+    uint8_t reg_byte = msgs[0].buf[0];
+    bool is_write = (msgs[1].flags & I2C_MSG_READ) == 0;
+
+    if (data->transfers_num < REG_FILE_EMUL_LOG_SIZE) {
+        data->log[data->transfers_num].reg = reg_byte;
+        data->log[data->transfers_num].len = msgs[1].len;
+        data->log[data->transfers_num].is_write = is_write;
+    }
+    ++data->transfers_num;
+
+    if (data->error != 0) {
+        return data->error;
+    }
+
+    /* Without auto-increment every byte accesses the same register */
+    uint8_t reg = reg_byte & ~REG_FILE_EMUL_AUTO_INC;
+    bool is_auto_inc = (reg_byte & REG_FILE_EMUL_AUTO_INC) != 0;
+    for (uint32_t i = 0; i < msgs[1].len; ++i) {
+        if (reg >= REG_FILE_EMUL_REGS_NUM) {
+            return -EIO;
+        }
+        if (is_write) {
+            data->regs[reg] = msgs[1].buf[i];
+        }
+        else {
+            msgs[1].buf[i] = data->regs[reg];
+        }
+        reg += is_auto_inc ? 1U : 0U;
+    }
+
+    return 0;
+}
+
+void reg_file_emul_reset(const struct emul *target)
+{
+    struct reg_file_emul_data *data = target->data;
+    memset(data, 0, sizeof(*data));
+}
+
+void reg_file_emul_set_regs(const struct emul *target, uint8_t reg, const uint8_t *data, size_t len)
+{
+    struct reg_file_emul_data *emul_data = target->data;
+    memcpy(&emul_data->regs[reg], data, len);
+}
+
+void reg_file_emul_get_regs(const struct emul *target, uint8_t reg, uint8_t *data, size_t len)
+{
+    struct reg_file_emul_data *emul_data = target->data;
+    memcpy(data, &emul_data->regs[reg], len);
+}
+
+void reg_file_emul_set_error(const struct emul *target, int error)
+{
+    struct reg_file_emul_data *data = target->data;
+    data->error = error;
+}
+
+size_t reg_file_emul_get_transfers_num(const struct emul *target)
+{
+    struct reg_file_emul_data *data = target->data;
+    return data->transfers_num;
+}
+
+struct reg_file_emul_transfer reg_file_emul_get_transfer(const struct emul *target, size_t idx)
+{
+    struct reg_file_emul_data *data = target->data;
+    return data->log[idx];
+}
+
+static int reg_file_emul_init(const struct emul *target, const struct device *parent)
+{
+    ARG_UNUSED(parent);
+
+    reg_file_emul_reset(target);
+    return 0;
+}
+
+/* Emulated target needs a device of its own */
+static int reg_file_init(const struct device *dev)
+{
+    ARG_UNUSED(dev);
+
+    return 0;
+}
+
+static const struct i2c_emul_api reg_file_emul_api = {
+    .transfer = reg_file_emul_transfer,
+};
+
+#define REG_FILE_EMUL_DEFINE(inst)                                                          \
+    static struct reg_file_emul_data reg_file_emul_data_##inst;                             \
+    EMUL_DT_INST_DEFINE(inst, reg_file_emul_init, &reg_file_emul_data_##inst, NULL,         \
+                        &reg_file_emul_api, NULL);                                          \
+    DEVICE_DT_INST_DEFINE(inst, reg_file_init, NULL, NULL, NULL, POST_KERNEL,               \
+                          CONFIG_APPLICATION_INIT_PRIORITY, NULL);
+
+DT_INST_FOREACH_STATUS_OKAY(REG_FILE_EMUL_DEFINE)
@@ -0,0 +1,107 @@
+/**
+ * @file           : reg_file_emul.h
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Register file I2C target emulator
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include <zephyr/drivers/emul.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief           Register address bit enabling address auto-increment
+ */
+#define REG_FILE_EMUL_AUTO_INC      0x80U
+
+/**
+ * @brief           Number of registers
+ */
+#define REG_FILE_EMUL_REGS_NUM      0x80U
+
+/**
+ * @brief           Maximum number of logged transfers
+ */
+#define REG_FILE_EMUL_LOG_SIZE      16U
+
+/**
+ * @brief           Logged transfer
+ */
+struct reg_file_emul_transfer
+{
+    uint8_t reg;                            /*!< Register address byte as sent on the bus */
+    size_t len;                             /*!< Data length in bytes */
+    bool is_write;                          /*!< `true` for write, `false` for read */
+};
+
+/**
+ * @brief           Clear registers, transfers log and injected error
+ * @param[in]       target Emulator instance
+ */
+void reg_file_emul_reset(const struct emul *target);
+
+/**
+ * @brief           Set registers
+ * @param[in]       target Emulator instance
+ * @param[in]       reg First register address
+ * @param[in]       data Register values
+ * @param[in]       len Number of registers
+ */
+void reg_file_emul_set_regs(const struct emul *target, uint8_t reg, const uint8_t *data, size_t len);
+
+/**
+ * @brief           Get registers
+ * @param[in]       target Emulator instance
+ * @param[in]       reg First register address
+ * @param[out]      data Register values
+ * @param[in]       len Number of registers
+ */
+void reg_file_emul_get_regs(const struct emul *target, uint8_t reg, uint8_t *data, size_t len);
+
+/**
+ * @brief           Fail every following transfer
+ * @param[in]       target Emulator instance
+ * @param[in]       error Negative errno returned by transfers or `0` to stop failing
+ */
+void reg_file_emul_set_error(const struct emul *target, int error);
+
+/**
+ * @brief           Get number of transfers since reset, failed ones included
+ * @param[in]       target Emulator instance
+ */
+size_t reg_file_emul_get_transfers_num(const struct emul *target);
+
+/**
+ * @brief           Get logged transfer
+ * @param[in]       target Emulator instance
+ * @param[in]       idx Transfer index since reset, below \ref REG_FILE_EMUL_LOG_SIZE
+ */
+struct reg_file_emul_transfer reg_file_emul_get_transfer(const struct emul *target, size_t idx);
+
+#ifdef __cplusplus
+}
+#endif
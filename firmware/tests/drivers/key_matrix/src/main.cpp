@@ -0,0 +1,195 @@
+/**
+ * @file           : main.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Key matrix scan and debounce tests on a fake GPIO Port
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include <errno.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/ztest.h>
+
+#include "drivers/key_matrix.hpp"
+#include "matrix_gpio.h"
+
+using namespace drivers;
+
+namespace
+{
+
+constexpr size_t ROWS_NUM = 2;
+constexpr size_t COLS_NUM = 2;
+constexpr size_t EVENTS_NUM = 8;
+
+/* A key state change is accepted after 4 equal consecutive scans */
+constexpr size_t DEBOUNCE_SCANS = 4;
+
+constexpr uint8_t ROW_PINS[ROWS_NUM] = {0, 1};
+constexpr uint8_t CONTIGUOUS_COL_PINS[COLS_NUM] = {8, 9};
+constexpr uint8_t SPLIT_COL_PINS[COLS_NUM] = {8, 10};
+
+struct event_log_t
+{
+    uint8_t keys[EVENTS_NUM];
+    key_event_t events[EVENTS_NUM];
+    size_t events_num;
+};
+
+event_log_t event_log;
+
+void key_event_handler(void *arg, uint8_t key, key_event_t event)
+{
+    event_log_t &log = *static_cast<event_log_t *>(arg);
+    if (log.events_num >= EVENTS_NUM) {
+        return;
+    }
+
+    log.keys[log.events_num] = key;
+    log.events[log.events_num] = event;
+    ++log.events_num;
+}
+
+/* Active low rows and columns, columns pulled up */
+key_matrix_t make_matrix(const uint8_t (&col_pins)[COLS_NUM])
+{
+    struct gpio_dt_spec rows[ROWS_NUM];
+    for (size_t i = 0; i < ROWS_NUM; ++i) {
+        rows[i] = {matrix_gpio_get(), ROW_PINS[i], GPIO_ACTIVE_LOW};
+    }
+
+    struct gpio_dt_spec cols[COLS_NUM];
+    for (size_t i = 0; i < COLS_NUM; ++i) {
+        cols[i] = {matrix_gpio_get(), col_pins[i], GPIO_ACTIVE_LOW};
+    }
+
+    return key_matrix_t{rows, ROWS_NUM, cols, COLS_NUM};
+}
+
+bool init_matrix(key_matrix_t &matrix)
+{
+    return matrix.init(gpio::pin_pull_t::PullUp, key_event_handler, &event_log, 0);
+}
+
+void scan(key_matrix_t &matrix, size_t scans_num)
+{
+    for (size_t i = 0; i < scans_num; ++i) {
+        matrix.scan();
+    }
+}
+
+void set_key(size_t row, uint8_t col_pin, bool is_pressed)
+{
+    matrix_gpio_set_key(matrix_gpio_get(), ROW_PINS[row], col_pin, is_pressed);
+}
+
+void key_matrix_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    matrix_gpio_reset(matrix_gpio_get());
+    event_log = {};
+}
+
+}
+
+ZTEST(key_matrix, test_debounce)
+{
+    key_matrix_t matrix = make_matrix(CONTIGUOUS_COL_PINS);
+    zassert_true(init_matrix(matrix));
+
+    /* Row 1, column 0 is key 2 */
+    set_key(1, CONTIGUOUS_COL_PINS[0], true);
+    scan(matrix, DEBOUNCE_SCANS - 1U);
+    zassert_equal(event_log.events_num, 0);
+    zassert_false(matrix.is_pressed(2));
+
+    scan(matrix, 1);
+    zassert_equal(event_log.events_num, 1);
+    zassert_equal(event_log.keys[0], 2);
+    zassert_equal(event_log.events[0], key_event_t::Press);
+    zassert_equal(matrix.get_pressed_keys(), BIT64(2));
+
+    set_key(1, CONTIGUOUS_COL_PINS[0], false);
+    scan(matrix, DEBOUNCE_SCANS);
+    zassert_equal(event_log.events_num, 2);
+    zassert_equal(event_log.keys[1], 2);
+    zassert_equal(event_log.events[1], key_event_t::Release);
+    zassert_equal(matrix.get_pressed_keys(), 0);
+}
+
+ZTEST(key_matrix, test_bounce_ignored)
+{
+    key_matrix_t matrix = make_matrix(SPLIT_COL_PINS);
+    zassert_true(init_matrix(matrix));
+
+    /* Bounces shorter than the debounce restart the count */
+    for (size_t i = 0; i < 3; ++i) {
+        set_key(0, SPLIT_COL_PINS[1], true);
+        scan(matrix, DEBOUNCE_SCANS - 1U);
+        set_key(0, SPLIT_COL_PINS[1], false);
+        scan(matrix, 1);
+    }
+    zassert_equal(event_log.events_num, 0);
+
+    set_key(0, SPLIT_COL_PINS[1], true);
+    scan(matrix, DEBOUNCE_SCANS);
+    zassert_equal(event_log.events_num, 1);
+    zassert_equal(event_log.keys[0], 1);
+    zassert_equal(matrix.get_pressed_keys(), BIT64(1));
+}
+
+ZTEST(key_matrix, test_split_cols)
+{
+    key_matrix_t matrix = make_matrix(SPLIT_COL_PINS);
+    zassert_true(init_matrix(matrix));
+
+    set_key(0, SPLIT_COL_PINS[0], true);
+    set_key(1, SPLIT_COL_PINS[1], true);
+    scan(matrix, DEBOUNCE_SCANS);
+    zassert_equal(matrix.get_pressed_keys(), BIT64(0) | BIT64(3));
+    zassert_equal(event_log.events_num, 2);
+}
+
+/* Failed reads sample no key, even with active low columns */
+ZTEST(key_matrix, test_read_error)
+{
+    key_matrix_t matrix = make_matrix(CONTIGUOUS_COL_PINS);
+    zassert_true(init_matrix(matrix));
+
+    matrix_gpio_set_error(matrix_gpio_get(), -EIO);
+    scan(matrix, DEBOUNCE_SCANS);
+    zassert_equal(matrix.get_pressed_keys(), 0);
+    zassert_equal(event_log.events_num, 0);
+}
+
+ZTEST(key_matrix, test_split_cols_read_error)
+{
+    key_matrix_t matrix = make_matrix(SPLIT_COL_PINS);
+    zassert_true(init_matrix(matrix));
+
+    matrix_gpio_set_error(matrix_gpio_get(), -EIO);
+    scan(matrix, DEBOUNCE_SCANS);
+    zassert_equal(matrix.get_pressed_keys(), 0);
+    zassert_equal(event_log.events_num, 0);
+}
+
+ZTEST_SUITE(key_matrix, NULL, NULL, key_matrix_before, NULL, NULL);
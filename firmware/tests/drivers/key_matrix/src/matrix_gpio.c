@@ -0,0 +1,188 @@
+/**
+ * @file           : matrix_gpio.c
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Fake GPIO Port wired as a key matrix
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include "matrix_gpio.h"
+
+#include <errno.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/gpio.h>
+
+#define MATRIX_GPIO_PINS_NUM        32U
+
+struct matrix_gpio_data
+{
+    struct gpio_driver_data common;         /* Must be first */
+    gpio_port_pins_t outputs;
+    gpio_port_pins_t pull_ups;
+    gpio_port_value_t output_levels;
+    gpio_port_pins_t keys[MATRIX_GPIO_PINS_NUM];
+    int error;
+};
+
+struct matrix_gpio_config
+{
+    struct gpio_driver_config common;       /* Must be first */
+};
+
+static int matrix_gpio_init(const struct device *dev)
+{
+    ARG_UNUSED(dev);
+
+    return 0;
+}
+
+static int matrix_gpio_pin_configure(const struct device *dev, gpio_pin_t pin, gpio_flags_t flags)
+{
+    struct matrix_gpio_data *data = dev->data;
+
+    if ((flags & GPIO_OUTPUT) != 0) {
+        data->outputs |= BIT(pin);
+        if ((flags & GPIO_OUTPUT_INIT_HIGH) != 0) {
+            data->output_levels |= BIT(pin);
+        }
+        else if ((flags & GPIO_OUTPUT_INIT_LOW) != 0) {
+            data->output_levels &= ~BIT(pin);
+        }
+    }
+    else {
+        data->outputs &= ~BIT(pin);
+    }
+
+    if ((flags & GPIO_PULL_UP) != 0) {
+        data->pull_ups |= BIT(pin);
+    }
+    else {
+        data->pull_ups &= ~BIT(pin);
+    }
+
+    return 0;
+}
+
+/* Rows drive LOW through pressed keys, released columns are pulled up */
+static int matrix_gpio_port_get_raw(const struct device *dev, gpio_port_value_t *value)
+{
+    struct matrix_gpio_data *data = dev->data;
+
+    if (data->error != 0) {
+        return data->error;
+    }
+
+    gpio_port_value_t inputs = data->pull_ups;
+    for (size_t pin = 0; pin < MATRIX_GPIO_PINS_NUM; ++pin) {
+        if (((data->outputs & BIT(pin)) != 0) && ((data->output_levels & BIT(pin)) == 0)) {
+            inputs &= ~data->keys[pin];
+        }
+    }
+
+    *value = (data->output_levels & data->outputs) | (inputs & ~data->outputs);
+
+    return 0;
+}
+
+static int matrix_gpio_port_set_masked_raw(const struct device *dev, gpio_port_pins_t mask, gpio_port_value_t value)
+{
+    struct matrix_gpio_data *data = dev->data;
+
+    data->output_levels = (data->output_levels & ~mask) | (value & mask);
+
+    return 0;
+}
+
+static int matrix_gpio_port_set_bits_raw(const struct device *dev, gpio_port_pins_t pins)
+{
+    struct matrix_gpio_data *data = dev->data;
+
+    data->output_levels |= pins;
+
+    return 0;
+}
+
+static int matrix_gpio_port_clear_bits_raw(const struct device *dev, gpio_port_pins_t pins)
+{
+    struct matrix_gpio_data *data = dev->data;
+
+    data->output_levels &= ~pins;
+
+    return 0;
+}
+
+static int matrix_gpio_port_toggle_bits(const struct device *dev, gpio_port_pins_t pins)
+{
+    struct matrix_gpio_data *data = dev->data;
+
+    data->output_levels ^= pins;
+
+    return 0;
+}
+
+static const struct gpio_driver_api matrix_gpio_api = {
+    .pin_configure = matrix_gpio_pin_configure,
+    .port_get_raw = matrix_gpio_port_get_raw,
+    .port_set_masked_raw = matrix_gpio_port_set_masked_raw,
+    .port_set_bits_raw = matrix_gpio_port_set_bits_raw,
+    .port_clear_bits_raw = matrix_gpio_port_clear_bits_raw,
+    .port_toggle_bits = matrix_gpio_port_toggle_bits,
+};
+
+static const struct matrix_gpio_config matrix_gpio_config = {
+    .common = {
+        .port_pin_mask = GPIO_PORT_PIN_MASK_FROM_NGPIOS(MATRIX_GPIO_PINS_NUM),
+    },
+};
+
+static struct matrix_gpio_data matrix_gpio_data;
+
+DEVICE_DEFINE(matrix_gpio, "matrix_gpio", matrix_gpio_init, NULL, &matrix_gpio_data, &matrix_gpio_config,
+              POST_KERNEL, CONFIG_GPIO_INIT_PRIORITY, &matrix_gpio_api);
+
+const struct device *matrix_gpio_get(void)
+{
+    return DEVICE_GET(matrix_gpio);
+}
+
+void matrix_gpio_reset(const struct device *dev)
+{
+    struct matrix_gpio_data *data = dev->data;
+
+    *data = (struct matrix_gpio_data){0};
+}
+
+void matrix_gpio_set_key(const struct device *dev, uint8_t row_pin, uint8_t col_pin, bool is_pressed)
+{
+    struct matrix_gpio_data *data = dev->data;
+
+    if (is_pressed) {
+        data->keys[row_pin] |= BIT(col_pin);
+    }
+    else {
+        data->keys[row_pin] &= ~BIT(col_pin);
+    }
+}
+
+void matrix_gpio_set_error(const struct device *dev, int error)
+{
+    struct matrix_gpio_data *data = dev->data;
+
+    data->error = error;
+}
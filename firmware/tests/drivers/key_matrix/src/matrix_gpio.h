@@ -0,0 +1,66 @@
+/**
+ * @file           : matrix_gpio.h
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Fake GPIO Port wired as a key matrix
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <zephyr/device.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief           Get GPIO Port device
+ * @details         Input Pins with pull-up read HIGH unless a pressed key
+ *                      connects them to an Output Pin driven LOW
+ */
+const struct device *matrix_gpio_get(void);
+
+/**
+ * @brief           Release all keys, clear Pins configuration and injected error
+ * @param[in]       dev GPIO Port device
+ */
+void matrix_gpio_reset(const struct device *dev);
+
+/**
+ * @brief           Press or release a key
+ * @param[in]       dev GPIO Port device
+ * @param[in]       row_pin Row Pin number
+ * @param[in]       col_pin Column Pin number
+ * @param[in]       is_pressed `true` to connect the Pins, `false` to disconnect them
+ */
+void matrix_gpio_set_key(const struct device *dev, uint8_t row_pin, uint8_t col_pin, bool is_pressed);
+
+/**
+ * @brief           Fail every following Port read
+ * @param[in]       dev GPIO Port device
+ * @param[in]       error Negative errno returned by reads or `0` to stop failing
+ */
+void matrix_gpio_set_error(const struct device *dev, int error);
+
+#ifdef __cplusplus
+}
+#endif
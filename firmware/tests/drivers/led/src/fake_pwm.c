@@ -0,0 +1,119 @@
+/**
+ * @file           : fake_pwm.c
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Fake PWM controller recording channel pulses
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include "fake_pwm.h"
+
+#include <errno.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/pwm.h>
+
+struct fake_pwm_channel
+{
+    uint32_t period_cycles;
+    uint32_t pulse_cycles;
+    size_t sets_num;
+};
+
+struct fake_pwm_data
+{
+    struct fake_pwm_channel channels[FAKE_PWM_CHANNELS_NUM];
+};
+
+static int fake_pwm_init(const struct device *dev)
+{
+    ARG_UNUSED(dev);
+
+    return 0;
+}
+
+static int fake_pwm_set_cycles(const struct device *dev, uint32_t channel, uint32_t period_cycles,
+                               uint32_t pulse_cycles, pwm_flags_t flags)
+{
+    ARG_UNUSED(flags);
+
+    struct fake_pwm_data *data = dev->data;
+
+    if (channel >= FAKE_PWM_CHANNELS_NUM) {
+        return -EINVAL;
+    }
+
+    data->channels[channel].period_cycles = period_cycles;
+    data->channels[channel].pulse_cycles = pulse_cycles;
+    ++data->channels[channel].sets_num;
+
+    return 0;
+}
+
+static int fake_pwm_get_cycles_per_sec(const struct device *dev, uint32_t channel, uint64_t *cycles)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(channel);
+
+    *cycles = FAKE_PWM_CYCLES_PER_SEC;
+
+    return 0;
+}
+
+static const struct pwm_driver_api fake_pwm_api = {
+    .set_cycles = fake_pwm_set_cycles,
+    .get_cycles_per_sec = fake_pwm_get_cycles_per_sec,
+};
+
+static struct fake_pwm_data fake_pwm_data;
+
+DEVICE_DEFINE(fake_pwm, "fake_pwm", fake_pwm_init, NULL, &fake_pwm_data, NULL,
+              POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEVICE, &fake_pwm_api);
+
+const struct device *fake_pwm_get(void)
+{
+    return DEVICE_GET(fake_pwm);
+}
+
+void fake_pwm_reset(const struct device *dev)
+{
+    struct fake_pwm_data *data = dev->data;
+
+    *data = (struct fake_pwm_data){0};
+}
+
+uint32_t fake_pwm_get_period(const struct device *dev, uint32_t channel)
+{
+    struct fake_pwm_data *data = dev->data;
+
+    return data->channels[channel].period_cycles;
+}
+
+uint32_t fake_pwm_get_pulse(const struct device *dev, uint32_t channel)
+{
+    struct fake_pwm_data *data = dev->data;
+
+    return data->channels[channel].pulse_cycles;
+}
+
+size_t fake_pwm_get_sets_num(const struct device *dev, uint32_t channel)
+{
+    struct fake_pwm_data *data = dev->data;
+
+    return data->channels[channel].sets_num;
+}
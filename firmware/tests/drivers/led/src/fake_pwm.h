@@ -0,0 +1,81 @@
+/**
+ * @file           : fake_pwm.h
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Fake PWM controller recording channel pulses
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <zephyr/device.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief           PWM clock frequency
+ */
+#define FAKE_PWM_CYCLES_PER_SEC     1000000U
+
+/**
+ * @brief           Number of channels
+ */
+#define FAKE_PWM_CHANNELS_NUM       4U
+
+/**
+ * @brief           Get PWM device
+ */
+const struct device *fake_pwm_get(void);
+
+/**
+ * @brief           Clear recorded channel settings
+ * @param[in]       dev PWM device
+ */
+void fake_pwm_reset(const struct device *dev);
+
+/**
+ * @brief           Get last period set on the channel
+ * @param[in]       dev PWM device
+ * @param[in]       channel Channel number
+ * @return          Period in PWM clock cycles
+ */
+uint32_t fake_pwm_get_period(const struct device *dev, uint32_t channel);
+
+/**
+ * @brief           Get last pulse width set on the channel
+ * @param[in]       dev PWM device
+ * @param[in]       channel Channel number
+ * @return          Pulse width in PWM clock cycles
+ */
+uint32_t fake_pwm_get_pulse(const struct device *dev, uint32_t channel);
+
+/**
+ * @brief           Get number of settings applied to the channel since reset
+ * @param[in]       dev PWM device
+ * @param[in]       channel Channel number
+ */
+size_t fake_pwm_get_sets_num(const struct device *dev, uint32_t channel);
+
+#ifdef __cplusplus
+}
+#endif
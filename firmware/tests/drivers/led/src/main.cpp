@@ -0,0 +1,191 @@
+/**
+ * @file           : main.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : LED output channel tests
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/drivers/pwm.h>
+#include <zephyr/ztest.h>
+
+#include "drivers/led.hpp"
+#include "fake_pwm.h"
+
+using namespace drivers;
+
+namespace
+{
+
+constexpr uint8_t LED_PIN = 3;
+constexpr uint8_t ACTIVE_LOW_LED_PIN = 4;
+
+constexpr uint32_t PWM_CHANNEL = 1;
+constexpr uint32_t PWM_PERIOD_CYCLES = 1000;
+
+/* 12 outputs take two frame bytes */
+constexpr size_t SHIFT_REGISTER_BITS = 12;
+
+using mock_led_t = led_t<mock_output_t>;
+using shift_register_led_t = led_t<shift_register_output_t<SHIFT_REGISTER_BITS>>;
+
+const device_t *const gpio_dev = DEVICE_DT_GET(DT_NODELABEL(gpio0));
+
+const struct pwm_dt_spec pwm_spec = {
+    .dev = fake_pwm_get(),
+    .channel = PWM_CHANNEL,
+    .period = PWM_MSEC(1),
+    .flags = PWM_POLARITY_NORMAL,
+};
+
+void led_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    fake_pwm_reset(fake_pwm_get());
+}
+
+}
+
+ZTEST(led, test_mock_output)
+{
+    mock_led_t led{};
+    zassert_false(led.get_output().is_initialized);
+    zassert_true(led.init());
+    zassert_true(led.get_output().is_initialized);
+
+    /* The output is only driven on changes */
+    led.turn_on();
+    led.turn_on();
+    led.turn_off();
+
+    const mock_output_t &output = led.get_output();
+    zassert_equal(output.calls_num, 2);
+    zassert_true(output.calls[0]);
+    zassert_false(output.calls[1]);
+    zassert_equal(output.transitions_num, 2);
+    zassert_false(output.is_set);
+}
+
+ZTEST(led, test_silent_blink_api)
+{
+    mock_led_t led{};
+    zassert_true(led.init());
+
+    /* Uptime does not move without sleeping, the blink stays in its ON phase */
+    led.blink(100, 100);
+    zassert_true(led.get_output().is_set);
+
+    led.set_silent_blink();
+    zassert_false(led.get_output().is_set);
+
+    led.reset_silent_blink();
+    zassert_true(led.get_output().is_set);
+
+    const mock_output_t &output = led.get_output();
+    zassert_equal(output.calls_num, 3);
+    zassert_true(output.calls[0]);
+    zassert_false(output.calls[1]);
+    zassert_true(output.calls[2]);
+}
+
+
+ZTEST(led, test_gpio_output)
+{
+    led_t<gpio_output_t> led{gpio_dev, LED_PIN};
+    zassert_true(led.init());
+    zassert_equal(gpio_emul_output_get(gpio_dev, LED_PIN), 0);
+
+    led.turn_on();
+    zassert_equal(gpio_emul_output_get(gpio_dev, LED_PIN), 1);
+
+    led.turn_off();
+    zassert_equal(gpio_emul_output_get(gpio_dev, LED_PIN), 0);
+}
+
+ZTEST(led, test_gpio_output_active_low)
+{
+    led_t<gpio_output_t> led{gpio_dev, ACTIVE_LOW_LED_PIN, true};
+    zassert_true(led.init());
+    zassert_equal(gpio_emul_output_get(gpio_dev, ACTIVE_LOW_LED_PIN), 1);
+
+    led.turn_on();
+    zassert_equal(gpio_emul_output_get(gpio_dev, ACTIVE_LOW_LED_PIN), 0);
+
+    led.turn_off();
+    zassert_equal(gpio_emul_output_get(gpio_dev, ACTIVE_LOW_LED_PIN), 1);
+}
+
+ZTEST(led, test_pwm_output)
+{
+    const device_t *pwm_dev = fake_pwm_get();
+
+    /* Full period pulse by default */
+    led_t<pwm_output_t> led{pwm_spec};
+    zassert_true(led.init());
+    zassert_equal(fake_pwm_get_sets_num(pwm_dev, PWM_CHANNEL), 1);
+    zassert_equal(fake_pwm_get_period(pwm_dev, PWM_CHANNEL), PWM_PERIOD_CYCLES);
+    zassert_equal(fake_pwm_get_pulse(pwm_dev, PWM_CHANNEL), 0);
+
+    led.turn_on();
+    zassert_equal(fake_pwm_get_pulse(pwm_dev, PWM_CHANNEL), PWM_PERIOD_CYCLES);
+
+    led.turn_off();
+    zassert_equal(fake_pwm_get_pulse(pwm_dev, PWM_CHANNEL), 0);
+    zassert_equal(fake_pwm_get_sets_num(pwm_dev, PWM_CHANNEL), 3);
+}
+
+ZTEST(led, test_pwm_output_pulse)
+{
+    const device_t *pwm_dev = fake_pwm_get();
+
+    led_t<pwm_output_t> led{pwm_spec, PWM_USEC(250)};
+    zassert_true(led.init());
+
+    led.turn_on();
+    zassert_equal(fake_pwm_get_pulse(pwm_dev, PWM_CHANNEL), PWM_PERIOD_CYCLES / 4U);
+}
+
+ZTEST(led, test_shift_register_output)
+{
+    shift_register_frame_t<SHIFT_REGISTER_BITS> frame{};
+    shift_register_led_t led{frame, 9};
+    zassert_true(led.init());
+    zassert_true(frame.take_dirty());
+    zassert_false(frame.take_dirty());
+
+    /* Bit 9 is bit 1 of the second byte */
+    led.turn_on();
+    zassert_true(frame.take_dirty());
+    zassert_equal(frame.data()[0], 0);
+    zassert_equal(frame.data()[1], BIT(1));
+
+    led.turn_off();
+    zassert_true(frame.take_dirty());
+    zassert_equal(frame.data()[1], 0);
+
+    /* Bits past the register chain are rejected */
+    shift_register_led_t outside_led{frame, SHIFT_REGISTER_BITS};
+    zassert_false(outside_led.init());
+}
+
+ZTEST_SUITE(led, NULL, NULL, led_before, NULL, NULL);
@@ -0,0 +1,178 @@
+/**
+ * @file           : main.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : LEDs warm reset checkpoint tests
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include <new>
+#include <type_traits>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "drivers/led_checkpoint.hpp"
+
+using namespace drivers;
+
+namespace
+{
+
+constexpr size_t LEDS_NUM = 2;
+
+using checkpoint_t = led_checkpoint_t<LEDS_NUM>;
+
+static_assert(std::is_trivially_default_constructible_v<checkpoint_t>,
+              "Checkpoint must not be touched by static initialization");
+
+__noinit checkpoint_t checkpoint;
+
+void fill_layers(led_layers_t &first, led_layers_t &second)
+{
+    first[static_cast<size_t>(led_layer_t::Base)] = led_pattern_t::blink(100, 220, 330, led_pattern_t::BLINK_FOREVER, 110);
+    first[static_cast<size_t>(led_layer_t::Mute)] = led_pattern_t::solid(false, 700);
+    second[static_cast<size_t>(led_layer_t::Base)] = led_pattern_t::blink(100, 50, 50, 10);
+    second[static_cast<size_t>(led_layer_t::Overlay)] = led_pattern_t::solid(true, 300, 400);
+}
+
+/* Compare the composed state of two layer stacks, the second one shifted by offset_ms */
+bool is_same_state(const led_layers_t &expected, const led_layers_t &actual, int64_t offset_ms)
+{
+    for (size_t i = 0; i < LED_LAYERS_NUM; ++i) {
+        if (expected[i].has_value() != actual[i].has_value()) {
+            return false;
+        }
+        if (!expected[i].has_value()) {
+            continue;
+        }
+
+        for (int64_t t = 0; t < 5000; ++t) {
+            if ((expected[i]->is_on_at(t) != actual[i]->is_on_at(t + offset_ms)) ||
+                (expected[i]->is_active_at(t) != actual[i]->is_active_at(t + offset_ms))) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+void save(const led_layers_t &first, const led_layers_t &second, int64_t now_ms)
+{
+    checkpoint.save_led(0, first, 2000);
+    checkpoint.save_led(1, second, 3500);
+    checkpoint.seal(now_ms);
+}
+
+void checkpoint_before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+    checkpoint.invalidate();
+}
+
+}
+
+ZTEST(led_checkpoint, test_restore_after_static_init)
+{
+    led_layers_t first{};
+    led_layers_t second{};
+    fill_layers(first, second);
+    save(first, second, 1000);
+    checkpoint.mark_alive(1500);
+
+    /* Static initialization of the next boot, it must leave the image intact */
+    new (&checkpoint) checkpoint_t;
+
+    zassert_true(checkpoint.is_valid());
+    zassert_equal(checkpoint.get_alive_ms(), 1500);
+
+    led_layers_t restored{};
+    uint32_t current_ua = 0;
+    checkpoint.load_led(0, restored, current_ua);
+    zassert_equal(current_ua, 2000);
+    zassert_true(is_same_state(first, restored, 0));
+
+    checkpoint.load_led(1, restored, current_ua);
+    zassert_equal(current_ua, 3500);
+    zassert_true(is_same_state(second, restored, 0));
+}
+
+ZTEST(led_checkpoint, test_restore_keeps_phase)
+{
+    led_layers_t first{};
+    led_layers_t second{};
+    fill_layers(first, second);
+    save(first, second, 1000);
+    checkpoint.mark_alive(1234);
+
+    /* The new boot restores at uptime 7, the patterns continue from uptime 1234 */
+    int64_t offset_ms = 7 - checkpoint.get_alive_ms();
+    led_layers_t loaded{};
+    uint32_t current_ua = 0;
+    checkpoint.load_led(0, loaded, current_ua);
+
+    led_t<mock_output_t> led{};
+    led.restore_layers(loaded, offset_ms);
+
+    zassert_true(is_same_state(first, led.get_layers(), offset_ms));
+}
+
+ZTEST(led_checkpoint, test_empty_layers)
+{
+    led_layers_t first{};
+    led_layers_t second{};
+    save(first, second, 10);
+
+    led_layers_t restored{};
+    restored[0] = led_pattern_t::solid(true, 0);
+    uint32_t current_ua = 0;
+    zassert_true(checkpoint.is_valid());
+    checkpoint.load_led(0, restored, current_ua);
+    zassert_true(is_same_state(first, restored, 0));
+}
+
+ZTEST(led_checkpoint, test_corruption_detected)
+{
+    led_layers_t first{};
+    led_layers_t second{};
+    fill_layers(first, second);
+
+    save(first, second, 1000);
+    reinterpret_cast<uint8_t *>(&checkpoint)[sizeof(checkpoint) / 2] ^= 0x01U;
+    zassert_false(checkpoint.is_valid());
+
+    save(first, second, 1000);
+    checkpoint.mark_alive(1500);
+    reinterpret_cast<uint8_t *>(&checkpoint)[sizeof(checkpoint) - 1] ^= 0x80U;
+    zassert_false(checkpoint.is_valid());
+}
+
+ZTEST(led_checkpoint, test_unsealed_invalid)
+{
+    led_layers_t first{};
+    led_layers_t second{};
+    fill_layers(first, second);
+    save(first, second, 1000);
+
+    /* Interrupted save */
+    checkpoint.save_led(0, second, 2000);
+    zassert_false(checkpoint.is_valid());
+}
+
+ZTEST_SUITE(led_checkpoint, NULL, NULL, checkpoint_before, NULL, NULL);
@@ -0,0 +1,149 @@
+/**
+ * @file           : main.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : LED pattern layers tests
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "drivers/led.hpp"
+
+using namespace drivers;
+
+namespace
+{
+
+using mock_led_t = led_t<mock_output_t>;
+
+/* Output calls with their update times */
+struct trace_t
+{
+    int64_t times_ms[mock_output_t::MAX_CALLS_NUM];
+    size_t calls_num;
+};
+
+/* Update the LED every millisecond of [from_ms, to_ms) and trace new output calls */
+void run(mock_led_t &led, int64_t from_ms, int64_t to_ms, trace_t &trace)
+{
+    const mock_output_t &output = led.get_output();
+    for (int64_t now_ms = from_ms; now_ms < to_ms; ++now_ms) {
+        size_t calls_num = output.calls_num;
+        led.update(now_ms);
+        for (size_t i = calls_num; (i < output.calls_num) && (trace.calls_num < mock_output_t::MAX_CALLS_NUM); ++i) {
+            trace.times_ms[trace.calls_num++] = now_ms;
+        }
+    }
+}
+
+void check_trace(const mock_led_t &led, const trace_t &trace, std::initializer_list<int64_t> set_times_ms,
+                 std::initializer_list<int64_t> reset_times_ms)
+{
+    const mock_output_t &output = led.get_output();
+    zassert_equal(trace.calls_num, set_times_ms.size() + reset_times_ms.size());
+
+    /* Calls alternate starting from set, the output is only driven on changes */
+    auto set_it = set_times_ms.begin();
+    auto reset_it = reset_times_ms.begin();
+    for (size_t i = 0; i < trace.calls_num; ++i) {
+        bool is_set_call = (i % 2U) == 0;
+        zassert_equal(output.calls[i], is_set_call, "call %zu", i);
+        zassert_equal(trace.times_ms[i], is_set_call ? *set_it++ : *reset_it++, "call %zu", i);
+    }
+}
+
+}
+
+ZTEST(led_layers, test_blink_sequence)
+{
+    mock_led_t led{};
+    zassert_true(led.init());
+    zassert_true(led.get_output().is_initialized);
+
+    trace_t trace{};
+    led.set_layer(led_layer_t::Base, led_pattern_t::blink(1000, 100, 200, 3, 50));
+    run(led, 1000, 2500, trace);
+
+    check_trace(led, trace, {1050, 1350, 1650}, {1150, 1450, 1750});
+    zassert_equal(led.get_output().transitions_num, 6);
+    zassert_false(led.get_output().is_set);
+    zassert_equal(led.next_transition_ms(2500), mock_led_t::NO_TRANSITION);
+}
+
+ZTEST(led_layers, test_silent_mode)
+{
+    mock_led_t led{};
+    zassert_true(led.init());
+
+    trace_t trace{};
+    led.set_layer(led_layer_t::Base, led_pattern_t::blink(1000, 100, 200));
+    run(led, 1000, 1050, trace);
+
+    /* Mute resets the output at once, the blinking goes on hidden */
+    led.set_layer(led_layer_t::Mute, led_pattern_t::solid(false, 1050));
+    run(led, 1050, 1450, trace);
+
+    /* Unmuted in the OFF phase, the next blink comes in phase */
+    led.clear_layer(led_layer_t::Mute);
+    run(led, 1450, 1700, trace);
+
+    check_trace(led, trace, {1000, 1600}, {1050});
+    zassert_true(led.get_output().is_set);
+}
+
+ZTEST(led_layers, test_solid_overlay)
+{
+    mock_led_t led{};
+    zassert_true(led.init());
+
+    trace_t trace{};
+    led.set_layer(led_layer_t::Base, led_pattern_t::solid(false, 0));
+    led.set_layer(led_layer_t::Overlay, led_pattern_t::solid(true, 0, 30));
+    run(led, 0, 100, trace);
+
+    /* The Base layer shows up again when the overlay ends */
+    check_trace(led, trace, {0}, {30});
+    zassert_equal(led.next_transition_ms(100), mock_led_t::NO_TRANSITION);
+}
+
+ZTEST(led_layers, test_lazy_update)
+{
+    mock_led_t led{};
+    zassert_true(led.init());
+
+    /* A layer change is due at once, a static layer has no further deadline */
+    led.set_layer(led_layer_t::Base, led_pattern_t::solid(true, 0));
+    zassert_equal(led.next_transition_ms(10), 10);
+
+    trace_t trace{};
+    run(led, 10, 100, trace);
+    check_trace(led, trace, {10}, {});
+    zassert_equal(led.next_transition_ms(100), mock_led_t::NO_TRANSITION);
+
+    /* Clearing the top layer shows the one below */
+    led.set_layer(led_layer_t::Overlay, led_pattern_t::solid(false, 0));
+    run(led, 100, 150, trace);
+    led.clear_layer(led_layer_t::Overlay);
+    run(led, 150, 200, trace);
+    check_trace(led, trace, {10, 150}, {100});
+}
+
+ZTEST_SUITE(led_layers, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,99 @@
+/**
+ * @file           : main.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : LED usage accounting tests
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "drivers/led.hpp"
+
+using namespace drivers;
+
+namespace
+{
+
+using mock_led_t = led_t<mock_output_t>;
+
+/* Update the LED every millisecond of [from_ms, to_ms) */
+void run(mock_led_t &led, int64_t from_ms, int64_t to_ms)
+{
+    for (int64_t now_ms = from_ms; now_ms < to_ms; ++now_ms) {
+        led.update(now_ms);
+    }
+}
+
+}
+
+ZTEST(led_stats, test_blink)
+{
+    mock_led_t led{};
+    zassert_true(led.init());
+
+    led.set_layer(led_layer_t::Base, led_pattern_t::blink(1000, 100, 200, 3, 50));
+    run(led, 1000, 2500);
+
+    led_stats_t stats = led.get_stats(2500);
+    zassert_equal(stats.on_ms, 3 * 100);
+    zassert_equal(stats.muted_ms, 0);
+    zassert_equal(stats.transitions, 6);
+    zassert_equal(stats.transitions, led.get_output().transitions_num);
+}
+
+ZTEST(led_stats, test_silent_mode)
+{
+    mock_led_t led{};
+    zassert_true(led.init());
+
+    led.set_layer(led_layer_t::Base, led_pattern_t::blink(1000, 100, 200));
+    run(led, 1000, 1050);
+
+    /* Hidden blinks count as muted time, not as ON time */
+    led.set_layer(led_layer_t::Mute, led_pattern_t::solid(false, 1050));
+    run(led, 1050, 1450);
+
+    led.clear_layer(led_layer_t::Mute);
+    run(led, 1450, 1700);
+
+    led_stats_t stats = led.get_stats(1700);
+    zassert_equal(stats.on_ms, 50 + 100);
+    zassert_equal(stats.muted_ms, 400);
+    zassert_equal(stats.transitions, 3);
+}
+
+ZTEST(led_stats, test_reset)
+{
+    mock_led_t led{};
+    zassert_true(led.init());
+
+    led.set_layer(led_layer_t::Base, led_pattern_t::solid(true, 1000));
+    run(led, 1000, 1100);
+    zassert_equal(led.get_stats(1100).on_ms, 100);
+
+    /* Time since the last transition is counted up to the query time */
+    led.reset_stats(1100);
+    led_stats_t stats = led.get_stats(1150);
+    zassert_equal(stats.on_ms, 50);
+    zassert_equal(stats.transitions, 0);
+}
+
+ZTEST_SUITE(led_stats, NULL, NULL, NULL, NULL, NULL);
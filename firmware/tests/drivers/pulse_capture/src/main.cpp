@@ -0,0 +1,221 @@
+/**
+ * @file           : main.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Pulse capture tests
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "drivers/pulse_capture.hpp"
+
+using namespace drivers;
+
+namespace
+{
+
+constexpr size_t BLOCK_SIZE = 4;
+
+using capture_t = pulse_capture_t<mock_capture_backend_t, BLOCK_SIZE>;
+
+/* Sum of all batches delivered to the handler */
+struct batches_t
+{
+    uint32_t batches_num;
+    pulse_batch_t total;
+};
+
+void batch_handler(void *arg, const pulse_batch_t &batch)
+{
+    batches_t &batches = *static_cast<batches_t *>(arg);
+
+    if (batches.batches_num == 0) {
+        batches.total = batch;
+    }
+    else {
+        batches.total.edges_num += batch.edges_num;
+        batches.total.pulses_num += batch.pulses_num;
+        batches.total.width_sum_ticks += batch.width_sum_ticks;
+        batches.total.periods_num += batch.periods_num;
+        batches.total.period_sum_ticks += batch.period_sum_ticks;
+        batches.total.period_min_ticks = MIN(batches.total.period_min_ticks, batch.period_min_ticks);
+        batches.total.period_max_ticks = MAX(batches.total.period_max_ticks, batch.period_max_ticks);
+    }
+    ++batches.batches_num;
+}
+
+/* Rising edges at the given ticks, HIGH pulses of width_ticks after each of them */
+void push_pulses(capture_t &capture, std::initializer_list<uint32_t> rising_ticks, uint32_t width_ticks)
+{
+    for (uint32_t tick : rising_ticks) {
+        capture.get_backend().push_edge(tick);
+        capture.get_backend().push_edge(tick + width_ticks);
+    }
+}
+
+}
+
+ZTEST(pulse_capture, test_width_and_period)
+{
+    capture_t capture{};
+    batches_t batches{};
+    zassert_true(capture.init());
+    zassert_true(capture.start(batch_handler, &batches));
+
+    /* Fills the first half, 1 kHz with 250 us pulses */
+    push_pulses(capture, {1000, 2000}, 250);
+
+    zassert_equal(batches.batches_num, 1);
+    zassert_equal(batches.total.tick_hz, 1000000U);
+    zassert_equal(batches.total.edges_num, 4);
+    zassert_equal(batches.total.pulses_num, 2);
+    zassert_equal(batches.total.width_sum_ticks, 500);
+    zassert_equal(batches.total.periods_num, 1);
+    zassert_equal(batches.total.period_sum_ticks, 1000);
+    zassert_equal(batches.total.get_width_us(), 250);
+    zassert_equal(batches.total.get_frequency_millihz(), 1000000U);
+}
+
+ZTEST(pulse_capture, test_pulse_across_batches)
+{
+    capture_t capture{};
+    batches_t batches{};
+    zassert_true(capture.start(batch_handler, &batches));
+
+    /* The pulse started in the drained batch ends in the next one */
+    capture.get_backend().push_edge(1000);
+    capture.drain();
+    zassert_equal(batches.batches_num, 1);
+    zassert_equal(batches.total.pulses_num, 0);
+
+    capture.get_backend().push_edge(1300);
+    capture.drain();
+    zassert_equal(batches.batches_num, 2);
+    zassert_equal(batches.total.pulses_num, 1);
+    zassert_equal(batches.total.width_sum_ticks, 300);
+
+    /* Nothing new, no batch */
+    capture.drain();
+    zassert_equal(batches.batches_num, 2);
+}
+
+ZTEST(pulse_capture, test_period_min_max)
+{
+    capture_t capture{};
+    batches_t batches{};
+    zassert_true(capture.start(batch_handler, &batches));
+
+    push_pulses(capture, {1000, 2000, 3500, 4300}, 100);
+    capture.drain();
+
+    zassert_equal(batches.total.periods_num, 3);
+    zassert_equal(batches.total.period_min_ticks, 800);
+    zassert_equal(batches.total.period_max_ticks, 1500);
+    zassert_equal(batches.total.period_sum_ticks, 3300);
+}
+
+ZTEST(pulse_capture, test_counter_wrap)
+{
+    capture_t capture{};
+    batches_t batches{};
+    capture.get_backend().counter_mask = 0xFFFFU;
+    zassert_true(capture.start(batch_handler, &batches));
+
+    /* 16-bit counter wraps inside the pulse and inside the period */
+    capture.get_backend().push_edge(0xFF00U);
+    capture.get_backend().push_edge(0x10010U);
+    capture.get_backend().push_edge(0x10100U);
+    capture.drain();
+
+    zassert_equal(batches.total.pulses_num, 1);
+    zassert_equal(batches.total.width_sum_ticks, 0x110U);
+    zassert_equal(batches.total.periods_num, 1);
+    zassert_equal(batches.total.period_sum_ticks, 0x200U);
+}
+
+ZTEST(pulse_capture, test_drain_across_buffer_wrap)
+{
+    capture_t capture{};
+    batches_t batches{};
+    capture.get_backend().is_notifying = false;
+    zassert_true(capture.start(batch_handler, &batches));
+
+    push_pulses(capture, {1000}, 100);
+    capture.get_backend().push_edge(2000);
+    capture.drain();
+    zassert_equal(batches.total.edges_num, 3);
+
+    /* Late drain, the write index has wrapped past the read index */
+    capture.get_backend().push_edge(2100);
+    push_pulses(capture, {3000, 4000}, 100);
+    capture.get_backend().push_edge(5000);
+    capture.drain();
+
+    zassert_equal(batches.batches_num, 2);
+    zassert_equal(batches.total.edges_num, 9);
+    zassert_equal(batches.total.pulses_num, 4);
+    zassert_equal(batches.total.width_sum_ticks, 400);
+    zassert_equal(batches.total.periods_num, 4);
+    zassert_equal(batches.total.period_sum_ticks, 4000);
+}
+
+ZTEST(pulse_capture, test_level_resync)
+{
+    capture_t capture{};
+    batches_t batches{};
+    zassert_true(capture.start(batch_handler, &batches));
+
+    push_pulses(capture, {1000}, 100);
+    capture.drain();
+
+    /* Rising edge filtered out by the timer, the input is HIGH now */
+    capture.get_backend().level = true;
+    capture.drain();
+
+    capture.get_backend().push_edge(2200);
+    push_pulses(capture, {3000}, 300);
+    capture.drain();
+
+    zassert_equal(batches.total.pulses_num, 2);
+    zassert_equal(batches.total.width_sum_ticks, 400);
+    zassert_equal(batches.total.periods_num, 0);
+}
+
+ZTEST(pulse_capture, test_last_edge_time)
+{
+    capture_t capture{};
+    zassert_true(capture.start(nullptr, nullptr));
+    zassert_equal(capture_t::rising_edge_us_cb(&capture), -1);
+
+    push_pulses(capture, {1000}, 200);
+    capture.get_backend().counter = 1700;
+
+    /* The rising edge is 700 us and the falling one 500 us before now */
+    int64_t before_us = static_cast<int64_t>(k_ticks_to_us_floor64(k_uptime_ticks()));
+    int64_t rising_us = capture_t::rising_edge_us_cb(&capture);
+    int64_t falling_us = capture_t::falling_edge_us_cb(&capture);
+    int64_t after_us = static_cast<int64_t>(k_ticks_to_us_floor64(k_uptime_ticks()));
+
+    zassert_between_inclusive(rising_us, before_us - 700, after_us - 700);
+    zassert_between_inclusive(falling_us, before_us - 500, after_us - 500);
+}
+
+ZTEST_SUITE(pulse_capture, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,205 @@
+/**
+ * @file           : main.cpp
+ * @author         : Dmitry Karasev <karasevsdmitry@yandex.ru>
+ * @brief          : Waveform encoder and engine tests
+ ******************************************************************************
+ * @attention
+ *
+ * Copyright (c) 2023 Dmitry Karasev
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ ******************************************************************************
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/ztest.h>
+
+#include "drivers/waveform.hpp"
+
+using namespace drivers::waveform;
+
+namespace
+{
+
+constexpr size_t SAMPLES_NUM = 16;
+
+/* Engine owns Pins 2 and 5 */
+constexpr gpio_port_pins_t ENGINE_PINS = BIT(2) | BIT(5);
+
+using engine_mock_t = engine_t<mock_dma_backend_t>;
+
+const device_t *const gpio_dev = DEVICE_DT_GET(DT_NODELABEL(gpio0));
+
+uint32_t buffer[SAMPLES_NUM];
+
+}
+
+ZTEST(waveform, test_edge_bsrr_encoding)
+{
+    encoder_t wave{buffer, SAMPLES_NUM};
+    wave.clear();
+
+    /* HIGH sets the low half-word bit, LOW sets the high half-word bit */
+    zassert_true(wave.add_edge(1, 3, true));
+    zassert_true(wave.add_edge(2, 3, false));
+    zassert_equal(wave.data()[0], 0);
+    zassert_equal(wave.data()[1], BIT(3));
+    zassert_equal(wave.data()[2], BIT(3 + 16));
+
+    /* Edges of other Pins on the same tick are merged */
+    zassert_true(wave.add_edge(1, 15, false));
+    zassert_equal(wave.data()[1], BIT(3) | BIT(15 + 16));
+
+    /* Later edge of the same Pin on the same tick overrides the earlier one */
+    zassert_true(wave.add_edge(1, 3, false));
+    zassert_equal(wave.data()[1], BIT(3 + 16) | BIT(15 + 16));
+    zassert_true(wave.add_edge(1, 3, true));
+    zassert_equal(wave.data()[1], BIT(3) | BIT(15 + 16));
+
+    zassert_false(wave.add_edge(SAMPLES_NUM, 3, true));
+    zassert_false(wave.add_edge(0, 16, true));
+
+    wave.clear();
+    for (size_t i = 0; i < SAMPLES_NUM; ++i) {
+        zassert_equal(wave.data()[i], 0);
+    }
+}
+
+ZTEST(waveform, test_pulses)
+{
+    encoder_t wave{buffer, SAMPLES_NUM};
+    wave.clear();
+
+    zassert_true(wave.add_pulses(5, 1, 2, 5, 3));
+    for (size_t tick = 0; tick < SAMPLES_NUM; ++tick) {
+        uint32_t expected = 0;
+        if ((tick == 1) || (tick == 6) || (tick == 11)) {
+            expected = BIT(5);
+        }
+        else if ((tick == 3) || (tick == 8) || (tick == 13)) {
+            expected = BIT(5 + 16);
+        }
+        zassert_equal(wave.data()[tick], expected, "tick %zu", tick);
+    }
+
+    /* The Pin is HIGH inside the pulses only */
+    for (size_t ticks = 1; ticks <= SAMPLES_NUM; ++ticks) {
+        size_t tick = ticks - 1;
+        bool is_high = ((tick % 5U) >= 1U) && ((tick % 5U) < 3U) && (tick < 14U);
+        zassert_equal(wave.apply(0, ticks), is_high ? BIT(5) : 0, "ticks %zu", ticks);
+    }
+
+    zassert_false(wave.add_pulses(5, 0, 0, 5, 1));
+    zassert_false(wave.add_pulses(5, 0, 5, 5, 1));
+    zassert_false(wave.add_pulses(5, 0, 2, 5, 0));
+    zassert_false(wave.add_pulses(5, 10, 2, 5, 2));
+    zassert_false(wave.add_pulses(16, 0, 2, 5, 1));
+}
+
+ZTEST(waveform, test_apply_wraps)
+{
+    encoder_t wave{buffer, SAMPLES_NUM};
+    wave.clear();
+    zassert_true(wave.add_edge(0, 2, true));
+    zassert_true(wave.add_edge(SAMPLES_NUM - 1, 2, false));
+
+    /* Other Pins keep their state */
+    zassert_equal(wave.apply(BIT(7), SAMPLES_NUM - 1), BIT(2) | BIT(7));
+    zassert_equal(wave.apply(BIT(7), SAMPLES_NUM), BIT(7));
+    zassert_equal(wave.apply(BIT(7), SAMPLES_NUM + 1), BIT(2) | BIT(7));
+}
+
+ZTEST(waveform, test_one_shot)
+{
+    engine_mock_t engine{gpio_dev, ENGINE_PINS};
+    zassert_true(engine.init());
+    zassert_true(engine.get_backend().is_initialized);
+    zassert_equal(gpio_emul_output_get(gpio_dev, 2), 0);
+    zassert_equal(gpio_emul_output_get(gpio_dev, 5), 0);
+
+    encoder_t wave{buffer, SAMPLES_NUM};
+    wave.clear();
+    zassert_true(wave.add_pulses(2, 0, 4, 8, 2));
+    zassert_true(engine.play(wave, play_mode_t::OneShot));
+
+    mock_dma_backend_t &backend = engine.get_backend();
+    zassert_equal(backend.buffer, wave.data());
+    zassert_equal(backend.samples_num, SAMPLES_NUM);
+    zassert_equal(backend.mode, play_mode_t::OneShot);
+    zassert_equal(backend.starts_num, 1);
+
+    /* Busy until the buffer is transferred */
+    zassert_true(engine.is_playing());
+    zassert_false(engine.play(wave, play_mode_t::OneShot));
+    zassert_equal(backend.starts_num, 1);
+
+    backend.transfer_complete();
+    zassert_false(engine.is_playing());
+    zassert_equal(backend.completions_num, 1);
+
+    /* Late callback after the end changes nothing */
+    backend.transfer_complete();
+    zassert_equal(backend.completions_num, 1);
+
+    zassert_true(engine.play(wave, play_mode_t::OneShot));
+    zassert_equal(backend.starts_num, 2);
+}
+
+ZTEST(waveform, test_circular)
+{
+    engine_mock_t engine{gpio_dev, ENGINE_PINS};
+    zassert_true(engine.init());
+
+    encoder_t wave{buffer, SAMPLES_NUM};
+    wave.clear();
+    zassert_true(wave.add_pulses(5, 0, 1, 2, 8));
+    zassert_true(engine.play(wave, play_mode_t::Circular));
+
+    mock_dma_backend_t &backend = engine.get_backend();
+    zassert_equal(backend.mode, play_mode_t::Circular);
+
+    /* Buffer wraps and playback goes on until stopped */
+    backend.transfer_complete();
+    backend.transfer_complete();
+    zassert_true(engine.is_playing());
+    zassert_equal(backend.completions_num, 2);
+
+    engine.stop();
+    zassert_false(engine.is_playing());
+
+    /* Transfer error ends circular playback too */
+    zassert_true(engine.play(wave, play_mode_t::Circular));
+    backend.transfer_complete(-EIO);
+    zassert_false(engine.is_playing());
+}
+
+ZTEST(waveform, test_foreign_pins_rejected)
+{
+    engine_mock_t engine{gpio_dev, ENGINE_PINS};
+    zassert_true(engine.init());
+
+    encoder_t wave{buffer, SAMPLES_NUM};
+    wave.clear();
+    zassert_true(wave.add_edge(3, 2, true));
+    zassert_true(wave.add_edge(7, 6, false));
+
+    zassert_false(engine.play(wave, play_mode_t::OneShot));
+    zassert_equal(engine.get_backend().starts_num, 0);
+    zassert_false(engine.is_playing());
+}
+
+ZTEST_SUITE(waveform, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+# ZephyrRTOS/C++ based STM32 Firmware
+# SPDX-License-Identifier: Apache-2.0
+
+"""Decode the binary event log dumped from the event_log_partition flash partition.
+
+Page layout and record encoding are described in include/core/event_log.hpp.
+
+Example:
+    st-flash read event_log.bin 0x08010000 0x30000
+    scripts/decode_event_log.py event_log.bin
+"""
+
+import argparse
+import struct
+import sys
+
+PAGE_SIZE = 256
+HEADER = struct.Struct("<HHI")
+PAGE_MAGIC = 0x4C45
+ERASED_TAG = 0xFF
+VALUES_NUM_SHIFT = 6
+EVENT_ID_MASK = 0x3F
+
+# Keep in sync with core::event_id_t
+EVENT_NAMES = {
+    1: "boot",
+    2: "button_press",
+    3: "leds_mode",
+    4: "silent_mode",
+    5: "sensor_summary",
+}
+
+# Keep in sync with the indication modes in app/leds_controller.cpp
+LEDS_MODE_NAMES = {
+    0: "shutdown",
+    1: "init",
+    2: "resume",
+}
+
+# Names of the first value by event id
+VALUE_NAMES = {
+    3: LEDS_MODE_NAMES,
+}
+
+
+def read_varint(data, pos):
+    value = 0
+    shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        if byte < 0x80:
+            return value, pos
+        shift += 7
+
+
+def unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def to_int32(value):
+    value &= 0xFFFFFFFF
+    return value - (1 << 32) if value & 0x80000000 else value
+
+
+def decode_page(page):
+    """Yield (boot, uptime_ms, event_id, values) records of one page."""
+    magic, boot, time_ms = HEADER.unpack_from(page)
+    if magic != PAGE_MAGIC:
+        return
+
+    last_values = {}
+    pos = HEADER.size
+    while pos < len(page) and page[pos] != ERASED_TAG:
+        tag = page[pos]
+        delta_ms, pos = read_varint(page, pos + 1)
+        time_ms = (time_ms + delta_ms) & 0xFFFFFFFF
+        event_id = tag & EVENT_ID_MASK
+        previous = last_values.get(event_id, [])
+        values = []
+        for i in range(tag >> VALUES_NUM_SHIFT):
+            delta, pos = read_varint(page, pos)
+            base = previous[i] if i < len(previous) else 0
+            values.append(to_int32(base + unzigzag(delta)))
+        # Encoder keeps the previous values past a shorter record
+        merged = list(previous)
+        merged[:len(values)] = values
+        last_values[event_id] = merged
+        yield boot, time_ms, event_id, values
+
+
+def ring_offsets(data):
+    """Page offsets from the oldest page, the log wraps over the partition sectors."""
+    offsets = list(range(0, len(data) - PAGE_SIZE + 1, PAGE_SIZE))
+    erased = [data[offset:offset + HEADER.size] == b"\xff" * HEADER.size for offset in offsets]
+    for i in range(len(offsets)):
+        if erased[i - 1] and not erased[i]:
+            return offsets[i:] + offsets[:i]
+    return offsets
+
+
+def decode(data):
+    for offset in ring_offsets(data):
+        try:
+            yield from decode_page(data[offset:offset + PAGE_SIZE])
+        except IndexError:
+            print(f"truncated page at offset {offset:#x}", file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("dump", help="raw dump of the event log partition")
+    args = parser.parse_args()
+
+    with open(args.dump, "rb") as dump:
+        data = dump.read()
+
+    out = sys.stdout
+    for boot, time_ms, event_id, values in decode(data):
+        name = EVENT_NAMES.get(event_id, f"event_{event_id}")
+        fields = [str(value) for value in values]
+        if values and event_id in VALUE_NAMES:
+            fields[0] = VALUE_NAMES[event_id].get(values[0], fields[0])
+        out.write(f"{boot:5} {time_ms / 1000:12.3f} {name} {' '.join(fields)}".rstrip() + "\n")
+
+
+if __name__ == "__main__":
+    main()
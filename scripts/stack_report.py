@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+# ZephyrRTOS/C++ based STM32 Firmware
+# SPDX-License-Identifier: Apache-2.0
+
+"""Combine runtime stack high-water marks with compiler call graph worst cases.
+
+Runtime marks come from the firmware log with CONFIG_APP_STACK_MONITOR=y
+("stack <name>: size <n> used <n> recommended <n>" lines). Static worst cases
+come from the .ci files emitted with CONFIG_APP_STACK_USAGE_INFO=y.
+
+Example:
+    west build -b stm32f401vc_disco firmware -- -DCONFIG_APP_STACK_MONITOR=y \\
+        -DCONFIG_APP_STACK_USAGE_INFO=y
+    scripts/stack_report.py --build-dir build --log uart.log
+"""
+
+import argparse
+import pathlib
+import re
+import sys
+
+# Thread name -> entry function, ISR stack -> IRQ handlers of the firmware
+DEFAULT_ENTRIES = [
+    "main=main",
+    "leds=leds_controller_t::leds_update_thread",
+]
+DEFAULT_ISR_ENTRIES = [
+    "drivers::gpio::gpio_t::pin_irq_handler",
+]
+
+# Cortex-M4F exception frame with FP context, pushed on ISR entry
+EXCEPTION_FRAME_SIZE = 104
+STACK_ALIGN = 8
+
+NODE_RE = re.compile(r'node: \{ title: "([^"]+)" label: "([^"]*)"')
+EDGE_RE = re.compile(r'edge: \{ sourcename: "([^"]+)" targetname: "([^"]+)"')
+USAGE_RE = re.compile(r"(\d+) bytes \((static|dynamic|dynamic,bounded)\)")
+LOG_RE = re.compile(r"stack (\S+): size (\d+) used (\d+) recommended (\d+)")
+
+
+class CallGraph:
+    def __init__(self):
+        self.names = {}      # symbol -> demangled name
+        self.frames = {}     # symbol -> own frame size in bytes
+        self.dynamic = set() # symbols with dynamic frames
+        self.calls = {}      # symbol -> set of callees
+
+    def load(self, path):
+        for line in path.read_text(errors="replace").splitlines():
+            node = NODE_RE.search(line)
+            if node:
+                symbol, label = node.groups()
+                fields = label.split("\\n")
+                self.names.setdefault(symbol, fields[0])
+                usage = USAGE_RE.search(label)
+                if usage:
+                    self.frames[symbol] = int(usage.group(1))
+                    if usage.group(2) != "static":
+                        self.dynamic.add(symbol)
+                continue
+            edge = EDGE_RE.search(line)
+            if edge:
+                self.calls.setdefault(edge.group(1), set()).add(edge.group(2))
+
+    def find(self, function):
+        """Find symbols whose demangled name contains the function name."""
+        pattern = re.compile(r"(^|[\s:*&])" + re.escape(function) + r"\(")
+        return [s for s, n in self.names.items() if s == function or pattern.search(n)]
+
+    def worst_case(self, symbol, memo, path):
+        """Return (bytes, is_exact) for the deepest call chain from symbol."""
+        if symbol in memo:
+            return memo[symbol]
+        if symbol in path:
+            return 0, False  # recursion, unbounded
+        path.add(symbol)
+        own = self.frames.get(symbol)
+        exact = own is not None and symbol not in self.dynamic
+        deepest = 0
+        for callee in self.calls.get(symbol, ()):
+            depth, callee_exact = self.worst_case(callee, memo, path)
+            deepest = max(deepest, depth)
+            exact = exact and callee_exact
+        path.discard(symbol)
+        memo[symbol] = ((own or 0) + deepest, exact)
+        return memo[symbol]
+
+
+def load_runtime(log_paths):
+    marks = {}
+    for path in log_paths:
+        for line in pathlib.Path(path).read_text(errors="replace").splitlines():
+            match = LOG_RE.search(line)
+            if not match:
+                continue
+            name = match.group(1)
+            size, used = int(match.group(2)), int(match.group(3))
+            prev = marks.get(name, (size, 0))
+            marks[name] = (size, max(prev[1], used))
+    return marks
+
+
+def recommend(used, margin):
+    size = used + used * margin // 100
+    return (size + STACK_ALIGN - 1) // STACK_ALIGN * STACK_ALIGN
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--build-dir", type=pathlib.Path, help="Zephyr build directory with .ci files")
+    parser.add_argument("--log", action="append", default=[], help="firmware log with stack monitor report")
+    parser.add_argument("--entry", action="append", help="thread entry as NAME=FUNCTION")
+    parser.add_argument("--isr-entry", action="append", help="IRQ handler function on the ISR stack")
+    parser.add_argument("--margin", type=int, default=25, help="safety margin, percent (default: 25)")
+    args = parser.parse_args()
+
+    graph = CallGraph()
+    if args.build_dir:
+        for path in sorted(args.build_dir.rglob("*.ci")):
+            graph.load(path)
+
+    static = {}
+    for entry in args.entry or DEFAULT_ENTRIES:
+        name, _, function = entry.partition("=")
+        static[name] = [graph.find(function)]
+    static["isr"] = [graph.find(f) for f in (args.isr_entry or DEFAULT_ISR_ENTRIES)]
+
+    runtime = load_runtime(args.log)
+    if not runtime and not graph.names:
+        sys.exit("error: no runtime log and no call graph data")
+
+    memo = {}
+    rows = []
+    for name in sorted(set(static) | set(runtime)):
+        size, used = runtime.get(name, (None, None))
+        worst, exact = None, True
+        for symbols in static.get(name, []):
+            for symbol in symbols:
+                depth, symbol_exact = graph.worst_case(symbol, memo, set())
+                worst = depth if worst is None else max(worst, depth)
+                exact = exact and symbol_exact
+        if name == "isr" and worst is not None:
+            worst += EXCEPTION_FRAME_SIZE
+        candidates = [v for v in (used, worst) if v]
+        rows.append((name, size, used, worst, exact,
+                     recommend(max(candidates), args.margin) if candidates else None))
+
+    def fmt(value):
+        return "-" if value is None else str(value)
+
+    print(f"{'stack':<16}{'size':>8}{'used':>8}{'static':>10}{'recommended':>13}")
+    for name, size, used, worst, exact, recommended in rows:
+        static_str = fmt(worst) + ("" if worst is None or exact else "+")
+        print(f"{name:<16}{fmt(size):>8}{fmt(used):>8}{static_str:>10}{fmt(recommended):>13}")
+    print("\n'+' marks a lower bound: call graph has recursion, dynamic frames or code without stack info")
+
+
+if __name__ == "__main__":
+    main()